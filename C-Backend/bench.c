@@ -0,0 +1,298 @@
+/**
+ * Microbenchmarks for the C backend.
+ *
+ * Usage: bench [--csv | --json] [--filter SUBSTR] [--min-time MS]
+ *
+ * Each case reports the time per operation, the number of heap allocations
+ * and bytes requested per operation, and the throughput. Allocations are
+ * counted by wrapping malloc/calloc/realloc at link time (see "benchutil.h").
+ */
+
+#include "betterc.h"
+#include "eea.h"
+#include "intvl.h"
+#include "ineq.h"
+#include "lde.h"
+#include "benchutil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Fibonacci numbers F(46) and F(45), the largest consecutive pair in an int.
+// They maximize the number of steps in the EEA.
+#define FIB_46 1836311903
+#define FIB_45 1134903170
+
+/**
+ * Arguments of a benchmark case. Each function reads the fields it needs.
+ */
+typedef struct BenchArgs {
+    LDE lde;
+    EEAR row;
+    Interval i1;
+    Interval i2;
+    PreparedLDE prep;
+} BenchArgs;
+
+/**
+ * A single benchmark case.
+ */
+typedef struct BenchCase {
+    const char *func;               // Name of the benchmarked function
+    const char *input;              // Class of input (small, large, ...)
+    void (*run)(const BenchArgs*);  // Performs one operation
+    BenchArgs args;
+} BenchCase;
+
+void run_eea_table(const BenchArgs *args) {
+    EEA_Table table = eea_table(args->lde.a, args->lde.b);
+    bench_sink += table.size;
+    list_free(table);
+}
+
+void run_eea_2nd_last_row(const BenchArgs *args) {
+    bench_sink += eea_2nd_last_row(args->lde.a, args->lde.b).r;
+}
+
+void run_eea_lde_row(const BenchArgs *args) {
+    bench_sink += eea_lde_row(args->lde, args->row).x;
+}
+
+void run_lde_result(const BenchArgs *args) {
+    List result = lde_result(args->lde);
+    for (int i = 0; i < result.size; ++i) {
+        dio_free(list_at(result, i, char*));
+    }
+    bench_sink += result.size;
+    list_free(result);
+}
+
+void run_lde_soln_set(const BenchArgs *args) {
+    bench_sink += lde_soln_set(args->lde).x0;
+}
+
+void run_prepared_soln_set(const BenchArgs *args) {
+    const LDE *lde = &args->lde;
+    bench_sink += prepared_soln_set(&args->prep, lde->c, lde->xi, lde->yi).x0;
+}
+
+// Number of constant terms in each operation of prepared_soln_sets
+#define SWEEP_SIZE 256
+
+void run_prepared_soln_sets(const BenchArgs *args) {
+    static int cs[SWEEP_SIZE];
+    static SolnSet sets[SWEEP_SIZE];
+    const LDE *lde = &args->lde;
+    for (int i = 0; i < SWEEP_SIZE; ++i) {
+        cs[i] = lde->c + i;
+    }
+    prepared_soln_sets(&args->prep, cs, SWEEP_SIZE, lde->xi, lde->yi, sets);
+    bench_sink += sets[SWEEP_SIZE - 1].x0;
+}
+
+void run_intersection(const BenchArgs *args) {
+    bench_sink += intersection(args->i1, args->i2).valid;
+}
+
+void run_int_interval(const BenchArgs *args) {
+    bench_sink += int_interval(args->i1).valid;
+}
+
+void run_solve_ineq_sys(const BenchArgs *args) {
+    const LDE *lde = &args->lde;
+    bench_sink += solve_ineq_sys(lde->a, lde->b, lde->c, -lde->a,
+                                 args->i1, args->i2).valid;
+}
+
+#define EQ(a, b, c, xi, yi) {make_lde_in(a, b, c, xi, yi), {0}, {0}, {0}}
+#define ROW(a, b, c) {make_lde(a, b, c), eea_2nd_last_row(a, b), {0}, {0}}
+#define PREP(a, b, c, xi, yi) \
+    {make_lde_in(a, b, c, xi, yi), {0}, {0}, {0}, prepare_lde(a, b)}
+#define INTVLS(i1, i2) {{0}, {0}, i1, i2}
+#define SYS(x_con, x_coeff, y_con, xi, yi) \
+    {make_lde(x_con, x_coeff, y_con), {0}, xi, yi}
+
+/**
+ * Result of a benchmark case.
+ */
+typedef struct BenchResult {
+    double ns_per_op;
+    double allocs_per_op;
+    double bytes_per_op;
+    long long iters;
+} BenchResult;
+
+BenchResult run_case(const BenchCase *bc, double min_time_ns) {
+    // Warm up and find an iteration count that runs for at least min_time_ns
+    long long iters = 1;
+    double elapsed = 0;
+    while (true) {
+        double start = now_ns();
+        for (long long i = 0; i < iters; ++i) {
+            bc->run(&bc->args);
+        }
+        elapsed = now_ns() - start;
+        if (elapsed >= min_time_ns / 5 || iters >= (1LL << 40)) {
+            break;
+        }
+        iters *= 2;
+    }
+
+    // Keep the best of 5 runs to reduce noise
+    BenchResult res = {elapsed / iters, 0, 0, iters};
+    for (int rep = 0; rep < 5; ++rep) {
+        size_t count = alloc_count;
+        size_t bytes = alloc_bytes;
+        double start = now_ns();
+        for (long long i = 0; i < iters; ++i) {
+            bc->run(&bc->args);
+        }
+        elapsed = now_ns() - start;
+
+        if (elapsed / iters < res.ns_per_op || rep == 0) {
+            res.ns_per_op = elapsed / iters;
+        }
+        res.allocs_per_op = (double) (alloc_count - count) / iters;
+        res.bytes_per_op = (double) (alloc_bytes - bytes) / iters;
+    }
+    return res;
+}
+
+int main(int argc, char *argv[]) {
+    bool csv = false;
+    bool json = false;
+    const char *filter = NULL;
+    double min_time_ms = 200;
+
+    for (int i = 1; i < argc; ++i) {
+        if (equal_str(argv[i], "--csv")) {
+            csv = true;
+        } else if (equal_str(argv[i], "--json")) {
+            json = true;
+        } else if (equal_str(argv[i], "--filter") && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (equal_str(argv[i], "--min-time") && i + 1 < argc) {
+            min_time_ms = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--csv | --json] [--filter SUBSTR] "
+                            "[--min-time MS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const BenchCase cases[] = {
+        {"eea_table", "small", run_eea_table, EQ(1386, 322, 0, REAL, REAL)},
+        {"eea_table", "large", run_eea_table,
+            EQ(2147483646, 1000000007, 0, REAL, REAL)},
+        {"eea_table", "fibonacci", run_eea_table,
+            EQ(FIB_46, FIB_45, 0, REAL, REAL)},
+        {"eea_table", "degenerate", run_eea_table, EQ(0, 5, 0, REAL, REAL)},
+
+        {"eea_2nd_last_row", "small", run_eea_2nd_last_row,
+            EQ(1386, 322, 0, REAL, REAL)},
+        {"eea_2nd_last_row", "large", run_eea_2nd_last_row,
+            EQ(2147483646, 1000000007, 0, REAL, REAL)},
+        {"eea_2nd_last_row", "fibonacci", run_eea_2nd_last_row,
+            EQ(FIB_46, FIB_45, 0, REAL, REAL)},
+        {"eea_2nd_last_row", "degenerate", run_eea_2nd_last_row,
+            EQ(0, 5, 0, REAL, REAL)},
+
+        {"eea_lde_row", "small", run_eea_lde_row, ROW(1386, 322, 14)},
+        {"eea_lde_row", "large", run_eea_lde_row,
+            ROW(2147483646, 1000000007, 1)},
+        {"eea_lde_row", "fibonacci", run_eea_lde_row,
+            ROW(FIB_46, FIB_45, 1)},
+        {"eea_lde_row", "degenerate", run_eea_lde_row, ROW(10, 8, 99)},
+
+        {"lde_result", "small", run_lde_result, EQ(9, 5, 137, POS, POS)},
+        {"lde_result", "large", run_lde_result,
+            EQ(2147483646, 1000000007, 1, REAL, REAL)},
+        {"lde_result", "fibonacci", run_lde_result,
+            EQ(FIB_46, FIB_45, 1, NONNEG, REAL)},
+        {"lde_result", "degenerate", run_lde_result,
+            EQ(0, 0, 0, REAL, NONNEG)},
+
+        {"lde_soln_set", "small", run_lde_soln_set, EQ(9, 5, 137, POS, POS)},
+        {"lde_soln_set", "large", run_lde_soln_set,
+            EQ(2147483646, 1000000007, 1, REAL, REAL)},
+        {"lde_soln_set", "fibonacci", run_lde_soln_set,
+            EQ(FIB_46, FIB_45, 1, NONNEG, REAL)},
+        {"lde_soln_set", "degenerate", run_lde_soln_set,
+            EQ(0, 0, 0, REAL, NONNEG)},
+
+        {"prepared_soln_set", "small", run_prepared_soln_set,
+            PREP(9, 5, 137, POS, POS)},
+        {"prepared_soln_set", "large", run_prepared_soln_set,
+            PREP(2147483646, 1000000007, 1, REAL, REAL)},
+        {"prepared_soln_set", "fibonacci", run_prepared_soln_set,
+            PREP(FIB_46, FIB_45, 1, NONNEG, REAL)},
+        {"prepared_soln_sets", "sweep256", run_prepared_soln_sets,
+            PREP(FIB_46, FIB_45, 1, NONNEG, REAL)},
+
+        {"intersection", "small", run_intersection,
+            INTVLS(make_interval(137.0 / 5, POS_INF, true, true),
+                   make_interval(NEG_INF, 274.0 / 9, true, true))},
+        {"intersection", "large", run_intersection,
+            INTVLS(make_interval(-2e9, 2e9, false, true),
+                   make_interval(-1e9, 2e9, true, false))},
+        {"intersection", "degenerate", run_intersection,
+            INTVLS(make_interval(5, 5, true, false),
+                   make_interval(5, 5, false, true))},
+
+        {"int_interval", "small", run_int_interval,
+            INTVLS(make_interval(137.0 / 5, 274.0 / 9, true, true), {0})},
+        {"int_interval", "large", run_int_interval,
+            INTVLS(make_interval(-2e9 + 0.5, 2e9 - 0.5, true, true), {0})},
+        {"int_interval", "degenerate", run_int_interval,
+            INTVLS(make_interval(5, 5, true, true), {0})},
+
+        {"solve_ineq_sys", "small", run_solve_ineq_sys,
+            SYS(-137, 5, 274, POS, POS)},
+        {"solve_ineq_sys", "large", run_solve_ineq_sys,
+            SYS(-2000000000, 1000000007, 2000000000,
+                make_interval(-2e9, 2e9, false, false), NONNEG)},
+        {"solve_ineq_sys", "degenerate", run_solve_ineq_sys,
+            SYS(137, -5, -274, POS, POS)},
+    };
+    int num_cases = sizeof(cases) / sizeof(cases[0]);
+
+    if (csv) {
+        printf("function,input,ns_per_op,allocs_per_op,bytes_per_op,"
+               "ops_per_sec,iterations\n");
+    } else if (!json) {
+        printf("%-18s %-11s %12s %10s %10s %14s\n",
+               "function", "input", "ns/op", "allocs/op", "bytes/op", "ops/s");
+    }
+
+    for (int i = 0; i < num_cases; ++i) {
+        const BenchCase *bc = &cases[i];
+        char *name = fstr("%s/%s", bc->func, bc->input);
+        bool skip = filter && !strstr(name, filter);
+        dio_free(name);
+        if (skip) {
+            continue;
+        }
+
+        BenchResult res = run_case(bc, min_time_ms * 1e6);
+        double ops_per_sec = res.ns_per_op > 0 ? 1e9 / res.ns_per_op : 0;
+        if (csv) {
+            printf("%s,%s,%.3f,%.3f,%.1f,%.0f,%lld\n", bc->func, bc->input,
+                   res.ns_per_op, res.allocs_per_op, res.bytes_per_op,
+                   ops_per_sec, res.iters);
+        } else if (json) {
+            printf("{\"function\":\"%s\",\"input\":\"%s\",\"ns_per_op\":%.3f,"
+                   "\"allocs_per_op\":%.3f,\"bytes_per_op\":%.1f,"
+                   "\"ops_per_sec\":%.0f,\"iterations\":%lld}\n",
+                   bc->func, bc->input, res.ns_per_op, res.allocs_per_op,
+                   res.bytes_per_op, ops_per_sec, res.iters);
+        } else {
+            printf("%-18s %-11s %12.1f %10.2f %10.1f %14.0f\n",
+                   bc->func, bc->input, res.ns_per_op, res.allocs_per_op,
+                   res.bytes_per_op, ops_per_sec);
+        }
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include "benchutil.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+size_t alloc_count = 0;
+size_t alloc_bytes = 0;
+
+volatile long long bench_sink = 0;
+
+void *__wrap_malloc(size_t size) {
+    ++alloc_count;
+    alloc_bytes += size;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size) {
+    ++alloc_count;
+    alloc_bytes += num * size;
+    return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    ++alloc_count;
+    alloc_bytes += size;
+    return __real_realloc(ptr, size);
+}
+
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
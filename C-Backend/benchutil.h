@@ -0,0 +1,30 @@
+/**
+ * "benchutil.h" provides timing and allocation counters shared by
+ * the benchmark programs.
+ *
+ * The allocation counters only work if the program is linked with
+ * malloc, calloc and realloc wrapped (see BENCH_WRAP in the Makefile).
+ */
+
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <stddef.h>
+
+// Number of heap allocations (including reallocations) so far
+extern size_t alloc_count;
+
+// Number of bytes requested by heap allocations so far
+extern size_t alloc_bytes;
+
+// Results are folded into this variable so that calls are not optimized out
+extern volatile long long bench_sink;
+
+/**
+ * Produces the current time from a monotonic clock.
+ *
+ * @return The current time in nanoseconds.
+ */
+double now_ns();
+
+#endif
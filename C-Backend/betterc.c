@@ -1,4 +1,5 @@
 #include "betterc.h"
+#include "memstat.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -23,7 +24,7 @@ char *fstr(const char *format, ...) {
     size_t str_len = vsnprintf(NULL, 0, format, args) + 1; // +1 for the null terminator
     va_end(args);
 
-    char *result = malloc(str_len);
+    char *result = dio_malloc(str_len);
     if (!result) {
         return NULL;
     }
@@ -36,6 +37,69 @@ char *fstr(const char *format, ...) {
     return result;
 }
 
+StrBuf make_strbuf() {
+    return (StrBuf) {NULL, 0, 0};
+}
+
+void strbuf_append(StrBuf *buf, const char *format, ...) {
+    va_list args;
+
+    va_start(args, format);
+    size_t str_len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    if (buf->len + str_len + 1 > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 64;
+        while (buf->len + str_len + 1 > cap) {
+            cap *= 2;
+        }
+        char *str = dio_realloc(buf->str, cap);
+        if (!str) {
+            return;
+        }
+        buf->str = str;
+        buf->cap = cap;
+    }
+
+    va_start(args, format);
+    vsnprintf(buf->str + buf->len, str_len + 1, format, args);
+    va_end(args);
+    buf->len += str_len;
+}
+
+void strbuf_clear(StrBuf *buf) {
+    buf->len = 0;
+    if (buf->str) {
+        buf->str[0] = '\0';
+    }
+}
+
+void strbuf_free(StrBuf *buf) {
+    dio_free(buf->str);
+    *buf = make_strbuf();
+}
+
+void test_strbuf() {
+    StrBuf buf = make_strbuf();
+    strbuf_append(&buf, "%d + %d", 1, 2);
+    strbuf_append(&buf, " = %d", 3);
+    assert(equal_str(buf.str, "1 + 2 = 3"));
+    assert(buf.len == 9);
+
+    char *str = buf.str;
+    strbuf_clear(&buf);
+    assert(equal_str(buf.str, "") && buf.len == 0);
+    strbuf_append(&buf, "%s", "abc");
+    assert(equal_str(buf.str, "abc") && buf.str == str);
+
+    for (int i = 0; i < 100; ++i) {
+        strbuf_append(&buf, "%c", 'x');
+    }
+    assert(buf.len == 103 && buf.cap >= 104);
+    strbuf_free(&buf);
+    assert(!buf.str && buf.len == 0 && buf.cap == 0);
+}
+
 void test_betterc_h() {
     assert(is_int(0));
     assert(is_int(123456789));
@@ -51,13 +115,15 @@ void test_betterc_h() {
     char *str;
     str = fstr("%d + %d = %d", 1, 2, 3);
     assert(equal_str(str, "1 + 2 = 3"));
-    free(str);
+    dio_free(str);
 
     str = fstr("%d%c = %d%c", 2, 'x', 3, 'y');
     assert(equal_str(str, "2x = 3y"));
-    free(str);
+    dio_free(str);
 
     str = fstr("My name is %s.", "Henry");
     assert(equal_str(str, "My name is Henry."));
-    free(str);
+    dio_free(str);
+
+    test_strbuf();
 }
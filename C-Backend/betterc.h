@@ -6,6 +6,7 @@
 #define BETTERC_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * Checks if a number is an integer.
@@ -30,10 +31,50 @@ bool equal_str(const char *s1, const char *s2);
  * @param format The format string (printf-style).
  * @param ... Additional arguments for formatting.
  * @return A dynamically allocated formatted string. 
- *         Make sure to call free() after usage.
+ *         Make sure to call dio_free() after usage.
  */
 char *fstr(const char *format, ...);
 
+/**
+ * Represents a growable string buffer. The memory is kept when the buffer
+ * is cleared, so a buffer reused across calls stops allocating once it has
+ * grown to the largest string it has held.
+ */
+typedef struct StrBuf {
+    char *str;      // Null-terminated contents, or NULL if nothing was added
+    size_t len;     // Length of the contents, excluding the null terminator
+    size_t cap;     // Number of bytes allocated for str
+} StrBuf;
+
+/**
+ * Creates an empty string buffer.
+ * @return An initialized StrBuf.
+ */
+StrBuf make_strbuf();
+
+/**
+ * Appends a formatted string to a string buffer.
+ * 
+ * @param buf The buffer to append to.
+ * @param format The format string (printf-style).
+ * @param ... Additional arguments for formatting.
+ */
+void strbuf_append(StrBuf *buf, const char *format, ...);
+
+/**
+ * Empties a string buffer without releasing its memory.
+ * 
+ * @param buf The buffer to clear.
+ */
+void strbuf_clear(StrBuf *buf);
+
+/**
+ * Releases the memory of a string buffer.
+ * 
+ * @param buf The buffer to free.
+ */
+void strbuf_free(StrBuf *buf);
+
 /**
  * Runs unit tests for functions in "betterc.h".
  */
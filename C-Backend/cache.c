@@ -0,0 +1,480 @@
+#include "cache.h"
+#include "stats.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <assert.h>
+
+// States of a CacheRecord. A busy record also holds the process ID of its
+// writer in the bits above RECORD_STATE_MASK.
+#define RECORD_EMPTY 0
+#define RECORD_BUSY 1
+#define RECORD_FULL 2
+#define RECORD_STATE_MASK 3u
+
+// Number of times a writer yields while waiting for a busy record
+#define CACHE_BUSY_SPINS 1000
+
+// Bits in CacheRecord.flags
+#define FLAG_LEFT_OPEN 1u
+#define FLAG_RIGHT_OPEN 2u
+#define FLAG_VALID 4u
+#define FLAG_XI_SHIFT 0
+#define FLAG_YI_SHIFT 3
+#define FLAG_N_SHIFT 6
+#define FLAG_PLANE (1u << 9)
+#define FLAG_EXIST (1u << 10)
+#define FLAG_KEY_MASK 0x3Fu
+
+#define INVALID_CACHE (Cache) {-1, NULL, NULL, 0, true, false}
+
+uint32_t intvl_flags(Interval intvl, int shift) {
+    uint32_t flags = (intvl.left_open ? FLAG_LEFT_OPEN : 0) |
+                     (intvl.right_open ? FLAG_RIGHT_OPEN : 0) |
+                     (intvl.valid ? FLAG_VALID : 0);
+    return flags << shift;
+}
+
+Interval flags_intvl(uint32_t flags, int shift, double low, double high) {
+    flags >>= shift;
+    Interval intvl = make_interval(low, high, flags & FLAG_LEFT_OPEN,
+                                   flags & FLAG_RIGHT_OPEN);
+    intvl.valid = flags & FLAG_VALID;
+    return intvl;
+}
+
+uint64_t mix64(uint64_t h, uint64_t v) {
+    h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    h ^= h >> 31;
+    h *= 0xBF58476D1CE4E5B9ull;
+    return h ^ (h >> 29);
+}
+
+uint64_t double_bits(double d) {
+    uint64_t bits;
+    d += 0.0; // Normalize -0.0
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+uint64_t lde_hash(LDE lde) {
+    uint64_t h = 0;
+    h = mix64(h, (uint32_t) lde.a);
+    h = mix64(h, (uint32_t) lde.b);
+    h = mix64(h, (uint32_t) lde.c);
+    h = mix64(h, double_bits(lde.xi.low));
+    h = mix64(h, double_bits(lde.xi.high));
+    h = mix64(h, double_bits(lde.yi.low));
+    h = mix64(h, double_bits(lde.yi.high));
+    return mix64(h, intvl_flags(lde.xi, FLAG_XI_SHIFT) |
+                    intvl_flags(lde.yi, FLAG_YI_SHIFT));
+}
+
+bool record_matches(const CacheRecord *rec, LDE lde) {
+    uint32_t key_flags = intvl_flags(lde.xi, FLAG_XI_SHIFT) |
+                         intvl_flags(lde.yi, FLAG_YI_SHIFT);
+    return rec->a == lde.a &&
+           rec->b == lde.b &&
+           rec->c == lde.c &&
+           (rec->flags & FLAG_KEY_MASK) == key_flags &&
+           rec->bounds[0] == lde.xi.low &&
+           rec->bounds[1] == lde.xi.high &&
+           rec->bounds[2] == lde.yi.low &&
+           rec->bounds[3] == lde.yi.high;
+}
+
+void cache_record_pack(CacheRecord *rec, LDE lde, SolnSet set) {
+    rec->flags = intvl_flags(lde.xi, FLAG_XI_SHIFT) |
+                 intvl_flags(lde.yi, FLAG_YI_SHIFT) |
+                 intvl_flags(set.n_intvl, FLAG_N_SHIFT) |
+                 (set.plane ? FLAG_PLANE : 0) |
+                 (set.exist ? FLAG_EXIST : 0);
+    rec->a = lde.a;
+    rec->b = lde.b;
+    rec->c = lde.c;
+    rec->d = set.d;
+    rec->x0 = set.x0;
+    rec->y0 = set.y0;
+    rec->dx = set.dx;
+    rec->dy = set.dy;
+    rec->bounds[0] = lde.xi.low;
+    rec->bounds[1] = lde.xi.high;
+    rec->bounds[2] = lde.yi.low;
+    rec->bounds[3] = lde.yi.high;
+    rec->bounds[4] = set.n_intvl.low;
+    rec->bounds[5] = set.n_intvl.high;
+}
+
+LDE cache_record_lde(const CacheRecord *rec) {
+    return make_lde_in(rec->a, rec->b, rec->c,
+                       flags_intvl(rec->flags, FLAG_XI_SHIFT,
+                                   rec->bounds[0], rec->bounds[1]),
+                       flags_intvl(rec->flags, FLAG_YI_SHIFT,
+                                   rec->bounds[2], rec->bounds[3]));
+}
+
+SolnSet cache_record_soln_set(const CacheRecord *rec) {
+    return (SolnSet) {rec->d, rec->x0, rec->y0, rec->dx, rec->dy,
+                      flags_intvl(rec->flags, FLAG_N_SHIFT,
+                                  rec->bounds[4], rec->bounds[5]),
+                      rec->flags & FLAG_PLANE, rec->flags & FLAG_EXIST};
+}
+
+uint32_t round_up_pow2(int n) {
+    uint32_t cap = 1;
+    while (cap < (uint32_t) n && cap < (1u << 30)) {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+bool valid_header(const CacheHeader *header, size_t size) {
+    return header->magic == CACHE_MAGIC &&
+           header->version == CACHE_VERSION &&
+           header->record_size == sizeof(CacheRecord) &&
+           header->capacity != 0 &&
+           (header->capacity & (header->capacity - 1)) == 0 &&
+           size == sizeof(CacheHeader) +
+                   (size_t) header->capacity * sizeof(CacheRecord);
+}
+
+Cache map_cache(int fd, size_t size, bool read_only) {
+    int prot = read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+    void *map = mmap(NULL, size, prot, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return INVALID_CACHE;
+    }
+
+    CacheHeader *header = map;
+    return (Cache) {fd, header, (CacheRecord*) (header + 1), size,
+                    read_only, true};
+}
+
+Cache cache_open(const char *path, int capacity) {
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return INVALID_CACHE;
+    }
+
+    // Serialize initialization between processes opening a new file
+    flock(fd, LOCK_EX);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        return INVALID_CACHE;
+    }
+
+    size_t size = st.st_size;
+    bool created = (size == 0);
+    if (created) {
+        uint32_t cap = round_up_pow2(capacity);
+        size = sizeof(CacheHeader) + (size_t) cap * sizeof(CacheRecord);
+        if (ftruncate(fd, size) != 0) {
+            flock(fd, LOCK_UN);
+            close(fd);
+            return INVALID_CACHE;
+        }
+    } else if (size < sizeof(CacheHeader)) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        return INVALID_CACHE;
+    }
+
+    Cache cache = map_cache(fd, size, false);
+    if (cache.valid && created) {
+        *cache.header = (CacheHeader) {CACHE_MAGIC, CACHE_VERSION,
+            sizeof(CacheRecord), round_up_pow2(capacity), 0, {0}};
+    }
+    flock(fd, LOCK_UN);
+
+    if (cache.valid && !valid_header(cache.header, size)) {
+        cache_close(&cache);
+        return INVALID_CACHE;
+    }
+    return cache;
+}
+
+Cache cache_open_read_only(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return INVALID_CACHE;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CacheHeader)) {
+        close(fd);
+        return INVALID_CACHE;
+    }
+
+    Cache cache = map_cache(fd, st.st_size, true);
+    if (cache.valid && !valid_header(cache.header, cache.size)) {
+        cache_close(&cache);
+        return INVALID_CACHE;
+    }
+    return cache;
+}
+
+void cache_close(Cache *cache) {
+    if (!cache->valid) {
+        return;
+    }
+    munmap(cache->header, cache->size);
+    close(cache->fd);
+    *cache = INVALID_CACHE;
+}
+
+bool cache_lookup(const Cache *cache, LDE lde, SolnSet *set) {
+    if (!cache->valid) {
+        return false;
+    }
+
+    uint32_t mask = cache->header->capacity - 1;
+    uint32_t index = lde_hash(lde) & mask;
+    for (int i = 0; i < CACHE_MAX_PROBE; ++i) {
+        const CacheRecord *rec = &cache->records[(index + i) & mask];
+        uint32_t state = __atomic_load_n(&rec->state, __ATOMIC_ACQUIRE);
+        if (state == RECORD_EMPTY) {
+            return false;
+        }
+        if (state != RECORD_FULL || !record_matches(rec, lde)) {
+            continue;
+        }
+
+        *set = cache_record_soln_set(rec);
+        return true;
+    }
+    return false;
+}
+
+bool is_busy(uint32_t state) {
+    return (state & RECORD_STATE_MASK) == RECORD_BUSY;
+}
+
+/**
+ * Waits briefly for the writer of a busy record to publish it.
+ *
+ * @param rec The record.
+ * @param state The busy state seen in rec.
+ * @return The state of rec after waiting, still busy if its writer is
+ *         stalled or has died.
+ */
+uint32_t wait_record(const CacheRecord *rec, uint32_t state) {
+    for (int i = 0; i < CACHE_BUSY_SPINS && is_busy(state); ++i) {
+        sched_yield();
+        state = __atomic_load_n(&rec->state, __ATOMIC_ACQUIRE);
+    }
+    return state;
+}
+
+/**
+ * Checks if the writer of a busy record no longer exists, so that the
+ * record can never be published. Records made busy by earlier versions
+ * hold no process ID, and are treated the same.
+ */
+bool writer_died(uint32_t state) {
+    pid_t pid = state >> 2;
+    return pid == 0 || (kill(pid, 0) == -1 && errno == ESRCH);
+}
+
+bool cache_insert(Cache *cache, LDE lde, SolnSet set) {
+    if (!cache->valid || cache->read_only) {
+        return false;
+    }
+
+    uint32_t busy = RECORD_BUSY | ((uint32_t) getpid() << 2);
+    uint32_t mask = cache->header->capacity - 1;
+    uint32_t index = lde_hash(lde) & mask;
+    for (int i = 0; i < CACHE_MAX_PROBE; ++i) {
+        CacheRecord *rec = &cache->records[(index + i) & mask];
+        uint32_t state = RECORD_EMPTY;
+        bool claimed = __atomic_compare_exchange_n(&rec->state, &state, busy,
+                                                   false, __ATOMIC_ACQUIRE,
+                                                   __ATOMIC_ACQUIRE);
+        if (!claimed && is_busy(state)) {
+            // Another writer may be storing the same LDE, so its key is
+            // checked once published. A record left busy by a process that
+            // died is taken over.
+            state = wait_record(rec, state);
+            claimed = is_busy(state) && writer_died(state) &&
+                      __atomic_compare_exchange_n(&rec->state, &state, busy,
+                                                  false, __ATOMIC_ACQUIRE,
+                                                  __ATOMIC_ACQUIRE);
+        }
+        if (!claimed) {
+            if (state == RECORD_FULL && record_matches(rec, lde)) {
+                return true;
+            }
+            continue;
+        }
+
+        cache_record_pack(rec, lde, set);
+        __atomic_store_n(&rec->state, RECORD_FULL, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&cache->header->count, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    return false;
+}
+
+SolnSet cache_soln_set(Cache *cache, LDE lde) {
+    SolnSet set;
+    if (cache_lookup(cache, lde, &set)) {
+        return set;
+    }
+
+    STAT_COUNT(STAT_CACHE_MISSES, 1);
+    set = lde_soln_set(lde);
+    cache_insert(cache, lde, set);
+    return set;
+}
+
+void test_cache_open() {
+    char path[] = "/tmp/diosolver-cache-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    // An empty file is initialized with the requested capacity
+    Cache cache = cache_open(path, 100);
+    assert(cache.valid);
+    assert(cache.header->capacity == 128);
+    assert(cache.header->count == 0);
+    cache_close(&cache);
+    assert(!cache.valid);
+
+    cache = cache_open_read_only(path);
+    assert(cache.valid && cache.read_only);
+    assert(!cache_insert(&cache, make_lde(1, 1, 1), lde_soln_set(make_lde(1, 1, 1))));
+    cache_close(&cache);
+
+    // Files with another version are rejected
+    cache = cache_open(path, 0);
+    cache.header->version = CACHE_VERSION + 1;
+    cache_close(&cache);
+    assert(!cache_open(path, 0).valid);
+    assert(!cache_open_read_only(path).valid);
+
+    unlink(path);
+    assert(!cache_open_read_only(path).valid);
+}
+
+void test_cache_lookup() {
+    char path[] = "/tmp/diosolver-cache-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    LDE ldes[] = {
+        make_lde_in(9, 5, 137, POS, POS),
+        make_lde_in(9, 5, 137, NONNEG, POS),
+        make_lde_in(-9, 5, 137, POS, POS),
+        make_lde_in(10, 8, 99, POS, POS),
+        make_lde_in(0, 5, 10, POS, POS),
+        make_lde_in(-5, 0, 10, NEG, NONPOS),
+        make_lde_in(0, 0, 0, REAL, NONNEG),
+        make_lde_in(1386, 322, 14, make_interval(-5, 3.5, true, false), REAL),
+    };
+    int num_ldes = sizeof(ldes) / sizeof(ldes[0]);
+
+    Cache cache = cache_open(path, 64);
+    SolnSet set;
+    for (int i = 0; i < num_ldes; ++i) {
+        assert(!cache_lookup(&cache, ldes[i], &set));
+        assert(equal_soln_set(cache_soln_set(&cache, ldes[i]),
+                              lde_soln_set(ldes[i])));
+    }
+    assert(cache.header->count == (uint32_t) num_ldes);
+    cache_close(&cache);
+
+    // Results persist across reopening
+    cache = cache_open_read_only(path);
+    for (int i = 0; i < num_ldes; ++i) {
+        assert(cache_lookup(&cache, ldes[i], &set));
+        assert(equal_soln_set(set, lde_soln_set(ldes[i])));
+    }
+    assert(!cache_lookup(&cache, make_lde_in(9, 5, 137, POS, NONNEG), &set));
+    assert(equal_soln_set(cache_soln_set(&cache, make_lde(3, 6, 9)),
+                          lde_soln_set(make_lde(3, 6, 9))));
+    cache_close(&cache);
+
+    unlink(path);
+}
+
+void *test_cache_writer(void *arg) {
+    Cache *cache = arg;
+    for (int c = 0; c < 500; ++c) {
+        LDE lde = make_lde(7, 5, c);
+        assert(cache_insert(cache, lde, lde_soln_set(lde)));
+    }
+    return NULL;
+}
+
+void test_cache_busy() {
+    char path[] = "/tmp/diosolver-cache-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    Cache cache = cache_open(path, 64);
+    uint32_t mask = cache.header->capacity - 1;
+
+    // A record left busy by a process that died is taken over
+    LDE lde = make_lde(9, 5, 137);
+    CacheRecord *home = &cache.records[lde_hash(lde) & mask];
+    pid_t child = fork();
+    if (child == 0) {
+        _exit(0);
+    }
+    waitpid(child, NULL, 0);
+    home->state = RECORD_BUSY | ((uint32_t) child << 2);
+    assert(cache_insert(&cache, lde, lde_soln_set(lde)));
+    assert(home->state == RECORD_FULL && record_matches(home, lde));
+    assert(cache.header->count == 1);
+
+    // A record kept busy by a running writer is passed over after a wait
+    lde = make_lde(9, 5, 138);
+    home = &cache.records[lde_hash(lde) & mask];
+    uint32_t busy = RECORD_BUSY | ((uint32_t) getpid() << 2);
+    if (home->state == RECORD_EMPTY) {
+        home->state = busy;
+        assert(cache_insert(&cache, lde, lde_soln_set(lde)));
+        assert(home->state == busy);
+        home->state = RECORD_EMPTY;
+    }
+    cache_close(&cache);
+    unlink(path);
+
+    // Writers racing on the same LDEs store each of them once
+    char race_path[] = "/tmp/diosolver-cache-XXXXXX";
+    fd = mkstemp(race_path);
+    assert(fd >= 0);
+    close(fd);
+    cache = cache_open(race_path, 4096);
+    pthread_t threads[4];
+    for (int i = 0; i < 4; ++i) {
+        pthread_create(&threads[i], NULL, test_cache_writer, &cache);
+    }
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(cache.header->count == 500);
+    cache_close(&cache);
+    unlink(race_path);
+}
+
+void test_cache_h() {
+    test_cache_open();
+    test_cache_lookup();
+    test_cache_busy();
+}
@@ -0,0 +1,178 @@
+/**
+ * "cache.h" provides a persistent, memory-mapped cache of solved LDEs.
+ *
+ * The cache is a fixed-size open-addressing hash table stored in a file.
+ * Each record is keyed by (a, b, c, xi, yi) and holds the SolnSet of the LDE,
+ * so a lookup neither parses text nor reruns the EEA. The file is mapped
+ * with MAP_SHARED, so processes on the same host share the results.
+ *
+ * File layout (host byte order):
+ *   CacheHeader                      (64 bytes)
+ *   CacheRecord[capacity]            (capacity is a power of 2)
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "lde.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Identifies a cache file ("DIOC")
+#define CACHE_MAGIC 0x434F4944u
+
+// Incremented whenever the layout of CacheHeader or CacheRecord changes
+#define CACHE_VERSION 1
+
+// Maximum number of slots probed by a lookup or an insertion
+#define CACHE_MAX_PROBE 16
+
+/**
+ * Header at the beginning of a cache file.
+ */
+typedef struct CacheHeader {
+    uint32_t magic;         // Must be CACHE_MAGIC
+    uint32_t version;       // Must be CACHE_VERSION
+    uint32_t record_size;   // Must be sizeof(CacheRecord)
+    uint32_t capacity;      // Number of records, a power of 2
+    uint32_t count;         // Number of occupied records
+    uint32_t reserved[11];
+} CacheHeader;
+
+/**
+ * A single slot in the cache file.
+ */
+typedef struct CacheRecord {
+    uint32_t state;         // Empty, busy (being written, with the
+                            // writer's process ID) or full
+    uint32_t flags;         // Openness of xi, yi, n_intvl and SolnSet flags
+    int32_t a;
+    int32_t b;
+    int32_t c;
+    int32_t d;
+    int32_t x0;
+    int32_t y0;
+    int32_t dx;
+    int32_t dy;
+    double bounds[6];       // Bounds of xi, yi, and n_intvl
+} CacheRecord;
+
+/**
+ * Represents an open cache file.
+ */
+typedef struct Cache {
+    int fd;                 // File descriptor of the cache file
+    CacheHeader *header;    // Start of the mapped file
+    CacheRecord *records;   // Records following the header
+    size_t size;            // Size of the mapped file in bytes
+    bool read_only;         // True if insertions are disabled
+
+    bool valid;             // True if the cache is open
+} Cache;
+
+/**
+ * Opens a cache file for reading and writing, creating it if necessary.
+ *
+ * @param path Path to the cache file.
+ * @param capacity Number of records in a new file, rounded up to a
+ *                 power of 2. Ignored if the file already exists.
+ * @return The opened cache, or a cache with "valid" set to false if the file
+ *         cannot be opened or has an incompatible format.
+ */
+Cache cache_open(const char *path, int capacity);
+
+/**
+ * Opens an existing cache file for reading only.
+ *
+ * @param path Path to the cache file.
+ * @return The opened cache, or a cache with "valid" set to false if the file
+ *         cannot be opened or has an incompatible format.
+ */
+Cache cache_open_read_only(const char *path);
+
+/**
+ * Unmaps and closes a cache.
+ *
+ * @param cache The cache to close.
+ */
+void cache_close(Cache *cache);
+
+/**
+ * Looks up the solution set of an LDE.
+ *
+ * @param cache The cache to search.
+ * @param lde The LDE to look up.
+ * @param set Receives the cached solution set if found.
+ * @return true if the LDE is in the cache, false otherwise.
+ */
+bool cache_lookup(const Cache *cache, LDE lde, SolnSet *set);
+
+/**
+ * Stores the solution set of an LDE. The insertion is dropped if the cache
+ * is read-only or all probed slots are occupied.
+ *
+ * A slot being written by another writer is waited for, so that an LDE
+ * inserted by several writers at once is stored only once. A slot left
+ * busy by a process that died is taken over; one whose writer is still
+ * running after the wait is passed over, so a stalled writer may rarely
+ * cause an LDE to be stored twice, which lookups tolerate. Writers must
+ * share a PID namespace for a dead writer to be detected.
+ *
+ * @param cache The cache to write to.
+ * @param lde The solved LDE.
+ * @param set The solution set of lde.
+ * @return true if the record was stored, false otherwise.
+ */
+bool cache_insert(Cache *cache, LDE lde, SolnSet set);
+
+/**
+ * Produces the solution set of an LDE, consulting the cache first and
+ * storing freshly computed results.
+ *
+ * @param cache The cache to use.
+ * @param lde The LDE to be solved.
+ * @return The complete solution set of the LDE.
+ */
+SolnSet cache_soln_set(Cache *cache, LDE lde);
+
+/**
+ * Packs an LDE and its solution set into a record. The state of the record
+ * is left unchanged.
+ *
+ * @param rec The record to write to.
+ * @param lde The LDE.
+ * @param set The solution set of lde, or NO_SOLN_SET if not yet solved.
+ */
+void cache_record_pack(CacheRecord *rec, LDE lde, SolnSet set);
+
+/**
+ * Unpacks the LDE stored in a record.
+ *
+ * @param rec The record to read.
+ * @return The LDE in rec.
+ */
+LDE cache_record_lde(const CacheRecord *rec);
+
+/**
+ * Unpacks the solution set stored in a record.
+ *
+ * @param rec The record to read.
+ * @return The solution set in rec.
+ */
+SolnSet cache_record_soln_set(const CacheRecord *rec);
+
+/**
+ * Runs unit tests for functions in "cache.h".
+ */
+void test_cache_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,188 @@
+/**
+ * Non-interactive command-line solver.
+ *
+ * Usage: diosolver [options] a b c
+ * Run "diosolver --help" for the list of options.
+ */
+
+#include "diosolver.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+
+const char *usage =
+    "Usage: %s [options] a b c\n"
+    "       %s --jsonl\n"
+    "Solves the linear Diophantine equation ax + by = c.\n"
+    "\n"
+    "Options:\n"
+    "  -x DOMAIN      Domain of x (default: real)\n"
+    "  -y DOMAIN      Domain of y (default: real)\n"
+    "  -s, --summary  Print the solution set on one line instead of the steps\n"
+    "  --jsonl        Solve JSON requests from standard input, one per line\n"
+    "                 (see \"jsonl.h\" for the format). Send SIGUSR1 to print\n"
+    "                 the latency percentiles so far on standard error\n"
+    "  --alloc        Print the allocations of each call on standard error\n"
+    "                 (requires a build with MEMSTAT=1, see \"memstat.h\")\n"
+    "  --stats        Print the time spent in each phase and the counters of\n"
+    "                 the solve on standard error\n"
+    "                 (requires a build with STATS=1, see \"stats.h\")\n"
+    "  -v, --version  Print the version and exit\n"
+    "  -h, --help     Print this help and exit\n"
+    "\n"
+    "DOMAIN is real, pos, neg, nonpos, nonneg, or an interval such as\n"
+    "\"[0,10)\" or \"(-inf,5]\".\n"
+    "\n"
+    "Set DIO_TRACE=FILE to write a Chrome trace of the solve to FILE\n"
+    "(see \"trace.h\").\n";
+
+/**
+ * Parses a coefficient in [NEG_INF, POS_INF].
+ *
+ * @param str The string to parse.
+ * @param n Receives the parsed integer.
+ * @return true if str is an integer within range, false otherwise.
+ */
+bool parse_int(const char *str, int *n) {
+    char *end;
+    errno = 0;
+    long value = strtol(str, &end, 10);
+    if (end == str || *end || errno == ERANGE ||
+        value < NEG_INF || value > POS_INF) {
+        return false;
+    }
+    *n = value;
+    return true;
+}
+
+/**
+ * Prints the allocations of a call on standard error.
+ *
+ * @param call Name of the call.
+ * @param stat Allocations of the call, from memstat_end().
+ */
+void print_alloc(const char *call, MemStat stat) {
+    char *stat_str = memstat_to_str(stat);
+    fprintf(stderr, "%-16s %s\n", call, stat_str);
+    dio_free(stat_str);
+}
+
+int main(int argc, char *argv[]) {
+    Interval xi = REAL;
+    Interval yi = REAL;
+    bool summary = false;
+    bool alloc = false;
+    bool stats = false;
+    int coeffs[3];
+    int num_coeffs = 0;
+    bool options_done = false;
+
+    TRACE_BEGIN("parse");
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        int n;
+        if (options_done || parse_int(arg, &n)) {
+            if (num_coeffs == 3 || !parse_int(arg, &n)) {
+                fprintf(stderr, "%s: unexpected argument '%s'\n", argv[0], arg);
+                TRACE_END();
+                return 2;
+            }
+            coeffs[num_coeffs++] = n;
+        } else if (equal_str(arg, "--")) {
+            options_done = true;
+        } else if ((equal_str(arg, "-x") || equal_str(arg, "-y")) && i + 1 < argc) {
+            Interval intvl = str_to_interval(argv[++i]);
+            if (!is_valid_interval(intvl)) {
+                fprintf(stderr, "%s: invalid domain '%s'\n", argv[0], argv[i]);
+                TRACE_END();
+                return 2;
+            }
+            *(arg[1] == 'x' ? &xi : &yi) = intvl;
+        } else if (equal_str(arg, "--jsonl")) {
+            TRACE_END();
+            latency_enable();
+            latency_dump_on_signal(SIGUSR1, stderr);
+            return jsonl_serve(STDIN_FILENO, stdout) ? 1 : 0;
+        } else if (equal_str(arg, "--alloc")) {
+            alloc = true;
+        } else if (equal_str(arg, "--stats")) {
+            stats = true;
+        } else if (equal_str(arg, "-s") || equal_str(arg, "--summary")) {
+            summary = true;
+        } else if (equal_str(arg, "-v") || equal_str(arg, "--version")) {
+            TRACE_END();
+            printf("diosolver %s\n", diosolver_version());
+            return 0;
+        } else if (equal_str(arg, "-h") || equal_str(arg, "--help")) {
+            TRACE_END();
+            printf(usage, argv[0], argv[0]);
+            return 0;
+        } else {
+            TRACE_END();
+            fprintf(stderr, usage, argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    TRACE_END();
+    if (num_coeffs != 3) {
+        fprintf(stderr, usage, argv[0], argv[0]);
+        return 2;
+    }
+
+    if (alloc && !memstat_enabled()) {
+        fprintf(stderr, "%s: --alloc requires a build with MEMSTAT=1\n", argv[0]);
+        return 2;
+    }
+    if (stats && !stats_enabled()) {
+        fprintf(stderr, "%s: --stats requires a build with STATS=1\n", argv[0]);
+        return 2;
+    }
+
+    LDE lde = make_lde_in(coeffs[0], coeffs[1], coeffs[2], xi, yi);
+    MemStat solve_mark = memstat_begin();
+    MemStat call_stats[2];
+    MemStat mark = memstat_begin();
+    if (summary) {
+        SolnSet set = lde_soln_set(lde);
+        call_stats[0] = memstat_end(mark);
+        mark = memstat_begin();
+        char *set_str = soln_set_to_str(set);
+        TRACE_BEGIN("output");
+        printf("%s\n", set_str);
+        fflush(stdout);
+        TRACE_END();
+        dio_free(set_str);
+        call_stats[1] = memstat_end(mark);
+    } else {
+        List result = lde_result(lde);
+        call_stats[0] = memstat_end(mark);
+        TRACE_BEGIN("output");
+        for (int i = 0; i < result.size; ++i) {
+            fputs(list_at(result, i, char*), stdout);
+        }
+        fflush(stdout);
+        TRACE_END();
+        mark = memstat_begin();
+        lde_result_free(result);
+        call_stats[1] = memstat_end(mark);
+    }
+    MemStat solve_stat = memstat_end(solve_mark);
+
+    if (alloc) {
+        fflush(stdout);
+        print_alloc(summary ? "lde_soln_set" : "lde_result", call_stats[0]);
+        print_alloc(summary ? "soln_set_to_str" : "lde_result_free", call_stats[1]);
+        print_alloc("total", solve_stat);
+    }
+    if (stats) {
+        fflush(stdout);
+        char *stats_str = stats_to_str(stats_snapshot());
+        fputs(stats_str, stderr);
+        dio_free(stats_str);
+    }
+    return 0;
+}
@@ -0,0 +1,558 @@
+#include "corpus.h"
+#include "betterc.h"
+#include "eea.h"
+#include "intvl.h"
+#include "memstat.h"
+#include "sample.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Maximum length of a domain in the text format
+#define MAX_DOMAIN_LEN 64
+
+const char *corpus_class_names[NUM_CORPUS_CLASSES] = {
+    "small", "medium", "large", "fibonacci", "degenerate", "unsolvable",
+    "near_overflow", "empty_domain", "realistic"
+};
+
+const char *corpus_class_name(CorpusClass cls) {
+    return corpus_class_names[cls];
+}
+
+int corpus_range(uint64_t *state, int low, int high) {
+    return low + (long long) (xorshift_next(state) % ((long long) high - low + 1));
+}
+
+int corpus_nonzero(uint64_t *state, int max) {
+    int n = corpus_range(state, 1, max);
+    return (xorshift_next(state) & 1) ? n : -n;
+}
+
+Interval corpus_domain(uint64_t *state) {
+    switch (corpus_range(state, 0, 5)) {
+    case 0:
+        return REAL;
+    case 1:
+        return POS;
+    case 2:
+        return NEG;
+    case 3:
+        return NONPOS;
+    case 4:
+        return NONNEG;
+    }
+    int low = corpus_range(state, -1000000, 1000000);
+    int high = low + corpus_range(state, 0, 1000000);
+    return make_interval(low, high, xorshift_next(state) & 1,
+                         xorshift_next(state) & 1);
+}
+
+/**
+ * Picks a domain without any integer.
+ */
+Interval corpus_empty_domain(uint64_t *state) {
+    int low = corpus_range(state, -1000000, 1000000);
+    if (corpus_range(state, 0, 3) != 0) {
+        return make_interval(low, low + 1, true, true);
+    }
+    // Near the ends of the range, where rounding the bounds may overflow
+    return (xorshift_next(state) & 1)
+           ? make_interval(POS_INF - 2, POS_INF - 1, true, true)
+           : make_interval(NEG_INF + 1, NEG_INF + 2, true, true);
+}
+
+/**
+ * Picks a coefficient whose number of bits is roughly uniform in [1, 12].
+ */
+int corpus_magnitude(uint64_t *state) {
+    int bits = corpus_range(state, 1, 12);
+    return corpus_range(state, 1 << (bits - 1), (1 << bits) - 1);
+}
+
+LDE corpus_fibonacci(uint64_t *state) {
+    int k = corpus_range(state, 20, 45);
+    int f1 = 1, f2 = 1;
+    for (int i = 2; i <= k; ++i) {
+        int f = f1 + f2;
+        f1 = f2;
+        f2 = f;
+    }
+    int a = (xorshift_next(state) & 1) ? f2 : -f2;
+    int b = (xorshift_next(state) & 1) ? f1 : -f1;
+    return make_lde_in(a, b, corpus_nonzero(state, 100),
+                       corpus_domain(state), corpus_domain(state));
+}
+
+LDE corpus_degenerate(uint64_t *state) {
+    int coeff = corpus_nonzero(state, 1000);
+    int c = coeff * corpus_range(state, -1000, 1000);
+    switch (corpus_range(state, 0, 2)) {
+    case 0:
+        return make_lde_in(0, coeff, c, corpus_domain(state),
+                           corpus_domain(state));
+    case 1:
+        return make_lde_in(coeff, 0, c, corpus_domain(state),
+                           corpus_domain(state));
+    }
+    return make_lde_in(0, 0, corpus_range(state, 0, 1) * c,
+                       corpus_domain(state), corpus_domain(state));
+}
+
+LDE corpus_unsolvable(uint64_t *state) {
+    int g = corpus_range(state, 2, 1000);
+    int a = g * corpus_nonzero(state, 10000);
+    int b = g * corpus_nonzero(state, 10000);
+    int c = g * corpus_range(state, -100000, 100000) +
+            corpus_range(state, 1, g - 1);
+    return make_lde_in(a, b, c, corpus_domain(state), corpus_domain(state));
+}
+
+LDE corpus_near_overflow(uint64_t *state) {
+    // Neighbouring coefficients are coprime with Bezout coefficients near
+    // their size, so x and y of eea_lde_row() exceed the range for most c
+    int a = POS_INF - corpus_range(state, 0, 100);
+    int b = (xorshift_next(state) & 1) ? a - corpus_range(state, 1, 100)
+                                     : corpus_range(state, 2, 100);
+    int c = POS_INF - corpus_range(state, 0, 100);
+    a = (xorshift_next(state) & 1) ? a : -a;
+    b = (xorshift_next(state) & 1) ? b : -b;
+    c = (xorshift_next(state) & 1) ? c : -c;
+    if (xorshift_next(state) & 1) {
+        int t = a;
+        a = b;
+        b = t;
+    }
+    return make_lde_in(a, b, c, corpus_domain(state), corpus_domain(state));
+}
+
+LDE corpus_empty(uint64_t *state) {
+    LDE lde = make_lde_in(corpus_nonzero(state, 100000),
+                          corpus_nonzero(state, 100000),
+                          corpus_range(state, -1000000, 1000000),
+                          corpus_domain(state), corpus_domain(state));
+    int which = corpus_range(state, 0, 2);
+    if (which != 1) {
+        lde.xi = corpus_empty_domain(state);
+    }
+    if (which != 0) {
+        lde.yi = corpus_empty_domain(state);
+    }
+    return lde;
+}
+
+LDE corpus_realistic(uint64_t *state) {
+    int a = (corpus_range(state, 0, 19) == 0) ? 0 : corpus_magnitude(state);
+    int b = corpus_magnitude(state);
+    a = (corpus_range(state, 0, 3) == 0) ? -a : a;
+    b = (corpus_range(state, 0, 3) == 0) ? -b : b;
+
+    // Most equations typed by users have a solution
+    int c = (corpus_range(state, 0, 3) != 0)
+            ? a * corpus_range(state, -50, 50) + b * corpus_range(state, -50, 50)
+            : corpus_range(state, -10000, 10000);
+
+    Interval domains[2];
+    for (int i = 0; i < 2; ++i) {
+        int pick = corpus_range(state, 0, 19);
+        domains[i] = (pick < 8) ? REAL : (pick < 13) ? NONNEG : (pick < 17) ? POS
+                     : make_interval(0, corpus_range(state, 1, 1000), false, false);
+    }
+    return make_lde_in(a, b, c, domains[0], domains[1]);
+}
+
+LDE corpus_lde(CorpusClass cls, uint64_t *state) {
+    switch (cls) {
+    case CORPUS_SMALL:
+        return make_lde_in(corpus_nonzero(state, 100), corpus_nonzero(state, 100),
+                           corpus_range(state, -1000, 1000),
+                           corpus_domain(state), corpus_domain(state));
+    case CORPUS_MEDIUM:
+        return make_lde_in(corpus_nonzero(state, 100000),
+                           corpus_nonzero(state, 100000),
+                           corpus_range(state, -1000000, 1000000),
+                           corpus_domain(state), corpus_domain(state));
+    case CORPUS_LARGE:
+        return make_lde_in(corpus_nonzero(state, POS_INF),
+                           corpus_nonzero(state, POS_INF),
+                           corpus_range(state, NEG_INF, POS_INF),
+                           corpus_domain(state), corpus_domain(state));
+    case CORPUS_FIBONACCI:
+        return corpus_fibonacci(state);
+    case CORPUS_DEGENERATE:
+        return corpus_degenerate(state);
+    case CORPUS_UNSOLVABLE:
+        return corpus_unsolvable(state);
+    case CORPUS_NEAR_OVERFLOW:
+        return corpus_near_overflow(state);
+    case CORPUS_EMPTY_DOMAIN:
+        return corpus_empty(state);
+    default:
+        return corpus_realistic(state);
+    }
+}
+
+/**
+ * Appends an LDE to a corpus, growing its arrays as needed.
+ *
+ * @param corpus The corpus.
+ * @param capacity Capacity of the arrays, updated in place.
+ * @param lde The LDE.
+ * @param cls The class of lde.
+ */
+void corpus_add(Corpus *corpus, int *capacity, LDE lde, CorpusClass cls) {
+    if (corpus->size == *capacity) {
+        *capacity = *capacity ? 2 * *capacity : 256;
+        corpus->ldes = dio_realloc(corpus->ldes, *capacity * sizeof(LDE));
+        corpus->classes = dio_realloc(corpus->classes, *capacity);
+    }
+    corpus->ldes[corpus->size] = lde;
+    corpus->classes[corpus->size++] = cls;
+}
+
+Corpus corpus_generate(int count, uint64_t seed) {
+    Corpus corpus = {NULL, NULL, 0, seed, true};
+    int capacity = 0;
+    for (int k = 0; k < NUM_CORPUS_CLASSES; ++k) {
+        uint64_t state = seed * 0x9E3779B97F4A7C15ull + k + 1;
+        for (int i = 0; i < count; ++i) {
+            corpus_add(&corpus, &capacity, corpus_lde(k, &state), k);
+        }
+    }
+    return corpus;
+}
+
+/**
+ * Formats a bound of a domain exactly.
+ *
+ * @param bound The bound.
+ * @param str Receives the bound, such as "-inf" or "42".
+ */
+void corpus_bound_str(double bound, char str[16]) {
+    if (bound == NEG_INF) {
+        strcpy(str, "-inf");
+    } else if (bound == POS_INF) {
+        strcpy(str, "inf");
+    } else {
+        snprintf(str, 16, "%.0f", bound);
+    }
+}
+
+int corpus_request(LDE lde, char *buf, size_t size) {
+    char bounds[4][16];
+    corpus_bound_str(lde.xi.low, bounds[0]);
+    corpus_bound_str(lde.xi.high, bounds[1]);
+    corpus_bound_str(lde.yi.low, bounds[2]);
+    corpus_bound_str(lde.yi.high, bounds[3]);
+    return snprintf(buf, size, "%d %d %d %c%s,%s%c %c%s,%s%c\n",
+                    lde.a, lde.b, lde.c,
+                    lde.xi.left_open ? '(' : '[', bounds[0], bounds[1],
+                    lde.xi.right_open ? ')' : ']',
+                    lde.yi.left_open ? '(' : '[', bounds[2], bounds[3],
+                    lde.yi.right_open ? ')' : ']');
+}
+
+bool corpus_write_text(const Corpus *corpus, FILE *out) {
+    fprintf(out, "# seed %llu\n", (unsigned long long) corpus->seed);
+    int cls = -1;
+    for (int i = 0; i < corpus->size; ++i) {
+        if (corpus->classes[i] != cls) {
+            cls = corpus->classes[i];
+            fprintf(out, "# class %s\n", corpus_class_name(cls));
+        }
+        char request[CORPUS_MAX_REQUEST];
+        corpus_request(corpus->ldes[i], request, sizeof(request));
+        fputs(request, out);
+    }
+    return !ferror(out);
+}
+
+bool corpus_write_binary(const Corpus *corpus, FILE *out) {
+    CorpusHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = CORPUS_MAGIC;
+    header.version = CORPUS_VERSION;
+    header.record_size = sizeof(CacheRecord);
+    header.count = corpus->size;
+    header.seed = corpus->seed;
+    if (fwrite(&header, sizeof(header), 1, out) != 1) {
+        return false;
+    }
+
+    for (int i = 0; i < corpus->size; ++i) {
+        CacheRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.state = corpus->classes[i];
+        cache_record_pack(&rec, corpus->ldes[i], NO_SOLN_SET);
+        if (fwrite(&rec, sizeof(rec), 1, out) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Parses a request in the text format.
+ *
+ * @param line The request, without its newline.
+ * @param lde Receives the LDE.
+ * @return true if the request is valid, false otherwise.
+ */
+bool corpus_parse_line(const char *line, LDE *lde) {
+    long coeffs[3];
+    char x[MAX_DOMAIN_LEN] = "real";
+    char y[MAX_DOMAIN_LEN] = "real";
+    char extra;
+    int num_fields = sscanf(line, "%ld %ld %ld %63s %63s %c", &coeffs[0],
+                            &coeffs[1], &coeffs[2], x, y, &extra);
+    if (num_fields < 3 || num_fields > 5) {
+        return false;
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (coeffs[i] < NEG_INF || coeffs[i] > POS_INF) {
+            return false;
+        }
+    }
+
+    *lde = make_lde_in(coeffs[0], coeffs[1], coeffs[2],
+                       str_to_interval(x), str_to_interval(y));
+    return is_valid_interval(lde->xi) && is_valid_interval(lde->yi);
+}
+
+/**
+ * Parses a corpus in the text format. Requests before the first class line
+ * belong to the realistic class.
+ *
+ * @param text The corpus, which is modified in place.
+ * @return The corpus, or a corpus with "valid" set to false.
+ */
+Corpus corpus_parse_text(char *text) {
+    Corpus corpus = {NULL, NULL, 0, 0, true};
+    int capacity = 0;
+    CorpusClass cls = CORPUS_REALISTIC;
+
+    for (char *line = text; *line;) {
+        char *end = line + strcspn(line, "\n");
+        char *next = *end ? end + 1 : end;
+        *end = '\0';
+        if (end > line && end[-1] == '\r') {
+            end[-1] = '\0';
+        }
+
+        char name[32];
+        unsigned long long seed;
+        if (sscanf(line, "# class %31s", name) == 1) {
+            int k = 0;
+            while (k < NUM_CORPUS_CLASSES &&
+                   !equal_str(name, corpus_class_names[k])) {
+                ++k;
+            }
+            if (k == NUM_CORPUS_CLASSES) {
+                corpus.valid = false;
+                break;
+            }
+            cls = k;
+        } else if (sscanf(line, "# seed %llu", &seed) == 1) {
+            corpus.seed = seed;
+        } else if (line[strspn(line, " \t")] && line[0] != '#') {
+            LDE lde;
+            if (!corpus_parse_line(line, &lde)) {
+                corpus.valid = false;
+                break;
+            }
+            corpus_add(&corpus, &capacity, lde, cls);
+        }
+        line = next;
+    }
+    return corpus;
+}
+
+/**
+ * Parses a corpus in the binary format.
+ *
+ * @param data The corpus.
+ * @param size Size of data in bytes.
+ * @return The corpus, or a corpus with "valid" set to false.
+ */
+Corpus corpus_parse_binary(const char *data, size_t size) {
+    Corpus corpus = {NULL, NULL, 0, 0, false};
+    CorpusHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != CORPUS_VERSION ||
+        header.record_size != sizeof(CacheRecord) ||
+        size != sizeof(header) + (size_t) header.count * sizeof(CacheRecord)) {
+        return corpus;
+    }
+
+    corpus.valid = true;
+    corpus.seed = header.seed;
+    int capacity = 0;
+    for (uint32_t i = 0; i < header.count; ++i) {
+        CacheRecord rec;
+        memcpy(&rec, data + sizeof(header) + i * sizeof(rec), sizeof(rec));
+        LDE lde = cache_record_lde(&rec);
+        if (rec.state >= NUM_CORPUS_CLASSES ||
+            !is_valid_interval(lde.xi) || !is_valid_interval(lde.yi)) {
+            corpus.valid = false;
+            break;
+        }
+        corpus_add(&corpus, &capacity, lde, rec.state);
+    }
+    return corpus;
+}
+
+Corpus corpus_read(FILE *in) {
+    size_t size = 0;
+    size_t capacity = 65536;
+    char *data = dio_malloc(capacity + 1);
+    size_t n;
+    while ((n = fread(data + size, 1, capacity - size, in)) > 0) {
+        size += n;
+        if (size == capacity) {
+            capacity *= 2;
+            data = dio_realloc(data, capacity + 1);
+        }
+    }
+    data[size] = '\0';
+
+    Corpus corpus = {NULL, NULL, 0, 0, false};
+    uint32_t magic = 0;
+    memcpy(&magic, data, size < sizeof(magic) ? size : sizeof(magic));
+    if (ferror(in)) {
+        // Leave the corpus invalid
+    } else if (magic == CORPUS_MAGIC && size >= sizeof(CorpusHeader)) {
+        corpus = corpus_parse_binary(data, size);
+    } else if (strlen(data) == size) {
+        corpus = corpus_parse_text(data);
+    }
+    dio_free(data);
+
+    if (!corpus.valid) {
+        corpus_free(&corpus);
+    }
+    return corpus;
+}
+
+void corpus_free(Corpus *corpus) {
+    dio_free(corpus->ldes);
+    dio_free(corpus->classes);
+    corpus->ldes = NULL;
+    corpus->classes = NULL;
+    corpus->size = 0;
+    corpus->valid = false;
+}
+
+bool equal_lde(LDE l1, LDE l2) {
+    return l1.a == l2.a && l1.b == l2.b && l1.c == l2.c &&
+           equal_interval(l1.xi, l2.xi) && equal_interval(l1.yi, l2.yi);
+}
+
+void test_corpus_generate() {
+    Corpus corpus = corpus_generate(500, 7);
+    assert(corpus.valid);
+    assert(corpus.size == 500 * NUM_CORPUS_CLASSES);
+
+    Corpus again = corpus_generate(500, 7);
+    Corpus other = corpus_generate(500, 8);
+    bool same = true;
+    for (int i = 0; i < corpus.size; ++i) {
+        assert(equal_lde(corpus.ldes[i], again.ldes[i]));
+        same &= equal_lde(corpus.ldes[i], other.ldes[i]);
+    }
+    assert(!same);
+    corpus_free(&again);
+    corpus_free(&other);
+
+    for (int i = 0; i < corpus.size; ++i) {
+        LDE lde = corpus.ldes[i];
+        CorpusClass cls = corpus.classes[i];
+        assert(cls == i / 500);
+        assert(is_valid_interval(lde.xi) && is_valid_interval(lde.yi));
+
+        if (cls == CORPUS_FIBONACCI) {
+            // Every quotient of the EEA is 1
+            EEA_Table table = eea_table(lde.a, lde.b);
+            assert(table.size >= 20);
+            list_free(table);
+        } else if (cls == CORPUS_DEGENERATE) {
+            assert(lde.a == 0 || lde.b == 0);
+        } else if (cls == CORPUS_UNSOLVABLE) {
+            int d = eea_gcd_row(eea_2nd_last_row(lde.a, lde.b));
+            assert(d > 1 && lde.c % d != 0);
+        } else if (cls == CORPUS_NEAR_OVERFLOW) {
+            assert(abs(lde.a) > POS_INF - 200 || abs(lde.b) > POS_INF - 200);
+            assert(abs(lde.c) >= POS_INF - 100);
+        } else if (cls == CORPUS_EMPTY_DOMAIN) {
+            assert(num_int_in(lde.xi) <= 0 || num_int_in(lde.yi) <= 0);
+        }
+    }
+    corpus_free(&corpus);
+}
+
+void test_corpus_round_trip() {
+    Corpus corpus = corpus_generate(100, 135);
+    for (int binary = 0; binary < 2; ++binary) {
+        FILE *file = tmpfile();
+        assert(file);
+        assert(binary ? corpus_write_binary(&corpus, file)
+                      : corpus_write_text(&corpus, file));
+        rewind(file);
+        Corpus loaded = corpus_read(file);
+        fclose(file);
+
+        assert(loaded.valid);
+        assert(loaded.size == corpus.size);
+        assert(loaded.seed == 135);
+        for (int i = 0; i < corpus.size; ++i) {
+            assert(equal_lde(loaded.ldes[i], corpus.ldes[i]));
+            assert(loaded.classes[i] == corpus.classes[i]);
+        }
+        corpus_free(&loaded);
+    }
+    corpus_free(&corpus);
+}
+
+void test_corpus_read() {
+    char text[] = "9 5 137\n\n# class fibonacci\r\n-8 5 1 pos [0,10)\n";
+    FILE *file = fmemopen(text, strlen(text), "r");
+    Corpus corpus = corpus_read(file);
+    fclose(file);
+    assert(corpus.valid && corpus.size == 2);
+    assert(equal_lde(corpus.ldes[0], make_lde(9, 5, 137)));
+    assert(corpus.classes[0] == CORPUS_REALISTIC);
+    assert(equal_lde(corpus.ldes[1], make_lde_in(-8, 5, 1, POS,
+                                                 make_interval(0, 10, false, true))));
+    assert(corpus.classes[1] == CORPUS_FIBONACCI);
+    corpus_free(&corpus);
+
+    char request[CORPUS_MAX_REQUEST];
+    corpus_request(make_lde_in(-8, 5, POS_INF, make_interval(NEG_INF, 3, true, false),
+                               make_interval(1234567, POS_INF, true, true)),
+                   request, sizeof(request));
+    assert(equal_str(request, "-8 5 2147483647 (-inf,3] (1234567,inf)\n"));
+
+    const char *bad[] = {
+        "1 2", "1 2 x", "1 2 3000000000", "1 2 3 (1,0)", "1 2 3 real real real",
+        "# class huge\n1 2 3",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        file = fmemopen((void*) bad[i], strlen(bad[i]), "r");
+        corpus = corpus_read(file);
+        fclose(file);
+        assert(!corpus.valid && !corpus.ldes);
+    }
+
+    CorpusHeader header = {CORPUS_MAGIC, CORPUS_VERSION + 1,
+                           sizeof(CacheRecord), 0, 0, {0}};
+    file = fmemopen(&header, sizeof(header), "r");
+    corpus = corpus_read(file);
+    fclose(file);
+    assert(!corpus.valid);
+}
+
+void test_corpus_h() {
+    test_corpus_generate();
+    test_corpus_round_trip();
+    test_corpus_read();
+}
@@ -0,0 +1,163 @@
+/**
+ * "corpus.h" generates, saves and loads reproducible sets of LDEs for
+ * benchmarking, so that every benchmark and the end-to-end harness run on
+ * the same known data.
+ *
+ * A corpus holds the same number of LDEs of each class, grouped by class.
+ * The LDEs of class k are drawn from a generator seeded with
+ * seed * 0x9E3779B97F4A7C15 + k + 1, so a corpus depends only on its seed
+ * and its count per class.
+ *
+ * Text format: one request of "proto.h" per line ("a b c x-domain y-domain"
+ * with exact bounds), preceded by a "# class NAME" line for each class.
+ * Strip the comment lines ("grep -v '^#'") to send the file to the server.
+ *
+ * Binary format (host byte order):
+ *   CorpusHeader                     (64 bytes)
+ *   CacheRecord[count]               (see "cache.h")
+ * The state of each record holds the class of its LDE, and its solution set
+ * is NO_SOLN_SET, as in an unsolved slot of "shmring.h".
+ */
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include "cache.h"
+#include "lde.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Identifies a binary corpus file ("DIOK")
+#define CORPUS_MAGIC 0x4B4F4944u
+
+// Incremented whenever the layout of CorpusHeader or CacheRecord changes
+#define CORPUS_VERSION 1
+
+// Maximum length of a request in the text format, including its newline
+#define CORPUS_MAX_REQUEST 128
+
+/**
+ * Classes of generated LDEs.
+ */
+typedef enum CorpusClass {
+    CORPUS_SMALL,           // |a|, |b| <= 100
+    CORPUS_MEDIUM,          // |a|, |b| <= 100000
+    CORPUS_LARGE,           // Uniform over the 32-bit range
+    CORPUS_FIBONACCI,       // Consecutive Fibonacci numbers (deepest EEA)
+    CORPUS_DEGENERATE,      // a = 0, b = 0, or both
+    CORPUS_UNSOLVABLE,      // c is not a multiple of gcd(a, b)
+    CORPUS_NEAR_OVERFLOW,   // a, b and c near POS_INF for eea_lde_row()
+    CORPUS_EMPTY_DOMAIN,    // A domain without any integer
+    CORPUS_REALISTIC,       // Mostly small and solvable, as typed by users
+    NUM_CORPUS_CLASSES,
+} CorpusClass;
+
+/**
+ * Header at the beginning of a binary corpus file.
+ */
+typedef struct CorpusHeader {
+    uint32_t magic;         // Must be CORPUS_MAGIC
+    uint32_t version;       // Must be CORPUS_VERSION
+    uint32_t record_size;   // Must be sizeof(CacheRecord)
+    uint32_t count;         // Number of records
+    uint64_t seed;          // Seed of the generator
+    uint32_t reserved[10];
+} CorpusHeader;
+
+/**
+ * Represents a set of LDEs, grouped by class.
+ */
+typedef struct Corpus {
+    LDE *ldes;              // The LDEs
+    uint8_t *classes;       // The CorpusClass of each LDE
+    int size;               // Number of LDEs
+    uint64_t seed;          // Seed of the generator, if known
+
+    bool valid;             // True if the corpus was generated or loaded
+} Corpus;
+
+/**
+ * Gets the name of a class, such as "fibonacci".
+ *
+ * @param cls The class.
+ * @return The name of cls.
+ */
+const char *corpus_class_name(CorpusClass cls);
+
+/**
+ * Generates the next LDE of a class.
+ *
+ * @param cls The class of the LDE.
+ * @param state State of the xorshift64* generator, updated in place.
+ * @return A valid LDE of class cls.
+ */
+LDE corpus_lde(CorpusClass cls, uint64_t *state);
+
+/**
+ * Generates a corpus.
+ *
+ * @param count Number of LDEs of each class.
+ * @param seed Seed of the generator.
+ * @return The corpus, which must be freed by corpus_free().
+ */
+Corpus corpus_generate(int count, uint64_t seed);
+
+/**
+ * Formats an LDE as a request in the text format.
+ *
+ * @param lde The LDE.
+ * @param buf Receives the request, including its newline.
+ * @param size Size of buf, normally CORPUS_MAX_REQUEST.
+ * @return The length of the request.
+ */
+int corpus_request(LDE lde, char *buf, size_t size);
+
+/**
+ * Writes a corpus in the text format.
+ *
+ * @param corpus The corpus.
+ * @param out The stream to write to.
+ * @return true if every line was written, false otherwise.
+ */
+bool corpus_write_text(const Corpus *corpus, FILE *out);
+
+/**
+ * Writes a corpus in the binary format.
+ *
+ * @param corpus The corpus.
+ * @param out The stream to write to.
+ * @return true if every record was written, false otherwise.
+ */
+bool corpus_write_binary(const Corpus *corpus, FILE *out);
+
+/**
+ * Reads a corpus in either format, detected from its first bytes.
+ *
+ * @param in The stream to read from.
+ * @return The corpus, which must be freed by corpus_free(), or a corpus
+ *         with "valid" set to false if the input is malformed.
+ */
+Corpus corpus_read(FILE *in);
+
+/**
+ * Frees a corpus.
+ *
+ * @param corpus The corpus to free.
+ */
+void corpus_free(Corpus *corpus);
+
+/**
+ * Runs unit tests for functions in "corpus.h".
+ */
+void test_corpus_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * Generates a benchmark corpus (see "corpus.h").
+ *
+ * Usage: corpusgen [--count N] [--seed S] [--binary] FILE
+ *
+ * Writes N LDEs of each class, seeded with S, to FILE ("-" for standard
+ * output) in the text format, or in the binary format with --binary. The
+ * same N and S always produce the same corpus, which "harness --corpus FILE"
+ * and "loadgen --corpus FILE" then run on. With the defaults of both, the
+ * first six classes match those generated by the harness itself.
+ */
+
+#include "diosolver.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+int main(int argc, char *argv[]) {
+    int count = 10000;
+    uint64_t seed = 135;
+    bool binary = false;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (equal_str(argv[i], "--count") && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else if (equal_str(argv[i], "--seed") && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (equal_str(argv[i], "--binary")) {
+            binary = true;
+        } else if (!path && argv[i][0] && (argv[i][0] != '-' || !argv[i][1])) {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "Usage: %s [--count N] [--seed S] [--binary] FILE\n",
+                argv[0]);
+        return 2;
+    }
+    if (count <= 0) {
+        fprintf(stderr, "%s: --count must be positive\n", argv[0]);
+        return 2;
+    }
+
+    FILE *out = equal_str(path, "-") ? stdout : fopen(path, binary ? "wb" : "w");
+    if (!out) {
+        perror(path);
+        return 1;
+    }
+
+    Corpus corpus = corpus_generate(count, seed);
+    bool ok = binary ? corpus_write_binary(&corpus, out)
+                     : corpus_write_text(&corpus, out);
+    ok &= (out == stdout) ? !fflush(out) : !fclose(out);
+    corpus_free(&corpus);
+
+    if (!ok) {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
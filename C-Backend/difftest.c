@@ -0,0 +1,771 @@
+/**
+ * Differential tester of the C backend against a reference model.
+ *
+ * Usage: difftest [--count N] [--seed S] [--show K] [--racket FILE]
+ *
+ * A reproducible mix of random and adversarial LDEs is generated: small and
+ * 32-bit coefficients, consecutive Fibonacci numbers (the deepest EEA),
+ * coefficients near overflow, a = 0 or b = 0, unsolvable c, and domains that
+ * are empty, contain no integer, or end near the infinities. The classes
+ * other than small and 32-bit coefficients are those of "corpus.h", with
+ * the domains above. Each LDE is run through the fast paths of the backend
+ * and checked:
+ *   soln_set   lde_soln_set() against the reference model, as sets of
+ *              points: the particular solution must satisfy the LDE, the
+ *              direction must match up to sign, and the n-interval must
+ *              map to the same solutions
+ *   prepared   prepared_soln_set() against lde_soln_set()
+ *   eea_row    eea_2nd_last_row() against the second last row of eea_table()
+ *   record     lde_soln_set() after a round trip through a CacheRecord, as
+ *              in the cache and the shared-memory ring
+ *   steps      lde_result() against lde_soln_set(): whether a solution
+ *              exists, the particular solution, and the interval of n
+ *
+ * The reference model is a port of Racket-Impl/lde.rkt in exact 128-bit
+ * arithmetic. Where the Racket code uses 2^32 as infinity, the model uses
+ * the infinities of the C code: a domain bound of NEG_INF or POS_INF is
+ * unbounded. A particular solution that does not satisfy the LDE is reported
+ * as "wrong"; an n-interval is reported as "overflow" rather than wrong only
+ * if the ends it should have do not fit in an int.
+ *
+ * Mismatches are counted per check and kind, and the first K of each are
+ * printed as requests of "proto.h", so that "diosolver" can replay them.
+ * The exit status is 1 if any check failed.
+ *
+ * With --racket FILE, the first cases with a ≠ 0 and b ≠ 0 are also written
+ * to FILE as a Racket module that checks Racket-Impl against the model,
+ * where Racket is installed:
+ *   ./difftest --racket /tmp/cases.rkt && raco test /tmp/cases.rkt
+ */
+
+#include "diosolver.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+// Maximum number of cases written with --racket
+#define MAX_RACKET_CASES 10000
+
+// Maximum number of distinct kinds of mismatch
+#define MAX_KINDS 32
+
+typedef __int128 i128;
+
+/**
+ * A domain of the model. A missing bound is unbounded.
+ */
+typedef struct Dom {
+    bool low_inf;
+    bool low_open;
+    i128 low;
+    bool high_inf;
+    bool high_open;
+    i128 high;
+} Dom;
+
+/**
+ * A range of integers, which is empty if low > high.
+ */
+typedef struct NRange {
+    bool low_inf;
+    i128 low;
+    bool high_inf;
+    i128 high;
+} NRange;
+
+/**
+ * The solution set of the model, in the form of SolnSet.
+ */
+typedef struct Model {
+    bool plane;
+    bool exist;
+    i128 d;
+    i128 x0;
+    i128 y0;
+    i128 dx;
+    i128 dy;
+    NRange n;
+} Model;
+
+/**
+ * Mismatches of one kind in one check, with the first few cases.
+ */
+typedef struct Mismatch {
+    const char *check;
+    const char *kind;
+    long long count;
+    int num_shown;
+    char **shown;
+} Mismatch;
+
+Mismatch mismatches[MAX_KINDS];
+int num_mismatches;
+int max_shown = 5;
+
+int rng_range(uint64_t *state, int low, int high) {
+    return low + (long long) (xorshift_next(state) % ((long long) high - low + 1));
+}
+
+/**
+ * Picks a domain, with about half of them adversarial.
+ */
+Interval rng_domain(uint64_t *state) {
+    int low = rng_range(state, -1000, 1000);
+    int near = rng_range(state, 0, 100);
+    bool left_open = xorshift_next(state) & 1;
+    bool right_open = xorshift_next(state) & 1;
+    switch (rng_range(state, 0, 11)) {
+    case 0:
+        return REAL;
+    case 1:
+        return POS;
+    case 2:
+        return NEG;
+    case 3:
+        return NONPOS;
+    case 4:
+        return NONNEG;
+    case 5:
+        return make_interval(low, low + rng_range(state, 0, 1000),
+                             left_open, right_open);
+    case 6:
+        // Empty, or without an integer
+        return make_interval(low, low + rng_range(state, -1, 1),
+                             left_open, right_open);
+    case 7:
+        return make_interval(low, POS_INF, left_open, true);
+    case 8:
+        return make_interval(NEG_INF, low, true, right_open);
+    case 9:
+        return make_interval(POS_INF - near - 1, POS_INF, left_open, true);
+    case 10:
+        return make_interval(NEG_INF, NEG_INF + near + 1, true, right_open);
+    }
+    return make_interval(rng_range(state, NEG_INF + 1, 0),
+                         rng_range(state, 0, POS_INF - 1), left_open, right_open);
+}
+
+LDE gen_small(uint64_t *state) {
+    return make_lde_in(rng_range(state, -100, 100), rng_range(state, -100, 100),
+                       rng_range(state, -1000, 1000),
+                       rng_domain(state), rng_domain(state));
+}
+
+LDE gen_large(uint64_t *state) {
+    return make_lde_in(rng_range(state, NEG_INF, POS_INF),
+                       rng_range(state, NEG_INF, POS_INF),
+                       rng_range(state, NEG_INF, POS_INF),
+                       rng_domain(state), rng_domain(state));
+}
+
+/**
+ * Generates an LDE of a class of "corpus.h", with domains of rng_domain()
+ * instead of those of the corpus.
+ */
+LDE gen_corpus(CorpusClass cls, uint64_t *state) {
+    LDE lde = corpus_lde(cls, state);
+    lde.xi = rng_domain(state);
+    lde.yi = rng_domain(state);
+    return lde;
+}
+
+i128 abs128(i128 n) {
+    return n < 0 ? -n : n;
+}
+
+i128 floor_div(i128 n, i128 m) {
+    i128 q = n / m;
+    return (n % m != 0 && (n < 0) != (m < 0)) ? q - 1 : q;
+}
+
+i128 ceil_div(i128 n, i128 m) {
+    i128 q = n / m;
+    return (n % m != 0 && (n < 0) == (m < 0)) ? q + 1 : q;
+}
+
+Dom model_dom(Interval intvl) {
+    return (Dom) {
+        intvl.low == NEG_INF, intvl.left_open, (i128) intvl.low,
+        intvl.high == POS_INF, intvl.right_open, (i128) intvl.high,
+    };
+}
+
+/**
+ * Finds the integers n such that k + m * n is in a domain, where m ≠ 0.
+ */
+NRange range_in(i128 k, i128 m, Dom dom) {
+    if (m < 0) {
+        Dom neg = {
+            dom.high_inf, dom.high_open, -dom.high,
+            dom.low_inf, dom.low_open, -dom.low,
+        };
+        return range_in(-k, -m, neg);
+    }
+
+    NRange range = {dom.low_inf, 0, dom.high_inf, 0};
+    if (!dom.low_inf) {
+        range.low = dom.low_open ? floor_div(dom.low - k, m) + 1
+                                 : ceil_div(dom.low - k, m);
+    }
+    if (!dom.high_inf) {
+        range.high = dom.high_open ? ceil_div(dom.high - k, m) - 1
+                                   : floor_div(dom.high - k, m);
+    }
+    return range;
+}
+
+NRange intersect_range(NRange r1, NRange r2) {
+    NRange range = r1;
+    if (!r2.low_inf && (r1.low_inf || r2.low > r1.low)) {
+        range.low_inf = false;
+        range.low = r2.low;
+    }
+    if (!r2.high_inf && (r1.high_inf || r2.high < r1.high)) {
+        range.high_inf = false;
+        range.high = r2.high;
+    }
+    return range;
+}
+
+bool in_dom(i128 n, Dom dom) {
+    return (dom.low_inf || (dom.low_open ? n > dom.low : n >= dom.low)) &&
+           (dom.high_inf || (dom.high_open ? n < dom.high : n <= dom.high));
+}
+
+bool is_empty_range(NRange range) {
+    return !range.low_inf && !range.high_inf && range.low > range.high;
+}
+
+/**
+ * Solves an LDE with the algorithm of Racket-Impl/lde.rkt in exact
+ * arithmetic.
+ */
+Model model_solve(LDE lde) {
+    i128 a = lde.a;
+    i128 b = lde.b;
+    i128 c = lde.c;
+    Dom xi = model_dom(lde.xi);
+    Dom yi = model_dom(lde.yi);
+    Model model = {false, false, 0, 0, 0, 0, 0, {false, 0, false, -1}};
+
+    if (a == 0 && b == 0) {
+        model.plane = true;
+        model.exist = c == 0 && !is_empty_range(range_in(0, 1, xi)) &&
+                      !is_empty_range(range_in(0, 1, yi));
+        return model;
+    }
+
+    if (a == 0 || b == 0) {
+        // One variable is fixed at c / coeff, and the other one is n
+        i128 coeff = a ? a : b;
+        model.d = abs128(coeff);
+        if (c % coeff != 0 || !in_dom(c / coeff, a ? xi : yi)) {
+            return model;
+        }
+        model.x0 = a ? c / a : 0;
+        model.y0 = a ? 0 : c / b;
+        model.dx = a ? 0 : 1;
+        model.dy = a ? 1 : 0;
+        model.n = range_in(0, 1, a ? yi : xi);
+        model.exist = !is_empty_range(model.n);
+        return model;
+    }
+
+    // Second last row of the EEA table, as in eea-2nd-last-row
+    i128 r1[3] = {1, 0, abs128(a) > abs128(b) ? abs128(a) : abs128(b)};
+    i128 r2[3] = {0, 1, abs128(a) > abs128(b) ? abs128(b) : abs128(a)};
+    while (r2[2] != 0) {
+        i128 q = r1[2] / r2[2];
+        i128 r[3] = {r1[0] - r2[0] * q, r1[1] - r2[1] * q, r1[2] % r2[2]};
+        memcpy(r1, r2, sizeof(r1));
+        memcpy(r2, r, sizeof(r2));
+    }
+    model.d = r1[2];
+    if (c % model.d != 0) {
+        return model;
+    }
+
+    // Particular solution, as in eea-lde
+    i128 factor = c / model.d;
+    i128 x = r1[0] * factor;
+    i128 y = r1[1] * factor;
+    i128 sign_a = a > 0 ? 1 : -1;
+    i128 sign_b = b > 0 ? 1 : -1;
+    model.x0 = abs128(a) > abs128(b) ? x * sign_a : y * sign_a;
+    model.y0 = abs128(a) > abs128(b) ? y * sign_b : x * sign_b;
+    model.dx = b / model.d;
+    model.dy = -a / model.d;
+    model.n = intersect_range(range_in(model.x0, model.dx, xi),
+                              range_in(model.y0, model.dy, yi));
+    model.exist = !is_empty_range(model.n);
+    return model;
+}
+
+bool fits_int(i128 n) {
+    return n > NEG_INF && n < POS_INF;
+}
+
+bool equal_range(NRange r1, NRange r2) {
+    return r1.low_inf == r2.low_inf && r1.high_inf == r2.high_inf &&
+           (r1.low_inf || r1.low == r2.low) &&
+           (r1.high_inf || r1.high == r2.high);
+}
+
+/**
+ * Compares the line of a SolnSet with that of the model as sets of points,
+ * so that any particular solution and either direction of n are accepted.
+ *
+ * @return The kind of mismatch, or NULL if both lines have the same points.
+ */
+const char *compare_line(LDE lde, SolnSet set, const Model *model) {
+    if ((i128) lde.a * set.x0 + (i128) lde.b * set.y0 != lde.c) {
+        return "wrong";
+    }
+    int sign = (set.dx == model->dx && set.dy == model->dy) ? 1
+             : (set.dx == -model->dx && set.dy == -model->dy) ? -1 : 0;
+    if (!sign) {
+        return "direction";
+    }
+
+    // (x0, y0) is the point of the model at m = t, so n maps to t + sign * n
+    i128 t = model->dx ? (set.x0 - model->x0) / model->dx
+                       : (set.y0 - model->y0) / model->dy;
+    if (set.x0 != model->x0 + t * model->dx ||
+        set.y0 != model->y0 + t * model->dy) {
+        return "wrong";
+    }
+    bool low_inf = set.n_intvl.low == NEG_INF;
+    bool high_inf = set.n_intvl.high == POS_INF;
+    i128 low = (i128) set.n_intvl.low;
+    i128 high = (i128) set.n_intvl.high;
+    NRange got = (sign > 0) ? (NRange) {low_inf, t + low, high_inf, t + high}
+                            : (NRange) {high_inf, t - high, low_inf, t - low};
+    if (equal_range(got, model->n)) {
+        return NULL;
+    }
+
+    // An n-interval whose expected ends do not fit in an int cannot be
+    // represented at all
+    i128 n_low = (sign > 0) ? model->n.low - t : t - model->n.high;
+    i128 n_high = (sign > 0) ? model->n.high - t : t - model->n.low;
+    bool n_low_inf = (sign > 0) ? model->n.low_inf : model->n.high_inf;
+    bool n_high_inf = (sign > 0) ? model->n.high_inf : model->n.low_inf;
+    return ((n_low_inf || fits_int(n_low)) && (n_high_inf || fits_int(n_high)))
+           ? "n_interval" : "overflow";
+}
+
+/**
+ * Formats a domain as accepted by str_to_interval(), without rounding.
+ */
+void append_domain(StrBuf *buf, Interval intvl) {
+    strbuf_append(buf, " %c", intvl.left_open ? '(' : '[');
+    if (intvl.low == NEG_INF) {
+        strbuf_append(buf, "-inf");
+    } else {
+        strbuf_append(buf, "%.0f", intvl.low);
+    }
+    if (intvl.high == POS_INF) {
+        strbuf_append(buf, ",inf");
+    } else {
+        strbuf_append(buf, ",%.0f", intvl.high);
+    }
+    strbuf_append(buf, "%c", intvl.right_open ? ')' : ']');
+}
+
+/**
+ * Records a mismatch of an LDE.
+ *
+ * @param check Name of the failed check.
+ * @param kind What differed.
+ * @param lde The LDE.
+ * @param detail Expected and actual values, or NULL.
+ */
+void report(const char *check, const char *kind, LDE lde, const char *detail) {
+    Mismatch *m = NULL;
+    for (int i = 0; i < num_mismatches && !m; ++i) {
+        if (equal_str(mismatches[i].check, check) &&
+            equal_str(mismatches[i].kind, kind)) {
+            m = &mismatches[i];
+        }
+    }
+    if (!m && num_mismatches == MAX_KINDS) {
+        return;
+    }
+    if (!m) {
+        m = &mismatches[num_mismatches++];
+        *m = (Mismatch) {check, kind, 0, 0, calloc(max_shown, sizeof(char*))};
+    }
+
+    ++m->count;
+    if (m->num_shown < max_shown) {
+        StrBuf buf = make_strbuf();
+        strbuf_append(&buf, "%d %d %d", lde.a, lde.b, lde.c);
+        append_domain(&buf, lde.xi);
+        append_domain(&buf, lde.yi);
+        if (detail) {
+            strbuf_append(&buf, "  # %s", detail);
+        }
+        m->shown[m->num_shown++] = buf.str;
+    }
+}
+
+void append_i128(StrBuf *buf, i128 n) {
+    char digits[48];
+    int len = 0;
+    unsigned __int128 u = n < 0 ? -(unsigned __int128) n : n;
+    do {
+        digits[len++] = '0' + u % 10;
+        u /= 10;
+    } while (u);
+    if (n < 0) {
+        strbuf_append(buf, "-");
+    }
+    while (len) {
+        strbuf_append(buf, "%c", digits[--len]);
+    }
+}
+
+void append_range(StrBuf *buf, NRange range) {
+    strbuf_append(buf, "[");
+    if (range.low_inf) {
+        strbuf_append(buf, "-inf");
+    } else {
+        append_i128(buf, range.low);
+    }
+    strbuf_append(buf, ",");
+    if (range.high_inf) {
+        strbuf_append(buf, "inf");
+    } else {
+        append_i128(buf, range.high);
+    }
+    strbuf_append(buf, "]");
+}
+
+void check_soln_set(LDE lde, SolnSet set, const Model *model) {
+    const char *kind = NULL;
+    if (set.plane != model->plane || set.exist != model->exist) {
+        kind = "exist";
+    } else if (!model->plane && set.d != model->d) {
+        kind = "d";
+    } else if (set.exist && !set.plane) {
+        kind = compare_line(lde, set, model);
+    }
+    if (!kind) {
+        return;
+    }
+
+    StrBuf detail = make_strbuf();
+    strbuf_append(&detail, "expected ");
+    if (!model->exist) {
+        strbuf_append(&detail, "no solution");
+    } else if (model->plane) {
+        strbuf_append(&detail, "plane");
+    } else {
+        strbuf_append(&detail, "x0=");
+        append_i128(&detail, model->x0);
+        strbuf_append(&detail, " y0=");
+        append_i128(&detail, model->y0);
+        strbuf_append(&detail, " n∈");
+        append_range(&detail, model->n);
+    }
+    char *set_str = soln_set_to_str(set);
+    strbuf_append(&detail, ", got %s", set_str);
+    dio_free(set_str);
+    report("soln_set", kind, lde, detail.str);
+    strbuf_free(&detail);
+}
+
+/**
+ * Finds a string in the lines of a result.
+ *
+ * @return The rest of the line after str, or NULL if no line contains str.
+ */
+const char *find_after(List result, const char *str) {
+    for (int i = 0; i < result.size; ++i) {
+        const char *found = strstr(list_at(result, i, char*), str);
+        if (found) {
+            return found + strlen(str);
+        }
+    }
+    return NULL;
+}
+
+void check_steps(LDE lde, SolnSet set) {
+    List result = lde_result(lde);
+    bool no_soln = false;
+    for (int i = 0; i < result.size && !no_soln; ++i) {
+        const char *line = list_at(result, i, char*);
+        no_soln = strstr(line, "has no solution") ||
+                  strstr(line, "has no integer solution");
+    }
+
+    if (no_soln == set.exist) {
+        report("steps", "exist", lde, set.exist ? "text says no solution"
+                                                : "text has a solution");
+    } else if (set.exist && lde.a != 0 && lde.b != 0) {
+        const char *x0 = find_after(result, "\tx₀ = ");
+        const char *y0 = find_after(result, "\ty₀ = ");
+        const char *n = find_after(result, "\tn ∈ ");
+        char *n_str = interval_to_str(set.n_intvl);
+        if (!x0 || !y0 || atoi(x0) != set.x0 || atoi(y0) != set.y0) {
+            report("steps", "particular", lde, NULL);
+        } else if (!n || strncmp(n, n_str, strlen(n_str)) ||
+                   n[strlen(n_str)] != '\n') {
+            report("steps", "n_interval", lde, NULL);
+        }
+        dio_free(n_str);
+    }
+    lde_result_free(result);
+}
+
+void check_lde(LDE lde) {
+    SolnSet set = lde_soln_set(lde);
+    Model model = model_solve(lde);
+    check_soln_set(lde, set, &model);
+
+    PreparedLDE prep = prepare_lde(lde.a, lde.b);
+    if (!equal_soln_set(prepared_soln_set(&prep, lde.c, lde.xi, lde.yi), set)) {
+        report("prepared", "differs", lde, NULL);
+    }
+
+    if (lde.a != 0 && lde.b != 0) {
+        EEA_Table table = eea_table(lde.a, lde.b);
+        EEAR row = list_at(table, table.size - 2, EEAR);
+        if (!equal_eear(row, eea_2nd_last_row(lde.a, lde.b))) {
+            report("eea_row", "differs", lde, NULL);
+        }
+        list_free(table);
+    }
+
+    CacheRecord rec;
+    cache_record_pack(&rec, lde, set);
+    LDE unpacked = cache_record_lde(&rec);
+    if (!equal_soln_set(cache_record_soln_set(&rec), set) ||
+        unpacked.a != lde.a || unpacked.b != lde.b || unpacked.c != lde.c ||
+        !equal_interval(unpacked.xi, lde.xi) ||
+        !equal_interval(unpacked.yi, lde.yi)) {
+        report("record", "differs", lde, NULL);
+    }
+
+    check_steps(lde, set);
+}
+
+void write_racket_bound(FILE *out, double bound) {
+    if (bound == NEG_INF) {
+        fprintf(out, "-inf");
+    } else if (bound == POS_INF) {
+        fprintf(out, "+inf");
+    } else {
+        fprintf(out, "%.0f", bound);
+    }
+}
+
+void write_racket_domain(FILE *out, Interval intvl) {
+    fprintf(out, " (make-interval ");
+    write_racket_bound(out, intvl.low);
+    fprintf(out, " ");
+    write_racket_bound(out, intvl.high);
+    fprintf(out, " %s %s)", intvl.left_open ? "#t" : "#f",
+            intvl.right_open ? "#t" : "#f");
+}
+
+void write_racket_int(FILE *out, bool inf, i128 n, const char *inf_name) {
+    if (inf) {
+        fprintf(out, " %s", inf_name);
+        return;
+    }
+    StrBuf buf = make_strbuf();
+    append_i128(&buf, n);
+    fprintf(out, " %s", buf.str);
+    strbuf_free(&buf);
+}
+
+FILE *open_racket(const char *path) {
+    char *impl = realpath("../Racket-Impl", NULL);
+    if (!impl) {
+        perror("../Racket-Impl");
+        return NULL;
+    }
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        free(impl);
+        return NULL;
+    }
+
+    fprintf(out,
+        "#lang racket\n"
+        ";; Generated by difftest: checks Racket-Impl against the reference\n"
+        ";; model of the C differential tester. The model uses the infinities\n"
+        ";; of the C code, which are written here as -inf and +inf.\n"
+        "(require rackunit (file \"%1$s/eea.rkt\") (file \"%1$s/intvl.rkt\")\n"
+        "         (file \"%1$s/ineq.rkt\"))\n"
+        "\n"
+        ";; eea-lde is not provided by lde.rkt, so it is taken from its namespace\n"
+        "(define lde-rkt '(file \"%1$s/lde.rkt\"))\n"
+        "(dynamic-require lde-rkt #f)\n"
+        "(define eea-lde (eval 'eea-lde (module->namespace lde-rkt)))\n"
+        "\n"
+        "(define (solve a b c xi yi)\n"
+        "  (define row (eea-2nd-last-row a b))\n"
+        "  (define part (eea-lde a b c #:row row))\n"
+        "  (cond [(false? part) #f]\n"
+        "        [else\n"
+        "         (define d (eea-gcd row))\n"
+        "         (define n (int-interval\n"
+        "                    (solve-ineq-sys (list (first part) (/ b d))\n"
+        "                                    (list (second part) (/ (- a) d))\n"
+        "                                    xi yi)))\n"
+        "         (and (valid-interval? n)\n"
+        "              (list (first part) (second part)\n"
+        "                    (interval-low n) (interval-high n)))]))\n"
+        "\n"
+        "(define (check-case a b c xi yi expected)\n"
+        "  (check-equal? (solve a b c xi yi) expected (format \"~a ~a ~a\" a b c)))\n"
+        "\n", impl);
+    free(impl);
+    return out;
+}
+
+/**
+ * Writes a case to the Racket module, unless its answer cannot be told
+ * apart from the infinities of Racket-Impl.
+ *
+ * @return true if the case was written.
+ */
+bool write_racket_case(FILE *out, LDE lde, const Model *model) {
+    const i128 racket_inf = (i128) 1 << 32;
+    if (lde.a == 0 || lde.b == 0 ||
+        (model->exist && ((!model->n.low_inf && abs128(model->n.low) >= racket_inf) ||
+                          (!model->n.high_inf && abs128(model->n.high) >= racket_inf)))) {
+        return false;
+    }
+
+    fprintf(out, "(check-case %d %d %d", lde.a, lde.b, lde.c);
+    write_racket_domain(out, lde.xi);
+    write_racket_domain(out, lde.yi);
+    if (!model->exist) {
+        fprintf(out, " #f)\n");
+        return true;
+    }
+    fprintf(out, " (list");
+    write_racket_int(out, false, model->x0, NULL);
+    write_racket_int(out, false, model->y0, NULL);
+    write_racket_int(out, model->n.low_inf, model->n.low, "-inf");
+    write_racket_int(out, model->n.high_inf, model->n.high, "+inf");
+    fprintf(out, "))\n");
+    return true;
+}
+
+void test_model() {
+    // The examples of Racket-Impl/lde.rkt
+    Model model = model_solve(make_lde_in(9, 5, 137, POS, POS));
+    assert(model.exist && model.x0 == -137 && model.y0 == 274);
+    assert(model.n.low == 28 && model.n.high == 30);
+
+    model = model_solve(make_lde_in(-9, 5, 137, POS, POS));
+    assert(model.exist && model.x0 == 137 && model.n.low == -27 && model.n.high_inf);
+
+    model = model_solve(make_lde_in(-9, -5, 137, POS, POS));
+    assert(!model.exist && model.d == 1);
+
+    model = model_solve(make_lde_in(10, 8, 99, POS, POS));
+    assert(!model.exist && model.d == 2);
+
+    model = model_solve(make_lde_in(-5, 0, 10, NEG, NONPOS));
+    assert(model.exist && model.x0 == -2 && model.n.low_inf && model.n.high == 0);
+
+    model = model_solve(make_lde_in(0, 0, 0, make_interval(5, 6, true, true), REAL));
+    assert(model.plane && !model.exist);
+}
+
+int main(int argc, char *argv[]) {
+    long long count = 1000000;
+    uint64_t seed = 135;
+    const char *racket_path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (equal_str(argv[i], "--count") && i + 1 < argc) {
+            count = atoll(argv[++i]);
+        } else if (equal_str(argv[i], "--seed") && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (equal_str(argv[i], "--show") && i + 1 < argc) {
+            max_shown = atoi(argv[++i]);
+        } else if (equal_str(argv[i], "--racket") && i + 1 < argc) {
+            racket_path = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--count N] [--seed S] [--show K] "
+                            "[--racket FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (count <= 0 || max_shown < 0 || seed == 0) {
+        fprintf(stderr, "--count must be positive, --show non-negative, "
+                        "and --seed non-zero\n");
+        return 2;
+    }
+    test_model();
+
+    FILE *racket = NULL;
+    if (racket_path && !(racket = open_racket(racket_path))) {
+        return 2;
+    }
+
+    const struct {
+        const char *name;
+        LDE (*gen)(uint64_t *state);    // NULL for a class of the corpus
+        CorpusClass cls;
+    } classes[] = {
+        {"small", gen_small, 0},
+        {"large", gen_large, 0},
+        {"fibonacci", NULL, CORPUS_FIBONACCI},
+        {"near_overflow", NULL, CORPUS_NEAR_OVERFLOW},
+        {"degenerate", NULL, CORPUS_DEGENERATE},
+        {"unsolvable", NULL, CORPUS_UNSOLVABLE},
+    };
+    int num_classes = sizeof(classes) / sizeof(classes[0]);
+
+    uint64_t state = seed;
+    int racket_cases = 0;
+    for (long long i = 0; i < count; ++i) {
+        int k = i % num_classes;
+        LDE lde = classes[k].gen ? classes[k].gen(&state)
+                                 : gen_corpus(classes[k].cls, &state);
+        check_lde(lde);
+        if (racket && racket_cases < MAX_RACKET_CASES) {
+            Model model = model_solve(lde);
+            racket_cases += write_racket_case(racket, lde, &model);
+        }
+    }
+    if (racket && fclose(racket)) {
+        perror(racket_path);
+        return 2;
+    }
+
+    printf("%lld cases (", count);
+    for (int i = 0; i < num_classes; ++i) {
+        printf("%s%s", i ? ", " : "", classes[i].name);
+    }
+    printf("), seed %llu\n", (unsigned long long) seed);
+    if (racket) {
+        printf("%d cases written to %s\n", racket_cases, racket_path);
+    }
+
+    long long total = 0;
+    for (int i = 0; i < num_mismatches; ++i) {
+        Mismatch *m = &mismatches[i];
+        printf("%-10s %-12s %lld\n", m->check, m->kind, m->count);
+        for (int j = 0; j < m->num_shown; ++j) {
+            printf("    %s\n", m->shown[j]);
+            dio_free(m->shown[j]);
+        }
+        free(m->shown);
+        total += m->count;
+    }
+    printf("%s: %lld mismatches\n", total ? "FAIL" : "OK", total);
+    return total ? 1 : 0;
+}
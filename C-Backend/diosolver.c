@@ -0,0 +1,5 @@
+#include "diosolver.h"
+
+const char *diosolver_version() {
+    return DIOSOLVER_VERSION;
+}
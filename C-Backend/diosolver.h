@@ -0,0 +1,52 @@
+/**
+ * "diosolver.h" is the public interface of the DioSolver library
+ * (libdiosolver.a and libdiosolver.so). Programs linking against the library
+ * should include this header only.
+ */
+
+#ifndef DIOSOLVER_H
+#define DIOSOLVER_H
+
+// Version of the library; the major version changes on incompatible changes
+#define DIOSOLVER_VERSION_MAJOR 1
+#define DIOSOLVER_VERSION_MINOR 2
+#define DIOSOLVER_VERSION_PATCH 0
+#define DIOSOLVER_VERSION "1.2.0"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "betterc.h"
+#include "memstat.h"
+#include "stats.h"
+#include "trace.h"
+#include "latency.h"
+#include "list.h"
+#include "eea.h"
+#include "intvl.h"
+#include "ineq.h"
+#include "lde.h"
+#include "cache.h"
+#include "jsonl.h"
+#include "proto.h"
+#include "shmring.h"
+#include "corpus.h"
+#include "optim.h"
+#include "nearest.h"
+#include "sample.h"
+#include "frob.h"
+
+/**
+ * Produces the version of the library at run time, which may differ from
+ * DIOSOLVER_VERSION if the shared library was replaced.
+ * 
+ * @return The version string, such as "1.2.0".
+ */
+const char *diosolver_version();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
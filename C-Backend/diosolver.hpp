@@ -0,0 +1,363 @@
+/**
+ * "diosolver.hpp" is a header-only C++20 layer over the C API. It owns the
+ * memory returned by the C functions, so that C++ front ends can neither
+ * leak it nor need to copy it:
+ *   EEATable    Move-only owner of eea_table(), viewed as a span of rows
+ *   CString     Move-only owner of a string such as soln_set_to_str()
+ *   Result      Move-only owner of lde_result(), viewed as string_views
+ *   steps()     lde_steps() with any callable that takes a string_view
+ *   Solutions   Range over the solutions of a SolnSet
+ */
+
+#ifndef DIOSOLVER_HPP
+#define DIOSOLVER_HPP
+
+#include "lde.h"
+#include "memstat.h"
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace dio {
+
+/**
+ * Owns the EEA table of two integers.
+ */
+class EEATable {
+public:
+    /**
+     * Generates the EEA table of a and b by eea_table().
+     */
+    EEATable(int a, int b) : table(eea_table(a, b)) {}
+
+    EEATable(EEATable &&other) noexcept
+        : table(std::exchange(other.table, List{nullptr, 0})) {}
+
+    EEATable &operator=(EEATable &&other) noexcept {
+        std::swap(table, other.table);
+        return *this;
+    }
+
+    EEATable(const EEATable&) = delete;
+    EEATable &operator=(const EEATable&) = delete;
+
+    ~EEATable() {
+        dio_free(table.arr);
+    }
+
+    /**
+     * Views the rows of the table, which are valid while the table lives.
+     */
+    std::span<const EEAR> rows() const {
+        return {static_cast<const EEAR*>(table.arr), size()};
+    }
+
+    std::size_t size() const {
+        return table.size;
+    }
+
+    const EEAR &operator[](std::size_t i) const {
+        return rows()[i];
+    }
+
+    auto begin() const {
+        return rows().begin();
+    }
+
+    auto end() const {
+        return rows().end();
+    }
+
+    /**
+     * Produces the GCD of a and b, as eea_gcd_table() does.
+     */
+    int gcd() const {
+        return eea_gcd_table(table);
+    }
+
+    /**
+     * Gets the table for the C functions, such as lde_steps_table().
+     */
+    const EEA_Table &get() const {
+        return table;
+    }
+
+private:
+    EEA_Table table;
+};
+
+/**
+ * Owns a string allocated by the C backend.
+ */
+class CString {
+public:
+    explicit CString(char *str = nullptr) noexcept : str(str) {}
+
+    CString(CString &&other) noexcept : str(std::exchange(other.str, nullptr)) {}
+
+    CString &operator=(CString &&other) noexcept {
+        std::swap(str, other.str);
+        return *this;
+    }
+
+    CString(const CString&) = delete;
+    CString &operator=(const CString&) = delete;
+
+    ~CString() {
+        dio_free(str);
+    }
+
+    /**
+     * Views the string, which is valid while this object lives.
+     */
+    std::string_view view() const {
+        return str ? std::string_view(str) : std::string_view();
+    }
+
+    operator std::string_view() const {
+        return view();
+    }
+
+private:
+    char *str;
+};
+
+/**
+ * Converts a solution set to a string by soln_set_to_str().
+ */
+inline CString soln_set_str(SolnSet set) {
+    return CString(soln_set_to_str(set));
+}
+
+/**
+ * Owns the lines of lde_result().
+ */
+class Result {
+public:
+    /**
+     * Iterates over the lines as string_views.
+     */
+    class iterator {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(char *const *line) : line(line) {}
+
+        std::string_view operator*() const {
+            return *line;
+        }
+
+        iterator &operator++() {
+            ++line;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++line;
+            return old;
+        }
+
+        bool operator==(const iterator&) const = default;
+
+    private:
+        char *const *line = nullptr;
+    };
+
+    /**
+     * Solves an LDE by lde_result().
+     */
+    explicit Result(LDE lde) : result(lde_result(lde)) {}
+
+    Result(Result &&other) noexcept
+        : result(std::exchange(other.result, List{nullptr, 0})) {}
+
+    Result &operator=(Result &&other) noexcept {
+        std::swap(result, other.result);
+        return *this;
+    }
+
+    Result(const Result&) = delete;
+    Result &operator=(const Result&) = delete;
+
+    ~Result() {
+        if (result.arr) {
+            lde_result_free(result);
+        }
+    }
+
+    std::size_t size() const {
+        return result.size;
+    }
+
+    std::string_view operator[](std::size_t i) const {
+        return lines()[i];
+    }
+
+    iterator begin() const {
+        return iterator(lines().data());
+    }
+
+    iterator end() const {
+        return iterator(lines().data() + size());
+    }
+
+private:
+    List result;
+
+    std::span<char *const> lines() const {
+        return {static_cast<char *const*>(result.arr), size()};
+    }
+};
+
+/**
+ * Calls a sink with each line of the steps, and frees the line after.
+ */
+template <class Sink>
+bool call_sink(char *line, void *ctx) {
+    CString owned(line);
+    return (*static_cast<Sink*>(ctx))(owned.view());
+}
+
+/**
+ * Produces the steps of an LDE by lde_steps(), passing each line to a sink
+ * as soon as it is ready. The sink must not throw, since the steps are
+ * produced by C code.
+ *
+ * @param lde The LDE to be solved.
+ * @param sink Called as sink(std::string_view line), where line is valid
+ *             during the call only; returns false to cancel the steps.
+ * @return true if all steps were produced, false if the sink cancelled.
+ */
+template <class Sink>
+bool steps(LDE lde, Sink &&sink) {
+    using Type = std::remove_reference_t<Sink>;
+    return lde_steps(lde, call_sink<Type>,
+                     const_cast<void*>(static_cast<const void*>(
+                         std::addressof(sink))));
+}
+
+/**
+ * Same as steps(), but reuses the EEA table of a and b, as
+ * lde_steps_table() does.
+ */
+template <class Sink>
+bool steps(LDE lde, const EEATable &table, Sink &&sink) {
+    using Type = std::remove_reference_t<Sink>;
+    return lde_steps_table(lde, table.get(), call_sink<Type>,
+                           const_cast<void*>(static_cast<const void*>(
+                               std::addressof(sink))));
+}
+
+/**
+ * A solution for the parameter n, in 64 bits since x and y may exceed the
+ * range of int.
+ */
+struct SolnPoint {
+    long long n;
+    long long x;
+    long long y;
+
+    bool operator==(const SolnPoint&) const = default;
+};
+
+/**
+ * Views the solutions of a SolnSet in increasing order of n. An unbounded
+ * n stops at the end of the range of int, as in the n-interval itself.
+ * A set without solutions, or whose solutions form a plane, is empty.
+ */
+class Solutions {
+public:
+    /**
+     * Iterates over the solutions as SolnPoints.
+     */
+    class iterator {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = SolnPoint;
+        using difference_type = long long;
+
+        iterator() = default;
+        iterator(const Solutions *solutions, long long n)
+            : solutions(solutions), n(n) {}
+
+        SolnPoint operator*() const {
+            return solutions->at(n);
+        }
+
+        iterator &operator++() {
+            ++n;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++n;
+            return old;
+        }
+
+        bool operator==(const iterator &other) const {
+            return n == other.n;
+        }
+
+    private:
+        const Solutions *solutions = nullptr;
+        long long n = 0;
+    };
+
+    explicit Solutions(SolnSet set) : set(set) {
+        if (set.exist && !set.plane) {
+            low = set.n_intvl.low;
+            high = set.n_intvl.high;
+        }
+    }
+
+    /**
+     * Produces the solution for a parameter n, which need not be within
+     * the n-interval.
+     */
+    SolnPoint at(long long n) const {
+        return {n, set.x0 + static_cast<long long>(set.dx) * n,
+                set.y0 + static_cast<long long>(set.dy) * n};
+    }
+
+    long long size() const {
+        return high - low + 1;
+    }
+
+    bool empty() const {
+        return high < low;
+    }
+
+    /**
+     * Checks if n is unbounded, so that the view is cut off.
+     */
+    bool infinite() const {
+        return !empty() && (low == NEG_INF || high == POS_INF);
+    }
+
+    iterator begin() const {
+        return iterator(this, low);
+    }
+
+    iterator end() const {
+        return iterator(this, high + 1);
+    }
+
+private:
+    SolnSet set;
+    long long low = 0;
+    long long high = -1;
+};
+
+}
+
+#endif
@@ -1,11 +1,16 @@
 #include "eea.h"
 #include "betterc.h"
+#include "stats.h"
+#include "trace.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
 
+// Division steps run by the EEA on this thread
+_Thread_local unsigned thread_steps;
+
 EEAR make_eear(int x, int y, int r, int q) {
     return (EEAR) {x, y, r, q};
 }
@@ -18,6 +23,8 @@ bool equal_eear(EEAR r1, EEAR r2) {
 }
 
 EEA_Table eea_table(int a, int b) {
+    STAT_ENTER(STAT_EEA);
+    TRACE_BEGIN("eea");
     EEAR r1 = make_eear(1, 0, fmax(abs(a), abs(b)), 0);
     EEAR r2 = make_eear(0, 1, fmin(abs(a), abs(b)), 0);
 
@@ -36,6 +43,10 @@ EEA_Table eea_table(int a, int b) {
         list_append(table, r2, EEAR);
     }
 
+    thread_steps += table.size - 2;
+    STAT_COUNT(STAT_EEA_STEPS, table.size - 2);
+    TRACE_END();
+    STAT_LEAVE();
     return table;
 }
 
@@ -54,8 +65,11 @@ bool equal_eea_table(EEA_Table t1, EEA_Table t2) {
 }
 
 EEAR eea_2nd_last_row(int a, int b) {
+    STAT_ENTER(STAT_EEA);
+    TRACE_BEGIN("eea");
     EEAR r1 = make_eear(1, 0, fmax(abs(a), abs(b)), 0);
     EEAR r2 = make_eear(0, 1, fmin(abs(a), abs(b)), 0);
+    int steps = 0;
 
     while (r2.r != 0) {
         int q = r1.r / r2.r;
@@ -65,11 +79,21 @@ EEAR eea_2nd_last_row(int a, int b) {
 
         r1 = r2;
         r2 = make_eear(x, y, r, q);
+        ++steps;
     }
 
+    thread_steps += steps;
+    STAT_COUNT(STAT_EEA_STEPS, steps);
+
+    TRACE_END();
+    STAT_LEAVE();
     return r1;
 }
 
+unsigned eea_thread_steps() {
+    return thread_steps;
+}
+
 int eea_gcd(int a, int b) {
     return eea_gcd_row(eea_2nd_last_row(a, b));
 }
@@ -196,8 +220,23 @@ void test_eea_gcd() {
     assert(eea_gcd_row(make_eear(52, 267, 3, 1)) == 3);
 }
 
+void test_eea_thread_steps() {
+    unsigned start = eea_thread_steps();
+    eea_2nd_last_row(1386, 322);
+    assert(eea_thread_steps() - start == 4);
+
+    EEA_Table table = eea_table(-2172, 423);
+    assert(table.size == 8);
+    assert(eea_thread_steps() - start == 4 + 6);
+    list_free(table);
+
+    eea_2nd_last_row(0, 5);
+    assert(eea_thread_steps() - start == 4 + 6);
+}
+
 void test_eea_h() {
     test_eea_table();
     test_eea_2nd_last_row();
     test_eea_gcd();
+    test_eea_thread_steps();
 }
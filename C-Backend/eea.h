@@ -93,6 +93,15 @@ int eea_gcd_table(EEA_Table table);
  */
 int eea_gcd_row(EEAR row);
 
+/**
+ * Counts the division steps run by eea_table() and eea_2nd_last_row() on
+ * the calling thread. The count wraps around, so callers use the difference
+ * between two readings.
+ *
+ * @return The number of steps run by the calling thread so far.
+ */
+unsigned eea_thread_steps();
+
 /**
  * Runs unit tests for functions in "eea.h".
  */
@@ -0,0 +1,254 @@
+/**
+ * "eea.hpp" mirrors eea_table(), eea_2nd_last_row(), eea_lde_row() and
+ * prepare_lde() as constexpr functions, for C++ callers whose a and b are
+ * compile-time constants.
+ *
+ * ConstLDE<a, b> runs the EEA during compilation, so that solving for a c
+ * known only at run time goes straight to prepared_soln_set() without
+ * running the EEA. Results are the same as those of the C functions.
+ */
+
+#ifndef EEA_HPP
+#define EEA_HPP
+
+#include "lde.h"
+
+#include <array>
+#include <climits>
+
+namespace dio {
+
+/**
+ * Produces the absolute value of an integer, since std::abs() is not
+ * constexpr before C++23.
+ */
+constexpr int const_abs(int n) {
+    return (n < 0) ? -n : n;
+}
+
+/**
+ * Produces the first row of the EEA table of two integers.
+ */
+constexpr EEAR const_first_row(int a, int b) {
+    int abs_a = const_abs(a);
+    int abs_b = const_abs(b);
+    return EEAR{1, 0, (abs_a > abs_b) ? abs_a : abs_b, 0};
+}
+
+/**
+ * Produces the second row of the EEA table of two integers.
+ */
+constexpr EEAR const_second_row(int a, int b) {
+    int abs_a = const_abs(a);
+    int abs_b = const_abs(b);
+    return EEAR{0, 1, (abs_a < abs_b) ? abs_a : abs_b, 0};
+}
+
+/**
+ * Produces the row that follows r2 in the EEA table.
+ *
+ * @param r1 The row before r2.
+ * @param r2 A row with a nonzero remainder.
+ * @return The next row.
+ */
+constexpr EEAR const_next_row(EEAR r1, EEAR r2) {
+    int q = r1.r / r2.r;
+    return EEAR{r1.x - r2.x * q, r1.y - r2.y * q, r1.r % r2.r, q};
+}
+
+/**
+ * Counts the rows of the EEA table of two integers.
+ *
+ * @param a The first integer.
+ * @param b The second integer.
+ * @return The size of eea_table(a, b).
+ */
+constexpr int const_eea_table_size(int a, int b) {
+    EEAR r1 = const_first_row(a, b);
+    EEAR r2 = const_second_row(a, b);
+    int size = 2;
+    while (r2.r != 0) {
+        EEAR r = const_next_row(r1, r2);
+        r1 = r2;
+        r2 = r;
+        ++size;
+    }
+    return size;
+}
+
+/**
+ * Generates the EEA table of two integers at compile time.
+ *
+ * @tparam A The first integer.
+ * @tparam B The second integer.
+ * @return The rows of eea_table(A, B).
+ */
+template <int A, int B>
+constexpr std::array<EEAR, const_eea_table_size(A, B)> const_eea_table() {
+    std::array<EEAR, const_eea_table_size(A, B)> table{};
+    table[0] = const_first_row(A, B);
+    table[1] = const_second_row(A, B);
+    for (size_t i = 2; i < table.size(); ++i) {
+        table[i] = const_next_row(table[i - 2], table[i - 1]);
+    }
+    return table;
+}
+
+/**
+ * Returns the second last row from the EEA table of two integers.
+ *
+ * @param a The first integer.
+ * @param b The second integer.
+ * @return The same row as eea_2nd_last_row(a, b).
+ */
+constexpr EEAR const_2nd_last_row(int a, int b) {
+    EEAR r1 = const_first_row(a, b);
+    EEAR r2 = const_second_row(a, b);
+    while (r2.r != 0) {
+        EEAR r = const_next_row(r1, r2);
+        r1 = r2;
+        r2 = r;
+    }
+    return r1;
+}
+
+/**
+ * Produces the GCD of two integers by the EEA.
+ *
+ * @param a The first integer.
+ * @param b The second integer.
+ * @return The same GCD as eea_gcd(a, b).
+ */
+constexpr int const_gcd(int a, int b) {
+    return const_2nd_last_row(a, b).r;
+}
+
+/**
+ * Produces a particular solution of ax + by = c from a solution (x1, y1) of
+ * ax + by = d, as scale_unit_soln() does.
+ *
+ * @param a The coefficient of x, which must not be 0.
+ * @param b The coefficient of y, which must not be 0.
+ * @param c The constant term, a multiple of d.
+ * @param d The GCD of a and b.
+ * @param x1 The x value of the solution of ax + by = d.
+ * @param y1 The y value of the solution of ax + by = d.
+ * @return The same solution as scale_unit_soln().
+ */
+constexpr Solution const_scale_unit_soln(int a, int b, int c, int d,
+                                         int x1, int y1) {
+    long long factor = c / d;
+    long long x = x1 * factor;
+    long long y = y1 * factor;
+    if (x < INT_MIN || x > INT_MAX || y < INT_MIN || y > INT_MAX) {
+        long long m = (b / d < 0) ? -(long long) (b / d) : b / d;
+        x %= m;
+        if (x > m / 2) {
+            x -= m;
+        } else if (x < -(m / 2)) {
+            x += m;
+        }
+        y = ((long long) c - (long long) a * x) / b;
+    }
+    return Solution{(int) x, (int) y, true};
+}
+
+/**
+ * Finds a particular solution of ax + by = c from the second last row of
+ * the EEA table of a and b, as eea_lde_row() does.
+ *
+ * @param a The coefficient of x, which must not be 0.
+ * @param b The coefficient of y, which must not be 0.
+ * @param c The constant term.
+ * @param row The second last row of the EEA table of a and b.
+ * @return The same solution as eea_lde_row().
+ */
+constexpr Solution const_lde_row(int a, int b, int c, EEAR row) {
+    int gcd_ab = row.r;
+    if (c % gcd_ab != 0) {
+        return Solution{0, 0, false};
+    }
+
+    int x1 = (const_abs(a) > const_abs(b)) ? row.x : row.y;
+    int y1 = (const_abs(a) > const_abs(b)) ? row.y : row.x;
+    return const_scale_unit_soln(a, b, c, gcd_ab, (a < 0) ? -x1 : x1,
+                                 (b < 0) ? -y1 : y1);
+}
+
+/**
+ * Runs the EEA on a and b, as prepare_lde() does.
+ *
+ * @param a The coefficient of x.
+ * @param b The coefficient of y.
+ * @return The same prepared LDE as prepare_lde(a, b).
+ */
+constexpr PreparedLDE const_prepare_lde(int a, int b) {
+    PreparedLDE prep{a, b, 0, 0, 0, 0, 0};
+    if (a == 0 && b == 0) {
+        return prep;
+    }
+
+    if (a == 0) {
+        prep.d = const_abs(b);
+        prep.dx = 1;
+    } else if (b == 0) {
+        prep.d = const_abs(a);
+        prep.dy = 1;
+    } else {
+        EEAR row = const_2nd_last_row(a, b);
+        prep.d = row.r;
+        Solution unit_soln = const_lde_row(a, b, prep.d, row);
+        prep.x1 = unit_soln.x;
+        prep.y1 = unit_soln.y;
+        prep.dx = b / prep.d;
+        prep.dy = -a / prep.d;
+    }
+    return prep;
+}
+
+/**
+ * An LDE whose coefficients a and b are compile-time constants. The EEA
+ * table, the GCD, the solution of ax + by = gcd(a, b) and the coefficients
+ * of n are all computed at compile time.
+ *
+ * @tparam A The coefficient of x.
+ * @tparam B The coefficient of y.
+ */
+template <int A, int B>
+struct ConstLDE {
+    // Rows of eea_table(A, B)
+    static constexpr auto table = const_eea_table<A, B>();
+
+    // The same as prepare_lde(A, B)
+    static constexpr PreparedLDE prep = const_prepare_lde(A, B);
+
+    /**
+     * Finds a particular solution of Ax + By = c, as eea_lde() does.
+     * A and B must not be 0.
+     *
+     * @param c The constant term.
+     * @return The particular solution, with "exist" set to false if
+     *         there is none.
+     */
+    static constexpr Solution particular(int c) {
+        static_assert(A != 0 && B != 0, "a and b must not be 0");
+        return const_lde_row(A, B, c, table[table.size() - 2]);
+    }
+
+    /**
+     * Produces the complete solution set of Ax + By = c by
+     * prepared_soln_set() on the prepared LDE built at compile time.
+     *
+     * @param c The constant term.
+     * @param xi The domain of x.
+     * @param yi The domain of y.
+     * @return The same solution set as lde_soln_set().
+     */
+    static SolnSet soln_set(int c, Interval xi, Interval yi) {
+        return prepared_soln_set(&prep, c, xi, yi);
+    }
+};
+
+}
+
+#endif
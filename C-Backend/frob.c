@@ -0,0 +1,267 @@
+#include "frob.h"
+#include "eea.h"
+#include "lde.h"
+#include "memstat.h"
+#include "sample.h"
+
+#include <assert.h>
+#include <limits.h>
+
+// Marks a residue class without a representable value yet
+#define UNREACHED LLONG_MAX
+
+/**
+ * Adds a reduced coefficient to a residue table by the round-robin
+ * algorithm. Each cycle of residues r, r + a, r + 2a, ... modulo m is
+ * walked once from its smallest entry, so that an entry is lowered to the
+ * entry before it plus a whenever that is smaller.
+ *
+ * @param residues The residue table modulo m.
+ * @param m The modulus.
+ * @param a The reduced coefficient to add.
+ */
+void frob_add_coeff(long long *residues, int m, int a) {
+    int d = eea_gcd(m, a);
+    int step = a % m;
+    for (int p = 0; p < d; ++p) {
+        // Start from the smallest entry of the cycle through p
+        int start = p;
+        for (int r = p + d; r < m; r += d) {
+            if (residues[r] < residues[start]) {
+                start = r;
+            }
+        }
+        if (residues[start] == UNREACHED) {
+            continue;
+        }
+
+        long long value = residues[start];
+        int r = start;
+        for (int j = 1; j < m / d; ++j) {
+            r += step;
+            if (r >= m) {
+                r -= m;
+            }
+            value += a;
+            if (residues[r] < value) {
+                value = residues[r];
+            } else {
+                residues[r] = value;
+            }
+        }
+    }
+}
+
+/**
+ * Counts the solutions for every reduced c up to a limit by dynamic
+ * programming over the coefficients, saturating at UINT64_MAX.
+ *
+ * @param counts Receives the counts, with room for limit + 1 entries.
+ * @param coeffs The coefficients.
+ * @param n Number of coefficients.
+ * @param gcd GCD of the coefficients.
+ * @param limit Largest reduced c.
+ */
+void frob_fill_counts(uint64_t *counts, const int *coeffs, int n, int gcd,
+                      int limit) {
+    counts[0] = 1;
+    for (int i = 0; i < n; ++i) {
+        int a = coeffs[i] / gcd;
+        for (int v = a; v <= limit; ++v) {
+            uint64_t sum = counts[v] + counts[v - a];
+            counts[v] = (sum < counts[v]) ? UINT64_MAX : sum;
+        }
+    }
+}
+
+Frob frob_build(const int *coeffs, int n, int max_c) {
+    Frob frob = {0, 0, NULL, NULL, -1, false};
+    if (n <= 0) {
+        return frob;
+    }
+
+    int smallest = coeffs[0];
+    for (int i = 0; i < n; ++i) {
+        if (coeffs[i] <= 0) {
+            return frob;
+        }
+        frob.gcd = eea_gcd(frob.gcd, coeffs[i]);
+        if (coeffs[i] < smallest) {
+            smallest = coeffs[i];
+        }
+    }
+
+    int m = smallest / frob.gcd;
+    frob.modulus = m;
+    frob.residues = dio_malloc(m * sizeof(long long));
+    if (!frob.residues) {
+        return frob;
+    }
+    frob.residues[0] = 0;
+    for (int r = 1; r < m; ++r) {
+        frob.residues[r] = UNREACHED;
+    }
+    for (int i = 0; i < n; ++i) {
+        frob_add_coeff(frob.residues, m, coeffs[i] / frob.gcd);
+    }
+
+    if (max_c >= 0) {
+        int limit = max_c / frob.gcd;
+        frob.counts = dio_calloc(limit + 1, sizeof(uint64_t));
+        if (!frob.counts) {
+            frob_free(&frob);
+            return frob;
+        }
+        frob_fill_counts(frob.counts, coeffs, n, frob.gcd, limit);
+        frob.max_c = max_c;
+    }
+
+    frob.valid = true;
+    return frob;
+}
+
+void frob_free(Frob *frob) {
+    dio_free(frob->residues);
+    dio_free(frob->counts);
+    frob->residues = NULL;
+    frob->counts = NULL;
+    frob->max_c = -1;
+    frob->valid = false;
+}
+
+bool frob_representable(const Frob *frob, long long c) {
+    if (c < 0 || c % frob->gcd != 0) {
+        return false;
+    }
+    long long v = c / frob->gcd;
+    return v >= frob->residues[v % frob->modulus];
+}
+
+bool frob_number(const Frob *frob, long long *number) {
+    if (frob->gcd != 1) {
+        return false;
+    }
+
+    // Every class is reached when the GCD is 1, and the largest gap lies
+    // just below the largest entry
+    long long largest = 0;
+    for (int r = 0; r < frob->modulus; ++r) {
+        if (frob->residues[r] > largest) {
+            largest = frob->residues[r];
+        }
+    }
+    *number = largest - frob->modulus;
+    return true;
+}
+
+bool frob_count(const Frob *frob, long long c, uint64_t *count) {
+    if (c > frob->max_c) {
+        return false;
+    }
+    *count = (c < 0 || c % frob->gcd != 0) ? 0 : frob->counts[c / frob->gcd];
+    return true;
+}
+
+void test_frob_build() {
+    int coeffs[] = {6, 9, 20};
+    Frob frob = frob_build(coeffs, 3, -1);
+    assert(frob.valid && frob.gcd == 1 && frob.modulus == 6);
+    assert(frob.residues[0] == 0 && frob.residues[5] == 29);
+    uint64_t count;
+    assert(!frob_count(&frob, 0, &count));
+    frob_free(&frob);
+    assert(!frob.valid && !frob.residues);
+
+    int zero[] = {3, 0};
+    int negative[] = {-3, 5};
+    assert(!frob_build(zero, 2, 10).valid);
+    assert(!frob_build(negative, 2, 10).valid);
+    assert(!frob_build(coeffs, 0, 10).valid);
+}
+
+void test_frob_queries() {
+    // The largest number of McNuggets that cannot be bought is 43
+    int coeffs[] = {20, 9, 6};
+    Frob frob = frob_build(coeffs, 3, 200);
+    long long number;
+    assert(frob_number(&frob, &number) && number == 43);
+    assert(!frob_representable(&frob, 43));
+    assert(frob_representable(&frob, 44));
+    assert(frob_representable(&frob, 0));
+    assert(!frob_representable(&frob, -6));
+
+    // Representability agrees with a brute-force count
+    for (int c = -5; c <= 200; ++c) {
+        uint64_t expected = 0;
+        for (int x = 0; 20 * x <= c; ++x) {
+            for (int y = 0; 20 * x + 9 * y <= c; ++y) {
+                expected += (c - 20 * x - 9 * y) % 6 == 0;
+            }
+        }
+        uint64_t count;
+        assert(frob_count(&frob, c, &count) && count == expected);
+        assert(frob_representable(&frob, c) == (count > 0));
+    }
+    uint64_t count;
+    assert(!frob_count(&frob, 201, &count));
+    frob_free(&frob);
+
+    // Without a GCD of 1, only multiples of the GCD are representable
+    int even[] = {4, 6};
+    frob = frob_build(even, 2, 20);
+    assert(!frob_number(&frob, &number));
+    assert(frob_representable(&frob, 10) && !frob_representable(&frob, 7));
+    assert(!frob_representable(&frob, 2));
+    assert(frob_count(&frob, 12, &count) && count == 2);
+    assert(frob_count(&frob, 13, &count) && count == 0);
+    frob_free(&frob);
+
+    int one[] = {1};
+    frob = frob_build(one, 1, -1);
+    assert(frob_number(&frob, &number) && number == -1);
+    frob_free(&frob);
+
+    // Counts too large for 64 bits saturate
+    int ones[40];
+    for (int i = 0; i < 40; ++i) {
+        ones[i] = 1;
+    }
+    frob = frob_build(ones, 40, 1000);
+    assert(frob_count(&frob, 1, &count) && count == 40);
+    assert(frob_count(&frob, 1000, &count) && count == UINT64_MAX);
+    frob_free(&frob);
+}
+
+void test_frob_two_coeffs() {
+    // With two coefficients, the Frobenius number is ab - a - b, and the
+    // counts agree with the solution sets of the LDE
+    Interval nonneg = make_interval(0, POS_INF, false, true);
+    for (int a = 1; a <= 15; ++a) {
+        for (int b = 1; b <= 15; ++b) {
+            int coeffs[] = {a, b};
+            Frob frob = frob_build(coeffs, 2, 120);
+            long long number;
+            if (eea_gcd(a, b) == 1) {
+                assert(frob_number(&frob, &number));
+                assert(number == (long long) a * b - a - b);
+            } else {
+                assert(!frob_number(&frob, &number));
+            }
+
+            for (int c = 0; c <= 120; ++c) {
+                SolnSet set = lde_soln_set(make_lde_in(a, b, c, nonneg, nonneg));
+                uint64_t count;
+                assert(frob_count(&frob, c, &count));
+                assert(count == soln_set_count(set, nonneg, nonneg));
+                assert(frob_representable(&frob, c) == set.exist);
+            }
+            frob_free(&frob);
+        }
+    }
+}
+
+void test_frob_h() {
+    test_frob_build();
+    test_frob_queries();
+    test_frob_two_coeffs();
+}
@@ -0,0 +1,98 @@
+/**
+ * "frob.h" answers queries about a1 * x1 + ... + an * xn = c with positive
+ * coefficients and nonnegative unknowns, for many c:
+ *   Representability   Whether the equation has a solution
+ *   Frobenius number   The largest c without a solution
+ *   Count              The number of solutions
+ *
+ * The coefficients are divided by their GCD, found by eea_gcd(), so that
+ * c is representable only if it is a multiple of the GCD. For the smallest
+ * reduced coefficient m, a residue table holds the smallest representable
+ * value in each residue class modulo m. It is built by the round-robin
+ * algorithm of Böcker and Lipták in O(n * m) time, after which a value is
+ * representable if and only if it is at least the entry of its class.
+ */
+
+#ifndef FROB_H
+#define FROB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Holds the residue table and the count table of a set of coefficients.
+ */
+typedef struct Frob {
+    int gcd;                // GCD of the coefficients
+    int modulus;            // Smallest coefficient divided by gcd
+    long long *residues;    // Smallest representable value / gcd in each
+                            // residue class modulo "modulus"
+    uint64_t *counts;       // Number of solutions for c = gcd * i
+    int max_c;              // Largest c covered by "counts", or -1
+
+    bool valid;             // True if the tables are built
+} Frob;
+
+/**
+ * Builds the tables of a set of coefficients.
+ *
+ * @param coeffs The coefficients, which must all be positive.
+ * @param n Number of coefficients, which must be positive.
+ * @param max_c Largest c for count queries, or -1 to skip the count table.
+ *              The count table takes O(n * max_c) time.
+ * @return The tables, with "valid" set to false if a coefficient is not
+ *         positive or memory runs out. Make sure to call frob_free().
+ */
+Frob frob_build(const int *coeffs, int n, int max_c);
+
+/**
+ * Frees the tables of a set of coefficients.
+ *
+ * @param frob The tables to free.
+ */
+void frob_free(Frob *frob);
+
+/**
+ * Checks in constant time if a1 * x1 + ... + an * xn = c has a solution.
+ *
+ * @param frob The tables of a1, ..., an.
+ * @param c The constant term.
+ * @return true if c is representable, false otherwise.
+ */
+bool frob_representable(const Frob *frob, long long c);
+
+/**
+ * Finds the Frobenius number, the largest c that is not representable.
+ *
+ * @param frob The tables of a1, ..., an.
+ * @param number Receives the Frobenius number, -1 if every c ≥ 0 is
+ *               representable.
+ * @return false if the GCD is not 1, so that no such number exists.
+ */
+bool frob_number(const Frob *frob, long long *number);
+
+/**
+ * Counts the solutions of a1 * x1 + ... + an * xn = c in constant time.
+ *
+ * @param frob The tables of a1, ..., an.
+ * @param c The constant term.
+ * @param count Receives the number of solutions, or UINT64_MAX if it does
+ *              not fit in 64 bits.
+ * @return false if c exceeds the "max_c" of the count table.
+ */
+bool frob_count(const Frob *frob, long long c, uint64_t *count);
+
+/**
+ * Runs unit tests for functions in "frob.h".
+ */
+void test_frob_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
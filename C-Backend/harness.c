@@ -0,0 +1,437 @@
+/**
+ * End-to-end throughput harness for the C backend.
+ *
+ * Usage: harness [--csv | --json] [--count N] [--reps R] [--seed S]
+ *                [--corpus FILE]
+ *
+ * N LDEs are generated for each input class of "corpus.h" from seed S, or
+ * loaded from a corpus file written by "corpusgen" (--count and --seed are
+ * then ignored), and run through each phase of the solve:
+ *   eea         eea_table() of a and b
+ *   particular  eea_lde_row() with the second last row of the table
+ *   ineq        int_interval(solve_ineq_sys(...)) for the n-interval
+ *   full        lde_result(), including rendering and freeing every line
+ *   render      full minus the three phases above (derived)
+ *
+ * Wall time and heap allocations are always recorded. Instructions, cycles,
+ * branch misses and cache misses are read through perf_event_open() on
+ * Linux, and reported as unavailable if the kernel refuses access
+ * (see /proc/sys/kernel/perf_event_paranoid).
+ */
+
+#include "betterc.h"
+#include "eea.h"
+#include "intvl.h"
+#include "ineq.h"
+#include "lde.h"
+#include "corpus.h"
+#include "benchutil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+/**
+ * Hardware counters recorded for each phase.
+ */
+typedef enum Counter {
+    INSTRUCTIONS,
+    CYCLES,
+    BRANCH_MISSES,
+    CACHE_MISSES,
+    NUM_COUNTERS,
+} Counter;
+
+const char *counter_names[NUM_COUNTERS] = {
+    "instructions", "cycles", "branch_misses", "cache_misses"
+};
+
+/**
+ * A group of hardware counters that are started and stopped together.
+ */
+typedef struct PerfGroup {
+    int leader;                 // File descriptor of the group leader
+    int index[NUM_COUNTERS];    // Position in the group, or -1 if unavailable
+    int size;                   // Number of counters in the group
+} PerfGroup;
+
+PerfGroup perf_open() {
+    PerfGroup group = {-1, {-1, -1, -1, -1}, 0};
+#ifdef __linux__
+    const uint64_t configs[NUM_COUNTERS] = {
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_MISSES,
+    };
+
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = (group.leader < 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, group.leader, 0);
+        if (fd < 0) {
+            continue;
+        }
+        if (group.leader < 0) {
+            group.leader = fd;
+        }
+        group.index[i] = group.size++;
+    }
+#endif
+    return group;
+}
+
+bool perf_available(const PerfGroup *group) {
+    return group->leader >= 0;
+}
+
+void perf_start(const PerfGroup *group) {
+#ifdef __linux__
+    if (perf_available(group)) {
+        ioctl(group->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(group->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+void perf_stop(const PerfGroup *group, double values[NUM_COUNTERS]) {
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        values[i] = -1;
+    }
+#ifdef __linux__
+    if (!perf_available(group)) {
+        return;
+    }
+    ioctl(group->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // Layout with PERF_FORMAT_GROUP: {nr, values[nr]}
+    uint64_t buf[1 + NUM_COUNTERS];
+    if (read(group->leader, buf, sizeof(buf)) < (ssize_t) sizeof(uint64_t)) {
+        return;
+    }
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        if (group->index[i] >= 0 && (uint64_t) group->index[i] < buf[0]) {
+            values[i] = buf[1 + group->index[i]];
+        }
+    }
+#endif
+}
+
+/**
+ * An LDE with the intermediate results that later phases depend on.
+ */
+typedef struct Work {
+    LDE lde;
+    EEAR row;           // Second last row of the EEA table
+    Solution part_soln; // Particular solution
+    int d;              // GCD of a and b
+} Work;
+
+/**
+ * A phase of the solve, run over every applicable LDE of a class.
+ *
+ * @return The number of LDEs processed.
+ */
+typedef int (*PhaseFn)(const Work *works, int count);
+
+int phase_eea(const Work *works, int count) {
+    int ops = 0;
+    for (int i = 0; i < count; ++i) {
+        const LDE *lde = &works[i].lde;
+        if (lde->a == 0 || lde->b == 0) {
+            continue;
+        }
+        EEA_Table table = eea_table(lde->a, lde->b);
+        bench_sink += table.size;
+        list_free(table);
+        ++ops;
+    }
+    return ops;
+}
+
+int phase_particular(const Work *works, int count) {
+    int ops = 0;
+    for (int i = 0; i < count; ++i) {
+        const LDE *lde = &works[i].lde;
+        if (lde->a == 0 || lde->b == 0) {
+            continue;
+        }
+        bench_sink += eea_lde_row(*lde, works[i].row).x;
+        ++ops;
+    }
+    return ops;
+}
+
+int phase_ineq(const Work *works, int count) {
+    int ops = 0;
+    for (int i = 0; i < count; ++i) {
+        const Work *w = &works[i];
+        if (!w->part_soln.exist) {
+            continue;
+        }
+        Interval n_intvl = int_interval(solve_ineq_sys(
+            w->part_soln.x, w->lde.b / w->d, w->part_soln.y, -w->lde.a / w->d,
+            w->lde.xi, w->lde.yi));
+        bench_sink += n_intvl.valid;
+        ++ops;
+    }
+    return ops;
+}
+
+int phase_full(const Work *works, int count) {
+    for (int i = 0; i < count; ++i) {
+        List result = lde_result(works[i].lde);
+        for (int j = 0; j < result.size; ++j) {
+            dio_free(list_at(result, j, char*));
+        }
+        bench_sink += result.size;
+        list_free(result);
+    }
+    return count;
+}
+
+typedef enum Phase {
+    PHASE_EEA,
+    PHASE_PARTICULAR,
+    PHASE_INEQ,
+    PHASE_FULL,
+    PHASE_RENDER,
+    NUM_PHASES,
+} Phase;
+
+const char *phase_names[NUM_PHASES] = {
+    "eea", "particular", "ineq", "full", "render"
+};
+
+const PhaseFn phase_fns[PHASE_RENDER] = {
+    phase_eea, phase_particular, phase_ineq, phase_full
+};
+
+/**
+ * Totals measured for a phase.
+ */
+typedef struct Measure {
+    double ops;
+    double ns;
+    double allocs;
+    double counters[NUM_COUNTERS];  // Negative if unavailable
+} Measure;
+
+Measure measure_phase(const PerfGroup *group, PhaseFn fn,
+                      const Work *works, int count, int reps) {
+    Measure m = {0};
+    size_t allocs = alloc_count;
+    perf_start(group);
+    double start = now_ns();
+    for (int rep = 0; rep < reps; ++rep) {
+        m.ops += fn(works, count);
+    }
+    m.ns = now_ns() - start;
+    perf_stop(group, m.counters);
+    m.allocs = alloc_count - allocs;
+    return m;
+}
+
+void add_measure(Measure *total, const Measure *m, double sign) {
+    total->ns += sign * m->ns;
+    total->allocs += sign * m->allocs;
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        total->counters[i] = (total->counters[i] < 0 || m->counters[i] < 0)
+                             ? -1 : total->counters[i] + sign * m->counters[i];
+    }
+}
+
+typedef enum Format { TABLE, CSV, JSON } Format;
+
+void print_header(Format format) {
+    if (format == CSV) {
+        printf("class,phase,ops,ns_per_op,allocs_per_op");
+        for (int i = 0; i < NUM_COUNTERS; ++i) {
+            printf(",%s_per_op", counter_names[i]);
+        }
+        printf(",ipc\n");
+    } else if (format == TABLE) {
+        printf("%-13s %-10s %9s %10s %9s %10s %10s %8s %9s %9s\n",
+               "class", "phase", "ops", "ns/op", "allocs/op", "instr/op",
+               "cycles/op", "ipc", "brmiss/op", "cmiss/op");
+    }
+}
+
+void print_cell(Format format, double value, int width, int precision) {
+    if (format == TABLE) {
+        value < 0 ? printf(" %*s", width, "n/a")
+                  : printf(" %*.*f", width, precision, value);
+    } else if (format == CSV) {
+        value < 0 ? printf(",") : printf(",%.3f", value);
+    } else {
+        value < 0 ? printf("null") : printf("%.3f", value);
+    }
+}
+
+void print_measure(Format format, const char *cls, const char *phase,
+                   const Measure *m) {
+    if (m->ops == 0) {
+        return;
+    }
+    double ops = m->ops;
+    double per_op[NUM_COUNTERS];
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        per_op[i] = m->counters[i] < 0 ? -1 : m->counters[i] / ops;
+    }
+    double ipc = (m->counters[INSTRUCTIONS] < 0 || m->counters[CYCLES] <= 0)
+                 ? -1 : m->counters[INSTRUCTIONS] / m->counters[CYCLES];
+
+    if (format == TABLE) {
+        printf("%-13s %-10s %9.0f %10.1f %9.2f", cls, phase, m->ops,
+               m->ns / ops, m->allocs / ops);
+        print_cell(format, per_op[INSTRUCTIONS], 10, 1);
+        print_cell(format, per_op[CYCLES], 10, 1);
+        print_cell(format, ipc, 8, 2);
+        print_cell(format, per_op[BRANCH_MISSES], 9, 1);
+        print_cell(format, per_op[CACHE_MISSES], 9, 1);
+        printf("\n");
+    } else if (format == CSV) {
+        printf("%s,%s,%.0f,%.3f,%.3f", cls, phase, m->ops, m->ns / ops,
+               m->allocs / ops);
+        for (int i = 0; i < NUM_COUNTERS; ++i) {
+            print_cell(format, per_op[i], 0, 0);
+        }
+        print_cell(format, ipc, 0, 0);
+        printf("\n");
+    } else {
+        printf("{\"class\":\"%s\",\"phase\":\"%s\",\"ops\":%.0f,"
+               "\"ns_per_op\":%.3f,\"allocs_per_op\":%.3f",
+               cls, phase, m->ops, m->ns / ops, m->allocs / ops);
+        for (int i = 0; i < NUM_COUNTERS; ++i) {
+            printf(",\"%s_per_op\":", counter_names[i]);
+            print_cell(format, per_op[i], 0, 0);
+        }
+        printf(",\"ipc\":");
+        print_cell(format, ipc, 0, 0);
+        printf("}\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Format format = TABLE;
+    int count = 10000;
+    int reps = 10;
+    uint64_t seed = 135;
+    const char *corpus_path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (equal_str(argv[i], "--csv")) {
+            format = CSV;
+        } else if (equal_str(argv[i], "--json")) {
+            format = JSON;
+        } else if (equal_str(argv[i], "--count") && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else if (equal_str(argv[i], "--reps") && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else if (equal_str(argv[i], "--seed") && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (equal_str(argv[i], "--corpus") && i + 1 < argc) {
+            corpus_path = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--csv | --json] [--count N] "
+                            "[--reps R] [--seed S] [--corpus FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (count <= 0 || reps <= 0) {
+        fprintf(stderr, "--count and --reps must be positive\n");
+        return 1;
+    }
+
+    Corpus corpus;
+    if (corpus_path) {
+        FILE *in = fopen(corpus_path, "rb");
+        if (!in) {
+            perror(corpus_path);
+            return 1;
+        }
+        corpus = corpus_read(in);
+        fclose(in);
+        if (!corpus.valid || corpus.size == 0) {
+            fprintf(stderr, "%s: not a corpus, or empty\n", corpus_path);
+            return 1;
+        }
+    } else {
+        corpus = corpus_generate(count, seed);
+    }
+
+    PerfGroup group = perf_open();
+    if (!perf_available(&group)) {
+        fprintf(stderr, "Hardware counters are unavailable; "
+                        "only wall time and allocations are reported.\n");
+    }
+
+    Work *works = malloc(corpus.size * sizeof(Work));
+    Measure totals[NUM_PHASES];
+    for (int p = 0; p < NUM_PHASES; ++p) {
+        totals[p] = (Measure) {0};
+    }
+
+    print_header(format);
+    for (int k = 0; k < NUM_CORPUS_CLASSES; ++k) {
+        int size = 0;
+        for (int i = 0; i < corpus.size; ++i) {
+            if (corpus.classes[i] != k) {
+                continue;
+            }
+            Work *w = &works[size++];
+            w->lde = corpus.ldes[i];
+            w->row = make_eear(0, 0, 0, 0);
+            w->part_soln = NO_SOLN;
+            w->d = 0;
+            if (w->lde.a != 0 && w->lde.b != 0) {
+                w->row = eea_2nd_last_row(w->lde.a, w->lde.b);
+                w->d = eea_gcd_row(w->row);
+                w->part_soln = eea_lde_row(w->lde, w->row);
+            }
+        }
+        if (size == 0) {
+            continue;
+        }
+
+        Measure measures[NUM_PHASES];
+        for (int p = 0; p < PHASE_RENDER; ++p) {
+            measures[p] = measure_phase(&group, phase_fns[p], works, size, reps);
+        }
+        measures[PHASE_RENDER] = measures[PHASE_FULL];
+        for (int p = 0; p < PHASE_FULL; ++p) {
+            add_measure(&measures[PHASE_RENDER], &measures[p], -1);
+        }
+
+        for (int p = 0; p < NUM_PHASES; ++p) {
+            print_measure(format, corpus_class_name(k), phase_names[p],
+                          &measures[p]);
+            totals[p].ops += measures[p].ops;
+            add_measure(&totals[p], &measures[p], 1);
+        }
+    }
+
+    for (int p = 0; p < NUM_PHASES; ++p) {
+        print_measure(format, "all", phase_names[p], &totals[p]);
+    }
+
+    free(works);
+    corpus_free(&corpus);
+    return 0;
+}
@@ -1,4 +1,6 @@
 #include "ineq.h"
+#include "stats.h"
+#include "trace.h"
 
 #include <assert.h>
 
@@ -36,8 +38,13 @@ Interval solve_ineq_in(int con, int coeff, Interval intvl) {
 
 Interval solve_ineq_sys(int x_con, int x_coeff, int y_con, int y_coeff, 
                         Interval xi, Interval yi) {
-    return intersection(solve_ineq_in(x_con, x_coeff, xi),
-                        solve_ineq_in(y_con, y_coeff, yi));
+    STAT_ENTER(STAT_INEQ);
+    TRACE_BEGIN("ineq");
+    Interval intvl = intersection(solve_ineq_in(x_con, x_coeff, xi),
+                                  solve_ineq_in(y_con, y_coeff, yi));
+    TRACE_END();
+    STAT_LEAVE();
+    return intvl;
 }
 
 void test_solve_ineq() {
@@ -5,6 +5,10 @@
 #ifndef INEQ_H
 #define INEQ_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #include "intvl.h"
 
 /**
@@ -57,4 +61,8 @@ Interval solve_ineq_sys(int x_con, int x_coeff, int y_con, int y_coeff,
  */
 void test_ineq_h();
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
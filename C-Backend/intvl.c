@@ -1,9 +1,15 @@
 #include "intvl.h"
 #include "betterc.h"
+#include "memstat.h"
+#include "stats.h"
+#include "trace.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
 #include <assert.h>
 
 Interval make_interval(double low, double high, bool left_open, bool right_open) {
@@ -32,6 +38,65 @@ char *interval_to_str(Interval intvl) {
                       intvl.high, intvl.right_open ? ')' : ']');
 }
 
+const char *skip_space(const char *str) {
+    while (isspace((unsigned char) *str)) {
+        ++str;
+    }
+    return str;
+}
+
+const char *parse_bound(const char *str, double inf, double *bound) {
+    str = skip_space(str);
+    const char *inf_str = str + (*str == '+' || *str == '-');
+    if (!strncasecmp(inf_str, "inf", 3) && (*str == '-') == (inf < 0)) {
+        *bound = inf;
+        return inf_str + 3;
+    }
+
+    char *end;
+    *bound = strtod(str, &end);
+    return (end == str) ? NULL : end;
+}
+
+Interval str_to_interval(const char *str) {
+    const char *names[] = {
+        "real", "pos", "neg", "nonpos", "nonneg",
+        "positive", "negative", "nonpositive", "nonnegative"
+    };
+    const Interval named[] = {REAL, POS, NEG, NONPOS, NONNEG,
+                              POS, NEG, NONPOS, NONNEG};
+
+    str = skip_space(str);
+    for (int i = 0; i < 9; ++i) {
+        size_t len = strlen(names[i]);
+        if (!strncasecmp(str, names[i], len) && !*skip_space(str + len)) {
+            return named[i];
+        }
+    }
+
+    if (*str != '(' && *str != '[') {
+        return INVALID_INTVL;
+    }
+    bool left_open = (*str == '(');
+
+    double low, high;
+    str = parse_bound(str + 1, NEG_INF, &low);
+    if (!str || *(str = skip_space(str)) != ',') {
+        return INVALID_INTVL;
+    }
+    str = parse_bound(str + 1, POS_INF, &high);
+    if (!str || (*(str = skip_space(str)) != ')' && *str != ']')) {
+        return INVALID_INTVL;
+    }
+    bool right_open = (*str == ')');
+    if (*skip_space(str + 1)) {
+        return INVALID_INTVL;
+    }
+
+    Interval intvl = make_interval(low, high, left_open, right_open);
+    return is_valid_interval(intvl) ? intvl : INVALID_INTVL;
+}
+
 bool is_valid_interval(Interval intvl) {
     return intvl.valid &&
            (intvl.low != NEG_INF || intvl.left_open) &&
@@ -81,6 +146,8 @@ Interval int_interval(Interval intvl) {
         return INVALID_INTVL;
     }
 
+    STAT_ENTER(STAT_INEQ);
+    TRACE_BEGIN("ineq");
     int low;
     if (intvl.left_open && is_int(intvl.low) && intvl.low != NEG_INF) {
         low = intvl.low + 1;
@@ -95,6 +162,8 @@ Interval int_interval(Interval intvl) {
         high = floor(intvl.high);
     }
 
+    TRACE_END();
+    STAT_LEAVE();
     return make_interval(low, high, intvl.low == NEG_INF, intvl.high == POS_INF);
 }
 
@@ -103,47 +172,82 @@ int num_int_in(Interval intvl) {
         return 0;    
     }
     
+    // Saturate at POS_INF, since an unbounded count does not fit in an int
     Interval int_intvl = int_interval(intvl);
-    return int_intvl.high - int_intvl.low + 1;
+    double count = int_intvl.high - int_intvl.low + 1;
+    return (count > POS_INF) ? POS_INF : count;
 }
 
 void test_interval_to_str() {
     char *intvl_str;
     intvl_str = interval_to_str(make_interval(3, 5, true, true));
     assert(equal_str(intvl_str, "(3,5)"));
-    free(intvl_str);
+    dio_free(intvl_str);
 
     intvl_str = interval_to_str(make_interval(-5, 3, false, true));
     assert(equal_str(intvl_str, "[-5,3)"));
-    free(intvl_str);
+    dio_free(intvl_str);
 
     intvl_str = interval_to_str(make_interval(-5, -3, true, false));
     assert(equal_str(intvl_str, "(-5,-3]"));
-    free(intvl_str);
+    dio_free(intvl_str);
 
     intvl_str = interval_to_str(make_interval(0, 0, false, false));
     assert(equal_str(intvl_str, "[0,0]"));
-    free(intvl_str);
+    dio_free(intvl_str);
 
     intvl_str = interval_to_str(make_interval(0, 5, true, true));
     assert(equal_str(intvl_str, "(0,5)"));
-    free(intvl_str);
+    dio_free(intvl_str);
 
     intvl_str = interval_to_str(make_interval(-5.43, 0.012, true, false));
     assert(equal_str(intvl_str, "(-5.43,0.012]"));
-    free(intvl_str);
+    dio_free(intvl_str);
 
     intvl_str = interval_to_str(POS);
     assert(equal_str(intvl_str, "(0,inf)"));
-    free(intvl_str);
+    dio_free(intvl_str);
 
     intvl_str = interval_to_str(NEG);
     assert(equal_str(intvl_str, "(-inf,0)"));
-    free(intvl_str);
+    dio_free(intvl_str);
 
     intvl_str = interval_to_str(REAL);
     assert(equal_str(intvl_str, "(-inf,inf)"));
-    free(intvl_str);
+    dio_free(intvl_str);
+}
+
+void test_str_to_interval() {
+    assert(equal_interval(str_to_interval("(7,9)"),
+                          make_interval(7, 9, true, true)));
+    assert(equal_interval(str_to_interval(" (7, 9]  "),
+                          make_interval(7, 9, true, false)));
+    assert(equal_interval(str_to_interval("[0.07, 90.0)"),
+                          make_interval(0.07, 90, false, true)));
+    assert(equal_interval(str_to_interval(" [-9 , -7]  "),
+                          make_interval(-9, -7, false, false)));
+    assert(equal_interval(str_to_interval("(-inf,5]"),
+                          make_interval(NEG_INF, 5, true, false)));
+    assert(equal_interval(str_to_interval("[-5, +INF)"),
+                          make_interval(-5, POS_INF, false, true)));
+    assert(equal_interval(str_to_interval("(-inf,inf)"), REAL));
+
+    assert(equal_interval(str_to_interval("real"), REAL));
+    assert(equal_interval(str_to_interval(" Pos "), POS));
+    assert(equal_interval(str_to_interval("negative"), NEG));
+    assert(equal_interval(str_to_interval("nonpos"), NONPOS));
+    assert(equal_interval(str_to_interval("NONNEGATIVE"), NONNEG));
+
+    assert(equal_interval(str_to_interval(""), INVALID_INTVL));
+    assert(equal_interval(str_to_interval("posi"), INVALID_INTVL));
+    assert(equal_interval(str_to_interval("(5,3)"), INVALID_INTVL));
+    assert(equal_interval(str_to_interval("[5,5)"), INVALID_INTVL));
+    assert(equal_interval(str_to_interval("[-inf,5]"), INVALID_INTVL));
+    assert(equal_interval(str_to_interval("(inf,5]"), INVALID_INTVL));
+    assert(equal_interval(str_to_interval("(1,2"), INVALID_INTVL));
+    assert(equal_interval(str_to_interval("(1;2)"), INVALID_INTVL));
+    assert(equal_interval(str_to_interval("(a,2)"), INVALID_INTVL));
+    assert(equal_interval(str_to_interval("(1,2) x"), INVALID_INTVL));
 }
 
 void test_is_valid_interval() {
@@ -338,6 +442,7 @@ void test_num_int_in() {
 
 void test_intvl_h() {
     test_interval_to_str();
+    test_str_to_interval();
     test_is_valid_interval();
     test_is_in_interval();
     test_intersection();
@@ -58,10 +58,23 @@ bool equal_interval(Interval i1, Interval i2);
  * 
  * @param intvl The interval to convert.
  * @return A dynamically allocated string representing intvl.
- *         Make sure to call free() after usage.
+ *         Make sure to call dio_free() after usage.
  */
 char *interval_to_str(Interval intvl);
 
+/**
+ * Converts a string to an interval. The string is either the name of a
+ * common interval ("real", "pos", "neg", "nonpos", "nonneg", or the long
+ * forms "positive", "negative", "nonpositive", "nonnegative"), or in one of
+ * the forms "(a,b)", "(a,b]", "[a,b)", "[a,b]", where a may be "-inf" and
+ * b may be "inf". Whitespace and letter case are ignored.
+ * 
+ * @param str The string to convert.
+ * @return The interval represented by str,
+ *         or INVALID_INTVL if str is malformed or not a valid interval.
+ */
+Interval str_to_interval(const char *str);
+
 /**
  * Checks if an interval is valid:
  *   - low <= high, if left_open and right_open are both true.
@@ -0,0 +1,687 @@
+#include "jsonl.h"
+#include "lde.h"
+#include "latency.h"
+#include "memstat.h"
+#include "trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+#include <assert.h>
+
+// Size of the decoded x, y and detail of a request, including the NUL
+#define JSON_STR_MAX 64
+
+// Size of each read from the input
+#define READ_SIZE 65536
+
+/**
+ * Represents the raw text of a value in a request. Strings are checked but
+ * decoded only when needed, so that a string of any length can be echoed.
+ */
+typedef struct JsonValue {
+    const char *start;          // Raw text of the value in the request
+    const char *end;
+    bool is_str;                // True if the value is a string
+} JsonValue;
+
+/**
+ * Fields of a request.
+ */
+typedef struct Request {
+    const char *id_start;       // Raw text of "id", or NULL if absent
+    const char *id_end;
+    long long coeffs[3];        // a, b and c
+    bool has_coeffs[3];
+    char x[JSON_STR_MAX];
+    char y[JSON_STR_MAX];
+    char detail[JSON_STR_MAX];
+} Request;
+
+const char *json_skip_space(const char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * Reads the 4 hex digits of a \u escape.
+ *
+ * @param p The first digit.
+ * @return The code unit, or -1 if p does not start with 4 hex digits.
+ */
+long json_hex4(const char *p) {
+    long unit = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (!isxdigit((unsigned char) p[i])) {
+            return -1;
+        }
+        unit = unit * 16 + (isdigit((unsigned char) p[i])
+                            ? p[i] - '0' : tolower((unsigned char) p[i]) - 'a' + 10);
+    }
+    return unit;
+}
+
+/**
+ * Finds the end of a string value, checking its escapes without decoding
+ * it.
+ *
+ * @param p The opening quote.
+ * @return The character after the closing quote, or NULL if malformed.
+ */
+const char *json_skip_str(const char *p) {
+    for (++p; *p != '"'; ++p) {
+        if ((unsigned char) *p < 0x20) {
+            return NULL;
+        }
+        if (*p == '\\') {
+            ++p;
+            if (*p == 'u') {
+                if (json_hex4(p + 1) < 0) {
+                    return NULL;
+                }
+                p += 4;
+            } else if (!*p || !strchr("\"\\/bfnrt", *p)) {
+                return NULL;
+            }
+        }
+    }
+    return p + 1;
+}
+
+/**
+ * Encodes a code point in UTF-8.
+ *
+ * @param code The code point.
+ * @param out Receives the 1 to 4 bytes.
+ * @return The number of bytes.
+ */
+int json_utf8(long code, char *out) {
+    if (code < 0x80) {
+        out[0] = code;
+        return 1;
+    }
+    if (code < 0x800) {
+        out[0] = 0xC0 | (code >> 6);
+        out[1] = 0x80 | (code & 0x3F);
+        return 2;
+    }
+    if (code < 0x10000) {
+        out[0] = 0xE0 | (code >> 12);
+        out[1] = 0x80 | ((code >> 6) & 0x3F);
+        out[2] = 0x80 | (code & 0x3F);
+        return 3;
+    }
+    out[0] = 0xF0 | (code >> 18);
+    out[1] = 0x80 | ((code >> 12) & 0x3F);
+    out[2] = 0x80 | ((code >> 6) & 0x3F);
+    out[3] = 0x80 | (code & 0x3F);
+    return 4;
+}
+
+/**
+ * Decodes a string value. A \u escape of a surrogate pair becomes one code
+ * point, and an unpaired surrogate becomes U+FFFD.
+ *
+ * @param p The opening quote.
+ * @param str Receives the decoded string in UTF-8.
+ * @param cap Size of str.
+ * @return The character after the closing quote, or NULL if the string is
+ *         malformed, contains \u0000, or does not fit in str.
+ */
+const char *json_parse_str(const char *p, char *str, size_t cap) {
+    const char *end = json_skip_str(p);
+    if (!end) {
+        return NULL;
+    }
+
+    size_t len = 0;
+    for (++p; p < end - 1; ++p) {
+        char bytes[4] = {*p};
+        int n = 1;
+        if (*p == '\\') {
+            switch (*++p) {
+            case 'b':
+                bytes[0] = '\b';
+                break;
+            case 'f':
+                bytes[0] = '\f';
+                break;
+            case 'n':
+                bytes[0] = '\n';
+                break;
+            case 'r':
+                bytes[0] = '\r';
+                break;
+            case 't':
+                bytes[0] = '\t';
+                break;
+            case 'u': {
+                long code = json_hex4(p + 1);
+                p += 4;
+                long low = (p[1] == '\\' && p[2] == 'u') ? json_hex4(p + 3) : -1;
+                if (code >= 0xD800 && code < 0xDC00 && low >= 0xDC00 && low < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                } else if (code >= 0xD800 && code < 0xE000) {
+                    code = 0xFFFD;
+                } else if (code == 0) {
+                    return NULL;
+                }
+                n = json_utf8(code, bytes);
+                break;
+            }
+            default:
+                bytes[0] = *p;
+                break;
+            }
+        }
+        if (len + n >= cap) {
+            return NULL;
+        }
+        memcpy(str + len, bytes, n);
+        len += n;
+    }
+    str[len] = '\0';
+    return end;
+}
+
+const char *json_parse_value(const char *p, JsonValue *val) {
+    val->start = p;
+    val->is_str = (*p == '"');
+    if (val->is_str) {
+        p = json_skip_str(p);
+    } else {
+        while (*p && (isalnum((unsigned char) *p) || strchr("+-.", *p))) {
+            ++p;
+        }
+        if (p == val->start) {
+            return NULL;
+        }
+    }
+    val->end = p;
+    return p;
+}
+
+bool json_int(const JsonValue *val, long long *n) {
+    if (val->is_str) {
+        return false;
+    }
+    char *end;
+    errno = 0;
+    *n = strtoll(val->start, &end, 10);
+    return end == val->end && errno != ERANGE;
+}
+
+/**
+ * Checks if a raw value is a JSON number or null, so that it can be echoed
+ * back as it is.
+ *
+ * @param val A value that is not a string.
+ * @return true if val is a number or null, false otherwise.
+ */
+bool json_is_number_or_null(const JsonValue *val) {
+    const char *p = val->start;
+    if (val->end - p == 4 && !strncmp(p, "null", 4)) {
+        return true;
+    }
+
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    p += (*p == '-');
+    if (*p == '0') {
+        ++p;
+    } else if (isdigit((unsigned char) *p)) {
+        while (isdigit((unsigned char) *p)) {
+            ++p;
+        }
+    } else {
+        return false;
+    }
+    if (*p == '.') {
+        if (!isdigit((unsigned char) *++p)) {
+            return false;
+        }
+        while (isdigit((unsigned char) *p)) {
+            ++p;
+        }
+    }
+    if (*p == 'e' || *p == 'E') {
+        ++p;
+        p += (*p == '+' || *p == '-');
+        if (!isdigit((unsigned char) *p)) {
+            return false;
+        }
+        while (isdigit((unsigned char) *p)) {
+            ++p;
+        }
+    }
+    return p == val->end;
+}
+
+const char *parse_request(const char *line, Request *req) {
+    const char *keys[] = {"a", "b", "c"};
+    memset(req, 0, sizeof(*req));
+    strcpy(req->x, "real");
+    strcpy(req->y, "real");
+    strcpy(req->detail, "set");
+
+    const char *p = json_skip_space(line);
+    if (*p != '{') {
+        return "request is not a JSON object";
+    }
+    p = json_skip_space(p + 1);
+    if (*p == '}') {
+        p = json_skip_space(p + 1);
+        return *p ? "trailing characters after object" : "missing a, b or c";
+    }
+
+    while (true) {
+        char key[JSON_STR_MAX];
+        JsonValue val;
+        const char *key_end = (*p == '"') ? json_skip_str(p) : NULL;
+        if (!key_end) {
+            return "malformed key";
+        }
+        if (!json_parse_str(p, key, sizeof(key))) {
+            // Too long to be any known key
+            key[0] = '\0';
+        }
+        p = json_skip_space(key_end);
+        if (*p != ':') {
+            return "expected ':'";
+        }
+        p = json_skip_space(p + 1);
+        if (!(p = json_parse_value(p, &val))) {
+            return "malformed value";
+        }
+
+        bool known = false;
+        for (int i = 0; i < 3; ++i) {
+            if (equal_str(key, keys[i])) {
+                if (!json_int(&val, &req->coeffs[i]) ||
+                    req->coeffs[i] < NEG_INF || req->coeffs[i] > POS_INF) {
+                    return "a, b and c must be integers within range";
+                }
+                req->has_coeffs[i] = true;
+                known = true;
+            }
+        }
+        if (equal_str(key, "id")) {
+            if (!val.is_str && !json_is_number_or_null(&val)) {
+                return "id must be a string, number or null";
+            }
+            req->id_start = val.start;
+            req->id_end = val.end;
+        } else if (equal_str(key, "x") || equal_str(key, "y") ||
+                   equal_str(key, "detail")) {
+            if (!val.is_str) {
+                return "x, y and detail must be strings";
+            }
+            char *field = equal_str(key, "x") ? req->x :
+                          equal_str(key, "y") ? req->y : req->detail;
+            if (!json_parse_str(val.start, field, JSON_STR_MAX)) {
+                return "x, y and detail must be shorter than 64 bytes";
+            }
+        } else if (!known) {
+            return "unknown key";
+        }
+
+        p = json_skip_space(p);
+        if (*p == '}') {
+            break;
+        }
+        if (*p != ',') {
+            return "expected ',' or '}'";
+        }
+        p = json_skip_space(p + 1);
+    }
+
+    if (*json_skip_space(p + 1)) {
+        return "trailing characters after object";
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (!req->has_coeffs[i]) {
+            return "missing a, b or c";
+        }
+    }
+    return NULL;
+}
+
+void append_json_str(StrBuf *out, const char *str) {
+    strbuf_append(out, "\"");
+    const char *p = str;
+    while (*p) {
+        // Copy runs of characters that need no escaping at once
+        size_t run = strcspn(p, "\"\\\x01\x02\x03\x04\x05\x06\x07\x08\t\n"
+                                "\x0b\x0c\r\x0e\x0f\x10\x11\x12\x13\x14\x15"
+                                "\x16\x17\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f");
+        if (run > 0) {
+            strbuf_append(out, "%.*s", (int) run, p);
+            p += run;
+            continue;
+        }
+
+        unsigned char ch = *p++;
+        if (ch == '"' || ch == '\\') {
+            strbuf_append(out, "\\%c", ch);
+        } else if (ch == '\n') {
+            strbuf_append(out, "\\n");
+        } else if (ch == '\t') {
+            strbuf_append(out, "\\t");
+        } else {
+            strbuf_append(out, "\\u%04x", ch);
+        }
+    }
+    strbuf_append(out, "\"");
+}
+
+void append_json_bound(StrBuf *out, double bound) {
+    if (bound == NEG_INF || bound == POS_INF) {
+        strbuf_append(out, "null");
+    } else {
+        strbuf_append(out, "%.0f", bound);
+    }
+}
+
+void append_id(StrBuf *out, const Request *req) {
+    strbuf_append(out, "{\"id\":");
+    if (req->id_start) {
+        strbuf_append(out, "%.*s", (int) (req->id_end - req->id_start),
+                      req->id_start);
+    } else {
+        strbuf_append(out, "null");
+    }
+}
+
+bool jsonl_handle(const char *line, StrBuf *out) {
+    LatProbe probe = latency_begin();
+    TRACE_BEGIN("request");
+    TRACE_BEGIN("parse");
+    Request req;
+    const char *error = parse_request(line, &req);
+
+    Interval xi = str_to_interval(req.x);
+    Interval yi = str_to_interval(req.y);
+    bool summary = equal_str(req.detail, "summary");
+    bool steps = equal_str(req.detail, "steps");
+    if (!error && !is_valid_interval(xi)) {
+        error = "invalid domain of x";
+    } else if (!error && !is_valid_interval(yi)) {
+        error = "invalid domain of y";
+    } else if (!error && !summary && !steps && !equal_str(req.detail, "set")) {
+        error = "detail must be \"set\", \"summary\" or \"steps\"";
+    }
+    TRACE_END();
+
+    append_id(out, &req);
+    if (error) {
+        strbuf_append(out, ",\"ok\":false,\"error\":");
+        append_json_str(out, error);
+        strbuf_append(out, "}\n");
+        TRACE_END();
+        return false;
+    }
+
+    LDE lde = make_lde_in(req.coeffs[0], req.coeffs[1], req.coeffs[2], xi, yi);
+    SolnSet set = lde_soln_set(lde);
+    strbuf_append(out, ",\"ok\":true,\"exist\":%s,\"plane\":%s,\"d\":%d,"
+                  "\"x0\":%d,\"y0\":%d,\"dx\":%d,\"dy\":%d",
+                  set.exist ? "true" : "false", set.plane ? "true" : "false",
+                  set.d, set.x0, set.y0, set.dx, set.dy);
+
+    if (set.exist && !set.plane) {
+        char *n_str = interval_to_str(set.n_intvl);
+        strbuf_append(out, ",\"n\":");
+        append_json_str(out, n_str);
+        dio_free(n_str);
+        strbuf_append(out, ",\"n_low\":");
+        append_json_bound(out, set.n_intvl.low);
+        strbuf_append(out, ",\"n_high\":");
+        append_json_bound(out, set.n_intvl.high);
+    } else {
+        strbuf_append(out, ",\"n\":null,\"n_low\":null,\"n_high\":null");
+    }
+
+    // Count solutions unless there are infinitely many
+    long long count = 0;
+    if (set.exist && set.plane) {
+        Interval int_xi = int_interval(xi);
+        Interval int_yi = int_interval(yi);
+        bool finite = int_xi.low != NEG_INF && int_xi.high != POS_INF &&
+                      int_yi.low != NEG_INF && int_yi.high != POS_INF;
+        count = finite ? (long long) (int_xi.high - int_xi.low + 1) *
+                         (long long) (int_yi.high - int_yi.low + 1) : -1;
+    } else if (set.exist) {
+        bool finite = set.n_intvl.low != NEG_INF && set.n_intvl.high != POS_INF;
+        count = finite ? (long long) (set.n_intvl.high - set.n_intvl.low + 1)
+                       : -1;
+    }
+    if (count < 0) {
+        strbuf_append(out, ",\"count\":null");
+    } else {
+        strbuf_append(out, ",\"count\":%lld", count);
+    }
+
+    if (summary) {
+        char *set_str = soln_set_to_str(set);
+        strbuf_append(out, ",\"summary\":");
+        append_json_str(out, set_str);
+        dio_free(set_str);
+    }
+
+    if (steps) {
+        List result = lde_result(lde);
+        strbuf_append(out, ",\"steps\":[");
+        for (int i = 0; i < result.size; ++i) {
+            if (i > 0) {
+                strbuf_append(out, ",");
+            }
+            append_json_str(out, list_at(result, i, char*));
+        }
+        strbuf_append(out, "]");
+        lde_result_free(result);
+    }
+
+    strbuf_append(out, "}\n");
+    TRACE_END();
+    latency_end(probe, steps ? LAT_STEPS : LAT_JSON,
+                req.coeffs[0], req.coeffs[1], req.coeffs[2]);
+    return true;
+}
+
+int jsonl_serve(int in_fd, FILE *out) {
+    char *buf = dio_malloc(READ_SIZE);
+    size_t cap = READ_SIZE;
+    size_t len = 0;
+    StrBuf resp = make_strbuf();
+
+    while (true) {
+        if (len + READ_SIZE / 2 > cap) {
+            cap *= 2;
+            buf = dio_realloc(buf, cap);
+        }
+        ssize_t n = read(in_fd, buf + len, cap - len - 1);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            dio_free(buf);
+            strbuf_free(&resp);
+            return -1;
+        }
+        if (n == 0 && len > 0) {
+            // Treat an unterminated last line as a complete request
+            buf[len] = '\n';
+            n = 1;
+        }
+        if (n == 0) {
+            break;
+        }
+        len += n;
+
+        // Answer every complete line in this batch
+        char *line = buf;
+        char *newline;
+        while ((newline = memchr(line, '\n', buf + len - line))) {
+            *newline = '\0';
+            if (*json_skip_space(line)) {
+                strbuf_clear(&resp);
+                jsonl_handle(line, &resp);
+                TRACE_BEGIN("output");
+                fwrite(resp.str, 1, resp.len, out);
+                TRACE_END();
+            }
+            line = newline + 1;
+        }
+        len = buf + len - line;
+        memmove(buf, line, len);
+        fflush(out);
+    }
+
+    dio_free(buf);
+    strbuf_free(&resp);
+    return 0;
+}
+
+void test_jsonl_handle() {
+    StrBuf out = make_strbuf();
+
+    assert(jsonl_handle("{\"id\": 7, \"a\": 9, \"b\": 5, \"c\": 137, "
+                        "\"x\": \"pos\", \"y\": \"pos\"}", &out));
+    assert(equal_str(out.str,
+        "{\"id\":7,\"ok\":true,\"exist\":true,\"plane\":false,\"d\":1,"
+        "\"x0\":-137,\"y0\":274,\"dx\":5,\"dy\":-9,\"n\":\"[28,30]\","
+        "\"n_low\":28,\"n_high\":30,\"count\":3}\n"));
+
+    strbuf_clear(&out);
+    assert(jsonl_handle("{\"a\":-9,\"b\":5,\"c\":137,\"x\":\"(0,inf)\","
+                        "\"y\":\"POS\",\"detail\":\"summary\",\"id\":\"q1\"}",
+                        &out));
+    assert(equal_str(out.str,
+        "{\"id\":\"q1\",\"ok\":true,\"exist\":true,\"plane\":false,\"d\":1,"
+        "\"x0\":137,\"y0\":274,\"dx\":5,\"dy\":9,\"n\":\"[-27,inf)\","
+        "\"n_low\":-27,\"n_high\":null,\"count\":null,"
+        "\"summary\":\"x = 137 + 5n, y = 274 + 9n, n ∈ [-27,inf)\"}\n"));
+
+    strbuf_clear(&out);
+    assert(jsonl_handle("{\"a\":10,\"b\":8,\"c\":99}", &out));
+    assert(equal_str(out.str,
+        "{\"id\":null,\"ok\":true,\"exist\":false,\"plane\":false,\"d\":2,"
+        "\"x0\":0,\"y0\":0,\"dx\":0,\"dy\":0,\"n\":null,\"n_low\":null,"
+        "\"n_high\":null,\"count\":0}\n"));
+
+    strbuf_clear(&out);
+    assert(jsonl_handle("{\"a\":0,\"b\":0,\"c\":0,\"x\":\"[1,3]\","
+                        "\"y\":\"[0,1]\"}", &out));
+    assert(strstr(out.str, "\"plane\":true") && strstr(out.str, "\"count\":6}"));
+
+    strbuf_clear(&out);
+    assert(jsonl_handle("{\"a\":1,\"b\":-1,\"c\":0,\"detail\":\"steps\"}", &out));
+    assert(strstr(out.str, "\"steps\":[\"Solving the Linear Diophantine "
+                           "Equation (LDE):\\n\",\"\\tx - y = 0\\n\","));
+
+    const char *bad[] = {
+        "",
+        "[1, 2]",
+        "{\"a\":1,\"b\":2}",
+        "{\"a\":1.5,\"b\":2,\"c\":3}",
+        "{\"a\":\"1\",\"b\":2,\"c\":3}",
+        "{\"a\":1,\"b\":2,\"c\":3000000000}",
+        "{\"a\":1,\"b\":2,\"c\":3,\"x\":\"(1,0)\"}",
+        "{\"a\":1,\"b\":2,\"c\":3,\"y\":5}",
+        "{\"a\":1,\"b\":2,\"c\":3,\"detail\":\"all\"}",
+        "{\"a\":1,\"b\":2,\"c\":3,\"z\":0}",
+        "{\"a\":1 \"b\":2,\"c\":3}",
+        "{\"a\":1,\"b\":2,\"c\":3} x",
+        "{\"id\": foo,\"a\":1,\"b\":2,\"c\":3}",
+        "{\"id\":01,\"a\":1,\"b\":2,\"c\":3}",
+        "{\"id\":1.,\"a\":1,\"b\":2,\"c\":3}",
+        "{\"id\":true,\"a\":1,\"b\":2,\"c\":3}",
+        "{\"id\":\"\\x\",\"a\":1,\"b\":2,\"c\":3}",
+        "{\"id\":\"\\u12\",\"a\":1,\"b\":2,\"c\":3}",
+        "{\"id\":\"\t\",\"a\":1,\"b\":2,\"c\":3}",
+        "{\"a\":1,\"b\":2,\"c\":3,\"x\":\"\\u0000\"}",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        strbuf_clear(&out);
+        assert(!jsonl_handle(bad[i], &out));
+        assert(strstr(out.str, "\"ok\":false,\"error\":"));
+    }
+
+    // An invalid id is not echoed back
+    strbuf_clear(&out);
+    assert(!jsonl_handle("{\"id\": foo,\"a\":1,\"b\":2,\"c\":3}", &out));
+    assert(equal_str(out.str, "{\"id\":null,\"ok\":false,\"error\":"
+                              "\"id must be a string, number or null\"}\n"));
+
+    const char *ids[] = {
+        "-7", "0", "1.25e-3", "2E+10", "null", "\"a b\"",
+        "\"\\u0041\\b\\f\\r\\ud83d\\ude00\"",
+        "\"0123456789012345678901234567890123456789012345678901234567890123"
+        "456789\"",
+    };
+    for (size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); ++i) {
+        char line[160];
+        snprintf(line, sizeof(line), "{\"id\":%s,\"a\":1,\"b\":2,\"c\":3}",
+                 ids[i]);
+        strbuf_clear(&out);
+        assert(jsonl_handle(line, &out));
+        assert(!strncmp(out.str + strlen("{\"id\":"), ids[i], strlen(ids[i])));
+    }
+
+    // An error after the id is matched to the request by its raw id
+    strbuf_clear(&out);
+    assert(!jsonl_handle("{\"id\":\"\\u00e9\",\"a\":1,\"b\":2,\"c\":3,"
+                         "\"detail\":\"0123456789012345678901234567890123456789"
+                         "012345678901234567890123\"}", &out));
+    assert(equal_str(out.str, "{\"id\":\"\\u00e9\",\"ok\":false,\"error\":"
+                              "\"x, y and detail must be shorter than 64 "
+                              "bytes\"}\n"));
+
+    // Escapes of the whole JSON set are decoded in x, y, detail and keys
+    char str[JSON_STR_MAX];
+    assert(json_parse_str("\"\\u0041\\/\\b\\f\\n\\r\\t\\u00e9\\u20ac"
+                          "\\ud83d\\ude00\\udc00\"", str, sizeof(str)));
+    assert(equal_str(str, "A/\b\f\n\r\t\xc3\xa9\xe2\x82\xac"
+                          "\xf0\x9f\x98\x80\xef\xbf\xbd"));
+    assert(!json_parse_str("\"abcd\"", str, 4));
+    strbuf_clear(&out);
+    assert(jsonl_handle("{\"\\u0061\":9,\"b\":5,\"c\":137,"
+                        "\"x\":\"\\u0070os\",\"y\":\"[0,\\u0069nf)\"}", &out));
+    assert(strstr(out.str, "\"count\":3}"));
+
+    strbuf_free(&out);
+}
+
+void test_jsonl_serve() {
+    int fds[2];
+    assert(pipe(fds) == 0);
+    const char *input = "{\"id\":1,\"a\":2,\"b\":4,\"c\":6}\n\n"
+                        "{\"id\":2,\"a\":2,\"b\":4,\"c\":5}\n"
+                        "{\"id\":3";
+    assert(write(fds[1], input, strlen(input)) == (ssize_t) strlen(input));
+    close(fds[1]);
+
+    char output[1024] = {0};
+    FILE *out = fmemopen(output, sizeof(output), "w");
+    assert(jsonl_serve(fds[0], out) == 0);
+    fclose(out);
+    close(fds[0]);
+
+    const char *lines[] = {"{\"id\":1,\"ok\":true,", "{\"id\":2,\"ok\":true,",
+                           "{\"id\":3,\"ok\":false,"};
+    const char *p = output;
+    for (int i = 0; i < 3; ++i) {
+        assert(!strncmp(p, lines[i], strlen(lines[i])));
+        p = strchr(p, '\n') + 1;
+    }
+    assert(!*p);
+}
+
+void test_jsonl_h() {
+    test_jsonl_handle();
+    test_jsonl_serve();
+}
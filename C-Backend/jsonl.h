@@ -0,0 +1,66 @@
+/**
+ * "jsonl.h" provides a line-delimited JSON interface to the solver, so that
+ * one long-lived process can solve a stream of LDEs.
+ *
+ * Each request is a JSON object on its own line:
+ *   {"id": 7, "a": 9, "b": 5, "c": 137, "x": "pos", "y": "[0,10)",
+ *    "detail": "summary"}
+ * where:
+ *   - "id" is optional, and is a string, number or null of any length that
+ *     is echoed back verbatim.
+ *   - "x" and "y" are domains accepted by str_to_interval(),
+ *     and default to "real". They and "detail" must decode to fewer than
+ *     64 bytes; every JSON escape is accepted.
+ *   - "detail" is one of:
+ *       "set"      Fields of the solution set only (default)
+ *       "summary"  Also a one-line summary from soln_set_to_str()
+ *       "steps"    Also every line of lde_result()
+ *
+ * Each response is a JSON object on its own line, in the order of requests:
+ *   {"id":7,"ok":true,"exist":true,"plane":false,"d":1,"x0":-137,"y0":274,
+ *    "dx":5,"dy":-9,"n":"[28,30]","n_low":28,"n_high":30,"count":3,...}
+ * where "n_low" and "n_high" are null if unbounded. Malformed requests
+ * produce {"id":...,"ok":false,"error":"..."}.
+ */
+
+#ifndef JSONL_H
+#define JSONL_H
+
+#include "betterc.h"
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Handles a single request line.
+ *
+ * @param line The request, without the trailing newline.
+ * @param out Receives the response, including the trailing newline.
+ * @return true if the request was solved, false if it was malformed.
+ */
+bool jsonl_handle(const char *line, StrBuf *out);
+
+/**
+ * Reads requests from a file descriptor until end of file, and writes
+ * a response for each. Output is flushed once per batch, i.e. after all
+ * requests that arrived in a single read have been answered.
+ *
+ * @param in_fd File descriptor to read requests from.
+ * @param out Stream to write responses to.
+ * @return 0 at end of file, or -1 if reading failed.
+ */
+int jsonl_serve(int in_fd, FILE *out);
+
+/**
+ * Runs unit tests for functions in "jsonl.h".
+ */
+void test_jsonl_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
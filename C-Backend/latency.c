@@ -0,0 +1,393 @@
+#include "latency.h"
+#include "betterc.h"
+#include "memstat.h"
+#include "stats.h"
+#include "eea.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <pthread.h>
+#include <assert.h>
+
+/**
+ * Histograms of a thread. Only the thread itself writes them, so updates
+ * need no atomic read-modify-write; latency_snapshot() reads them with
+ * atomic loads.
+ */
+typedef struct ThreadLatency {
+    Latency lat;
+    struct ThreadLatency *next;
+} ThreadLatency;
+
+bool latency_on = false;
+
+// Histograms of all threads that recorded a request, newest first. They are
+// never freed, so that the requests of exited threads are kept.
+ThreadLatency *thread_latencies;
+
+_Thread_local ThreadLatency *local_latency;
+
+const char *lat_path_names[NUM_LAT_PATHS] = {
+    "text", "json", "steps", "ring",
+};
+
+const char *lat_class_names[NUM_LAT_CLASSES] = {
+    "eea0", "eea1-7", "eea8-15", "eea16+", "bits8", "bits16", "bits24", "bits32",
+};
+
+// Signal and stream of latency_dump_on_signal()
+sigset_t dump_signals;
+FILE *dump_out;
+
+ThreadLatency *register_thread_latency() {
+    ThreadLatency *tl = calloc(1, sizeof(ThreadLatency));
+    if (!tl) {
+        return NULL;
+    }
+
+    // Push without a lock, so that registering never blocks a snapshot
+    tl->next = __atomic_load_n(&thread_latencies, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&thread_latencies, &tl->next, tl, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    local_latency = tl;
+    return tl;
+}
+
+void latency_enable() {
+    // Calibrate now rather than in the first report
+    stat_cycles_per_ns();
+    __atomic_store_n(&latency_on, true, __ATOMIC_RELEASE);
+}
+
+LatProbe latency_begin() {
+    if (!latency_on) {
+        return (LatProbe) {0, 0};
+    }
+    return (LatProbe) {stat_cycles() | 1, eea_thread_steps()};
+}
+
+int lat_bucket(uint64_t cycles) {
+    if (cycles >> LAT_MAX_BITS) {
+        return LAT_BUCKETS - 1;
+    }
+    if (cycles < (1u << LAT_SUB_BITS)) {
+        return cycles;
+    }
+    int exp = 63 - __builtin_clzll(cycles);
+    int sub = (cycles >> (exp - LAT_SUB_BITS)) & ((1u << LAT_SUB_BITS) - 1);
+    return ((exp - LAT_SUB_BITS + 1) << LAT_SUB_BITS) + sub;
+}
+
+uint64_t lat_bucket_max(int bucket) {
+    if (bucket < (1 << LAT_SUB_BITS)) {
+        return bucket;
+    }
+    int exp = (bucket >> LAT_SUB_BITS) + LAT_SUB_BITS - 1;
+    uint64_t sub = bucket & ((1u << LAT_SUB_BITS) - 1);
+    uint64_t low = ((1ull << LAT_SUB_BITS) + sub) << (exp - LAT_SUB_BITS);
+    return low + (1ull << (exp - LAT_SUB_BITS)) - 1;
+}
+
+LatClass steps_class(unsigned steps) {
+    if (steps == 0) {
+        return LAT_STEPS_0;
+    }
+    return steps < 8 ? LAT_STEPS_1_7 : steps < 16 ? LAT_STEPS_8_15 : LAT_STEPS_16;
+}
+
+LatClass bits_class(int a, int b, int c) {
+    // The highest bit set in any of them is that of the largest
+    unsigned bits = abs(a) | abs(b) | abs(c);
+    return bits >> 24 ? LAT_BITS_32 :
+           bits >> 16 ? LAT_BITS_24 :
+           bits >> 8 ? LAT_BITS_16 : LAT_BITS_8;
+}
+
+void add_sample(LatHist *hist, int bucket) {
+    uint64_t *count = &hist->counts[bucket];
+    __atomic_store_n(count, __atomic_load_n(count, __ATOMIC_RELAXED) + 1,
+                     __ATOMIC_RELAXED);
+}
+
+void latency_end(LatProbe probe, LatPath path, int a, int b, int c) {
+    if (!probe.start) {
+        return;
+    }
+    uint64_t cycles = stat_cycles() - probe.start;
+    unsigned steps = eea_thread_steps() - probe.eea_steps;
+    ThreadLatency *tl = local_latency ? local_latency : register_thread_latency();
+    if (!tl) {
+        return;
+    }
+
+    int bucket = lat_bucket(cycles);
+    add_sample(&tl->lat.hists[path][steps_class(steps)], bucket);
+    add_sample(&tl->lat.hists[path][bits_class(a, b, c)], bucket);
+}
+
+uint64_t lat_hist_count(const LatHist *hist) {
+    uint64_t count = 0;
+    for (int i = 0; i < LAT_BUCKETS; ++i) {
+        count += hist->counts[i];
+    }
+    return count;
+}
+
+uint64_t lat_hist_percentile(const LatHist *hist, double p) {
+    uint64_t count = lat_hist_count(hist);
+    if (count == 0) {
+        return 0;
+    }
+
+    // Rank of the percentile, from 1 to count, forgiving rounding errors
+    uint64_t rank = ceil(p * count - 1e-6);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < LAT_BUCKETS; ++i) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            return lat_bucket_max(i);
+        }
+    }
+    return lat_bucket_max(LAT_BUCKETS - 1);
+}
+
+uint64_t lat_hist_max(const LatHist *hist) {
+    for (int i = LAT_BUCKETS - 1; i >= 0; --i) {
+        if (hist->counts[i]) {
+            return lat_bucket_max(i);
+        }
+    }
+    return 0;
+}
+
+const char *lat_path_name(LatPath path) {
+    return lat_path_names[path];
+}
+
+const char *lat_class_name(LatClass cls) {
+    return lat_class_names[cls];
+}
+
+void latency_snapshot(Latency *lat) {
+    memset(lat, 0, sizeof(Latency));
+    for (ThreadLatency *tl = __atomic_load_n(&thread_latencies, __ATOMIC_ACQUIRE);
+         tl; tl = tl->next) {
+        for (int i = 0; i < NUM_LAT_PATHS; ++i) {
+            for (int j = 0; j < NUM_LAT_CLASSES; ++j) {
+                uint64_t *sum = lat->hists[i][j].counts;
+                uint64_t *counts = tl->lat.hists[i][j].counts;
+                for (int k = 0; k < LAT_BUCKETS; ++k) {
+                    sum[k] += __atomic_load_n(&counts[k], __ATOMIC_RELAXED);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Sums the classes by EEA steps of a path, which count every request once.
+ */
+void path_hist(const Latency *lat, LatPath path, LatHist *hist) {
+    memset(hist, 0, sizeof(LatHist));
+    for (int j = LAT_STEPS_0; j <= LAT_STEPS_16; ++j) {
+        for (int k = 0; k < LAT_BUCKETS; ++k) {
+            hist->counts[k] += lat->hists[path][j].counts[k];
+        }
+    }
+}
+
+void write_hist_row(FILE *out, const char *name, const LatHist *hist,
+                    double per_ns) {
+    fprintf(out, "%-16s %12llu %10.0f %10.0f %10.0f %10.0f\n", name,
+            (unsigned long long) lat_hist_count(hist),
+            lat_hist_percentile(hist, 0.50) / per_ns,
+            lat_hist_percentile(hist, 0.99) / per_ns,
+            lat_hist_percentile(hist, 0.999) / per_ns,
+            lat_hist_max(hist) / per_ns);
+}
+
+void latency_write(const Latency *lat, FILE *out) {
+    double per_ns = stat_cycles_per_ns();
+    fprintf(out, "%-16s %12s %10s %10s %10s %10s\n",
+            "path", "count", "p50_ns", "p99_ns", "p999_ns", "max_ns");
+
+    LatHist *hist = dio_malloc(sizeof(LatHist));
+    for (int i = 0; i < NUM_LAT_PATHS; ++i) {
+        path_hist(lat, i, hist);
+        if (!lat_hist_count(hist)) {
+            continue;
+        }
+        write_hist_row(out, lat_path_names[i], hist, per_ns);
+        for (int j = 0; j < NUM_LAT_CLASSES; ++j) {
+            if (lat_hist_count(&lat->hists[i][j])) {
+                char name[32];
+                snprintf(name, sizeof(name), "%s/%s",
+                         lat_path_names[i], lat_class_names[j]);
+                write_hist_row(out, name, &lat->hists[i][j], per_ns);
+            }
+        }
+    }
+    dio_free(hist);
+}
+
+void append_hist(StrBuf *buf, const char *path, const char *cls,
+                 const LatHist *hist, double per_ns) {
+    strbuf_append(buf, "%s%s%s%s=%llu,%.0f,%.0f,%.0f", buf->len ? " " : "",
+                  path, cls ? "/" : "", cls ? cls : "",
+                  (unsigned long long) lat_hist_count(hist),
+                  lat_hist_percentile(hist, 0.50) / per_ns,
+                  lat_hist_percentile(hist, 0.99) / per_ns,
+                  lat_hist_percentile(hist, 0.999) / per_ns);
+}
+
+char *latency_to_str(const Latency *lat) {
+    double per_ns = stat_cycles_per_ns();
+    StrBuf buf = make_strbuf();
+    LatHist *hist = dio_malloc(sizeof(LatHist));
+    for (int i = 0; i < NUM_LAT_PATHS; ++i) {
+        path_hist(lat, i, hist);
+        if (!lat_hist_count(hist)) {
+            continue;
+        }
+        append_hist(&buf, lat_path_names[i], NULL, hist, per_ns);
+        for (int j = 0; j < NUM_LAT_CLASSES; ++j) {
+            if (lat_hist_count(&lat->hists[i][j])) {
+                append_hist(&buf, lat_path_names[i], lat_class_names[j],
+                            &lat->hists[i][j], per_ns);
+            }
+        }
+    }
+    dio_free(hist);
+    return buf.str;
+}
+
+void *dump_on_signal(void *arg) {
+    (void) arg;
+    Latency *lat = dio_malloc(sizeof(Latency));
+    while (true) {
+        int sig;
+        if (sigwait(&dump_signals, &sig) == 0) {
+            latency_snapshot(lat);
+            latency_write(lat, dump_out);
+            fflush(dump_out);
+        }
+    }
+    return NULL;
+}
+
+bool latency_dump_on_signal(int sig, FILE *out) {
+    sigemptyset(&dump_signals);
+    sigaddset(&dump_signals, sig);
+    dump_out = out;
+    if (pthread_sigmask(SIG_BLOCK, &dump_signals, NULL)) {
+        return false;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, dump_on_signal, NULL)) {
+        return false;
+    }
+    pthread_detach(thread);
+    return true;
+}
+
+void test_lat_buckets() {
+    // Small samples are exact
+    for (uint64_t v = 0; v < 16; ++v) {
+        assert(lat_bucket(v) == (int) v);
+        assert(lat_bucket_max(v) == v);
+    }
+
+    // Buckets are contiguous, and within 1/16 of their samples
+    for (int i = 0; i < LAT_BUCKETS - 1; ++i) {
+        uint64_t max = lat_bucket_max(i);
+        assert(lat_bucket(max) == i);
+        assert(lat_bucket(max + 1) == i + 1);
+    }
+    for (uint64_t v = 16; v < (1ull << LAT_MAX_BITS); v = v * 3 + 1) {
+        uint64_t max = lat_bucket_max(lat_bucket(v));
+        assert(max >= v && max - v < v / 16 + 1);
+    }
+    assert(lat_bucket(UINT64_MAX) == LAT_BUCKETS - 1);
+    assert(lat_bucket(1ull << LAT_MAX_BITS) == LAT_BUCKETS - 1);
+}
+
+void test_lat_hist_percentile() {
+    LatHist *hist = dio_calloc(1, sizeof(LatHist));
+    assert(lat_hist_percentile(hist, 0.5) == 0);
+
+    // 990 samples of 10, 9 of 100, and 1 of 1000
+    hist->counts[lat_bucket(10)] = 990;
+    hist->counts[lat_bucket(100)] = 9;
+    hist->counts[lat_bucket(1000)] = 1;
+    assert(lat_hist_count(hist) == 1000);
+    assert(lat_hist_percentile(hist, 0.50) == 10);
+    assert(lat_hist_percentile(hist, 0.99) == 10);
+    assert(lat_hist_percentile(hist, 0.995) == lat_bucket_max(lat_bucket(100)));
+    assert(lat_hist_percentile(hist, 0.999) == lat_bucket_max(lat_bucket(100)));
+    assert(lat_hist_percentile(hist, 1.0) == lat_bucket_max(lat_bucket(1000)));
+    assert(lat_hist_max(hist) == lat_bucket_max(lat_bucket(1000)));
+    dio_free(hist);
+}
+
+void *test_latency_thread(void *arg) {
+    (void) arg;
+    LatProbe probe = latency_begin();
+    latency_end(probe, LAT_RING, 0, 300, 7);
+    return NULL;
+}
+
+void test_latency_record() {
+    Latency *before = dio_malloc(sizeof(Latency));
+    Latency *after = dio_malloc(sizeof(Latency));
+    LatProbe probe = latency_begin();
+    latency_end(probe, LAT_RING, 1, 1, 1);
+    latency_snapshot(before);
+    if (!latency_on) {
+        assert(lat_hist_count(&before->hists[LAT_RING][LAT_BITS_8]) == 0);
+    }
+
+    latency_enable();
+    probe = latency_begin();
+    eea_2nd_last_row(1386, 322);
+    latency_end(probe, LAT_RING, 1386, 322, 14);
+
+    // Samples of other threads are merged
+    pthread_t thread;
+    pthread_create(&thread, NULL, test_latency_thread, NULL);
+    pthread_join(thread, NULL);
+    latency_snapshot(after);
+
+    const Latency *lats[2] = {before, after};
+    uint64_t counts[2][NUM_LAT_CLASSES];
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < NUM_LAT_CLASSES; ++j) {
+            counts[i][j] = lat_hist_count(&lats[i]->hists[LAT_RING][j]);
+        }
+    }
+    assert(counts[1][LAT_STEPS_1_7] - counts[0][LAT_STEPS_1_7] == 1);
+    assert(counts[1][LAT_STEPS_0] - counts[0][LAT_STEPS_0] == 1);
+    assert(counts[1][LAT_BITS_16] - counts[0][LAT_BITS_16] == 2);
+    assert(counts[1][LAT_BITS_8] == counts[0][LAT_BITS_8]);
+
+    char *str = latency_to_str(after);
+    assert(!strncmp(str, "ring=", 5) || strstr(str, " ring="));
+    assert(strstr(str, " ring/eea1-7="));
+    assert(strstr(str, " ring/bits16="));
+    assert(!strstr(str, "ring/bits8="));
+    dio_free(str);
+    dio_free(before);
+    dio_free(after);
+}
+
+void test_latency_h() {
+    test_lat_buckets();
+    test_lat_hist_percentile();
+    test_latency_record();
+}
@@ -0,0 +1,208 @@
+/**
+ * "latency.h" provides latency histograms of the requests served by the
+ * long-running modes (diosolverd, its shared-memory ring, and
+ * diosolver --jsonl), for tail latencies rather than averages.
+ *
+ * Each request is timed in cycles from parsing to its finished response,
+ * and counted in a log-bucketed histogram in the style of HdrHistogram:
+ * every power of 2 is split into 2^LAT_SUB_BITS buckets, so a percentile is
+ * accurate to within 1/16 of its value at any scale. Samples are kept per
+ * request path, and per size class of the request: the number of EEA steps
+ * it ran, and the bit width of its largest coefficient.
+ *
+ * Each thread counts its samples in its own histograms without locks, and
+ * latency_snapshot() merges the histograms of all threads. Recording is off
+ * until latency_enable() is called, and costs a single branch until then.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Buckets per power of 2 are 2^LAT_SUB_BITS
+#define LAT_SUB_BITS 4
+
+// Samples of 2^LAT_MAX_BITS cycles or more share the last bucket
+#define LAT_MAX_BITS 40
+
+// Number of buckets of a histogram
+#define LAT_BUCKETS ((LAT_MAX_BITS - LAT_SUB_BITS + 1) << LAT_SUB_BITS)
+
+/**
+ * Request paths.
+ */
+typedef enum LatPath {
+    LAT_TEXT,       // Text requests of "proto.h" (solution set only)
+    LAT_JSON,       // JSON requests for the solution set or its summary
+    LAT_STEPS,      // JSON requests for the steps, i.e. lde_result()
+    LAT_RING,       // LDEs solved from a shared-memory ring
+    NUM_LAT_PATHS,
+} LatPath;
+
+/**
+ * Size classes of a request. Each sample is counted in one class by EEA
+ * steps and in one class by width.
+ */
+typedef enum LatClass {
+    LAT_STEPS_0,        // No EEA steps (a or b is 0, or a cached solve)
+    LAT_STEPS_1_7,
+    LAT_STEPS_8_15,
+    LAT_STEPS_16,       // 16 steps or more
+    LAT_BITS_8,         // Largest of |a|, |b| and |c| fits in 8 bits
+    LAT_BITS_16,
+    LAT_BITS_24,
+    LAT_BITS_32,
+    NUM_LAT_CLASSES,
+} LatClass;
+
+/**
+ * Counts of samples by bucket.
+ */
+typedef struct LatHist {
+    uint64_t counts[LAT_BUCKETS];
+} LatHist;
+
+/**
+ * Histograms of every path and class, of one thread or of the whole process.
+ * The histogram of a path is the sum of its classes by EEA steps.
+ */
+typedef struct Latency {
+    LatHist hists[NUM_LAT_PATHS][NUM_LAT_CLASSES];
+} Latency;
+
+/**
+ * A request being timed.
+ */
+typedef struct LatProbe {
+    uint64_t start;         // Cycles at the start, or 0 if not recorded
+    unsigned eea_steps;     // eea_thread_steps() at the start
+} LatProbe;
+
+// True while requests are recorded
+extern bool latency_on;
+
+/**
+ * Starts recording requests. Recording cannot be stopped, as the
+ * histograms only make sense for the lifetime of a server.
+ */
+void latency_enable();
+
+/**
+ * Starts timing a request on the calling thread.
+ *
+ * @return The probe to pass to latency_end().
+ */
+LatProbe latency_begin();
+
+/**
+ * Records a request started by latency_begin() on the calling thread.
+ * Does nothing if recording was off at latency_begin().
+ *
+ * @param probe The probe returned by latency_begin().
+ * @param path Path of the request.
+ * @param a, b, c The coefficients of the LDE, for the width class.
+ */
+void latency_end(LatProbe probe, LatPath path, int a, int b, int c);
+
+/**
+ * Finds the bucket of a sample.
+ *
+ * @param cycles The sample.
+ * @return The index of its bucket in LatHist.counts.
+ */
+int lat_bucket(uint64_t cycles);
+
+/**
+ * Finds the largest sample counted in a bucket.
+ *
+ * @param bucket An index in LatHist.counts.
+ * @return The largest sample in cycles.
+ */
+uint64_t lat_bucket_max(int bucket);
+
+/**
+ * Computes a percentile of a histogram, rounded up to the largest sample of
+ * its bucket.
+ *
+ * @param hist The histogram.
+ * @param p The percentile, such as 0.99.
+ * @return The percentile in cycles, or 0 if the histogram is empty.
+ */
+uint64_t lat_hist_percentile(const LatHist *hist, double p);
+
+/**
+ * Counts the samples of a histogram.
+ *
+ * @param hist The histogram.
+ * @return The number of samples.
+ */
+uint64_t lat_hist_count(const LatHist *hist);
+
+/**
+ * Gets the name of a path, such as "steps".
+ */
+const char *lat_path_name(LatPath path);
+
+/**
+ * Gets the name of a class, such as "eea8-15" or "bits16".
+ */
+const char *lat_class_name(LatClass cls);
+
+/**
+ * Merges the histograms of all threads since recording started.
+ * The result may miss requests that finish during the call.
+ *
+ * @param lat Receives the merged histograms. It is large, so callers
+ *            usually allocate it on the heap.
+ */
+void latency_snapshot(Latency *lat);
+
+/**
+ * Writes the count, p50, p99, p999 and maximum in nanoseconds of every path
+ * and class that recorded a request, one per line, as a table.
+ *
+ * @param lat The histograms.
+ * @param out The stream to write to.
+ */
+void latency_write(const Latency *lat, FILE *out);
+
+/**
+ * Formats the count, p50, p99 and p999 in nanoseconds of every path and class
+ * that recorded a request on a single line, as in
+ *   "steps=120,5100,9800,15000 steps/eea1-7=100,5000,9100,9800"
+ *
+ * @param lat The histograms.
+ * @return A string which must be freed by the caller.
+ */
+char *latency_to_str(const Latency *lat);
+
+/**
+ * Writes the merged histograms to a stream with latency_write() whenever
+ * the process receives a signal, such as SIGUSR1. The signal is handled on
+ * a thread of its own, so the report is not limited to async-signal-safe
+ * calls. Must be called before other threads are created, as they inherit
+ * the signal mask of the caller.
+ *
+ * @param sig The signal.
+ * @param out The stream to write to.
+ * @return true if the handler thread was started.
+ */
+bool latency_dump_on_signal(int sig, FILE *out);
+
+/**
+ * Runs unit tests for functions in "latency.h".
+ */
+void test_latency_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,6 +1,14 @@
 #include "lde.h"
 #include "ineq.h"
 #include "betterc.h"
+#include "memstat.h"
+#include "stats.h"
+#include "trace.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
 
 Solution make_solution(int x, int y) {
     return (Solution) {x, y, true};
@@ -14,6 +22,25 @@ LDE make_lde_in(int a, int b, int c, Interval xi, Interval yi) {
     return (LDE) {a, b, c, xi, yi};
 }
 
+Solution scale_unit_soln(int a, int b, int c, int d, int x1, int y1) {
+    long long factor = c / d;
+    long long x = x1 * factor;
+    long long y = y1 * factor;
+    if (x < INT_MIN || x > INT_MAX || y < INT_MIN || y > INT_MAX) {
+        // Move x by a multiple of b / d to the value nearest 0, so that
+        // |x| <= |b / 2d| and |y| < |c / b| + |a / 2d| both fit in an int
+        long long m = llabs((long long) b / d);
+        x %= m;
+        if (x > m / 2) {
+            x -= m;
+        } else if (x < -(m / 2)) {
+            x += m;
+        }
+        y = ((long long) c - (long long) a * x) / b;
+    }
+    return make_solution(x, y);
+}
+
 Solution eea_lde(LDE lde) {
     return eea_lde_row(lde, eea_2nd_last_row(lde.a, lde.b));
 }
@@ -32,19 +59,112 @@ Solution eea_lde_row(LDE lde, EEAR row) {
         return NO_SOLN;
     }
 
-    int factor = c / gcd_ab;
-    int x = row.x * factor;
-    int y = row.y * factor;
+    STAT_ENTER(STAT_PARTICULAR);
+    TRACE_BEGIN("particular");
+    int x1 = (abs(a) > abs(b)) ? row.x : row.y;
+    int y1 = (abs(a) > abs(b)) ? row.y : row.x;
+    Solution soln = scale_unit_soln(a, b, c, gcd_ab,
+                                    abs(a) / a * x1, abs(b) / b * y1);
+    TRACE_END();
+    STAT_LEAVE();
+    return soln;
+}
 
-    Solution soln = make_solution(abs(a) / a, abs(b) / b);
-    if (abs(a) > abs(b)) {
-        soln.x *= x;
-        soln.y *= y;
+PreparedLDE prepare_lde(int a, int b) {
+    PreparedLDE prep = {a, b, 0, 0, 0, 0, 0};
+    if (a == 0 && b == 0) {
+        return prep;
+    }
+
+    if (a == 0) {
+        prep.d = abs(b);
+        prep.dx = 1;
+    } else if (b == 0) {
+        prep.d = abs(a);
+        prep.dy = 1;
     } else {
-        soln.x *= y;
-        soln.y *= x;
+        EEAR row = eea_2nd_last_row(a, b);
+        prep.d = eea_gcd_row(row);
+        Solution unit_soln = eea_lde_row(make_lde(a, b, prep.d), row);
+        prep.x1 = unit_soln.x;
+        prep.y1 = unit_soln.y;
+        prep.dx = b / prep.d;
+        prep.dy = -a / prep.d;
     }
-    return soln;
+    return prep;
+}
+
+SolnSet prepared_soln_set(const PreparedLDE *prep, int c,
+                          Interval xi, Interval yi) {
+    int a = prep->a;
+    int b = prep->b;
+    SolnSet set = NO_SOLN_SET;
+    STAT_COUNT(STAT_SOLVES, 1);
+
+    if (a == 0 && b == 0) {
+        set.plane = true;
+        set.exist = c == 0 &&
+                    is_valid_interval(int_interval(xi)) &&
+                    is_valid_interval(int_interval(yi));
+        return set;
+    }
+
+    set.d = prep->d;
+    if (a == 0) {
+        if (c % b != 0 || !is_in_interval(c / b, yi)) {
+            return set;
+        }
+        set.y0 = c / b;
+        set.dx = 1;
+        set.n_intvl = int_interval(xi);
+    } else if (b == 0) {
+        if (c % a != 0 || !is_in_interval(c / a, xi)) {
+            return set;
+        }
+        set.x0 = c / a;
+        set.dy = 1;
+        set.n_intvl = int_interval(yi);
+    } else {
+        if (c % prep->d != 0) {
+            return set;
+        }
+        Solution soln = scale_unit_soln(a, b, c, prep->d, prep->x1, prep->y1);
+        set.x0 = soln.x;
+        set.y0 = soln.y;
+        set.dx = prep->dx;
+        set.dy = prep->dy;
+        set.n_intvl = int_interval(
+            solve_ineq_sys(set.x0, set.dx, set.y0, set.dy, xi, yi));
+    }
+
+    set.exist = is_valid_interval(set.n_intvl);
+    return set;
+}
+
+void prepared_soln_sets(const PreparedLDE *prep, const int *cs, int n,
+                        Interval xi, Interval yi, SolnSet *sets) {
+    for (int i = 0; i < n; ++i) {
+        sets[i] = prepared_soln_set(prep, cs[i], xi, yi);
+    }
+}
+
+SolnSet lde_soln_set(LDE lde) {
+    TRACE_BEGIN("solve");
+    PreparedLDE prep = prepare_lde(lde.a, lde.b);
+    SolnSet set = prepared_soln_set(&prep, lde.c, lde.xi, lde.yi);
+    TRACE_END();
+    return set;
+}
+
+bool equal_soln_set(SolnSet s1, SolnSet s2) {
+    return s1.d == s2.d &&
+           s1.x0 == s2.x0 &&
+           s1.y0 == s2.y0 &&
+           s1.dx == s2.dx &&
+           s1.dy == s2.dy &&
+           equal_interval(s1.n_intvl, s2.n_intvl) &&
+           s1.plane == s2.plane &&
+           s1.exist == s2.exist;
 }
 
 char *lde_to_str(int a, int b, int c) {
@@ -52,8 +172,8 @@ char *lde_to_str(int a, int b, int c) {
     char op = (b < 0) ? '-' : '+';
     char *b_str = (abs(b) == 1) ? fstr("") : fstr("%d", abs(b));
     char *lde_str = fstr("%sx %c %sy = %d", a_str, op, b_str, c);
-    free(a_str);
-    free(b_str);
+    dio_free(a_str);
+    dio_free(b_str);
     return lde_str;
 }
 
@@ -62,8 +182,8 @@ char *lde_soln_to_str(int a, int b, int c, int x, int y) {
     char op = (b < 0) ? '-' : '+';
     char *b_str = (abs(b) == 1) ? fstr("") : fstr("%d", abs(b));
     char *lde_str = fstr("%s(%d) %c %s(%d) = %d", a_str, x, op, b_str, y, c);
-    free(a_str);
-    free(b_str);
+    dio_free(a_str);
+    dio_free(b_str);
     return lde_str;
 }
 
@@ -75,13 +195,46 @@ char *n_eq_to_str(int a, int b) {
     char op = (b < 0) ? '-' : '+';
     char *b_str = (abs(b) == 1) ? fstr("n") : fstr("%dn", abs(b));
     char *eq_str = fstr("%d %c %s", a, op, b_str);
-    free(b_str);
+    dio_free(b_str);
     return eq_str;
 }
 
-List result;
+char *soln_set_to_str(SolnSet set) {
+    if (!set.exist) {
+        return fstr("no solution");
+    }
+    if (set.plane) {
+        return fstr("x and y are any integers in their domains");
+    }
+
+    STAT_ENTER(STAT_RENDER);
+    TRACE_BEGIN("render");
+    char *x_eq = (set.dx == 0) ? fstr("%d", set.x0) : n_eq_to_str(set.x0, set.dx);
+    char *y_eq = (set.dy == 0) ? fstr("%d", set.y0) : n_eq_to_str(set.y0, set.dy);
+    char *n_intvl_str = interval_to_str(set.n_intvl);
+    char *set_str = fstr("x = %s, y = %s, n ∈ %s", x_eq, y_eq, n_intvl_str);
+    dio_free(x_eq);
+    dio_free(y_eq);
+    dio_free(n_intvl_str);
+    STAT_COUNT(STAT_BYTES, strlen(set_str));
+    TRACE_END();
+    STAT_LEAVE();
+    return set_str;
+}
+
+// Each thread has its own sink, so lde_steps() is thread-safe
+_Thread_local LineSink result_sink;
+_Thread_local void *result_ctx;
+_Thread_local bool result_cancelled;
+
 void append_result(char *str) {
-    list_append(result, str, char*);
+    if (result_cancelled) {
+        dio_free(str);
+        return;
+    }
+    STAT_COUNT(STAT_LINES, 1);
+    STAT_COUNT(STAT_BYTES, strlen(str));
+    result_cancelled = !result_sink(str, result_ctx);
 }
 
 void solve_lde_ab0(int c, Interval xi, Interval yi) {
@@ -92,11 +245,11 @@ void solve_lde_ab0(int c, Interval xi, Interval yi) {
 
     char *xi_str = interval_to_str(xi);
     append_result(fstr("x is any integer in the interval %s\n", xi_str));
-    free(xi_str);
+    dio_free(xi_str);
 
     char *yi_str = interval_to_str(yi);
     append_result(fstr("y is any integer in the interval %s\n", yi_str));
-    free(yi_str);
+    dio_free(yi_str);
 }
 
 void solve_lde_a0(int b, int c, Interval xi, Interval yi) {
@@ -108,7 +261,7 @@ void solve_lde_a0(int b, int c, Interval xi, Interval yi) {
 
     char *xi_str = interval_to_str(xi);
     append_result(fstr("x is any integer in the interval %s\n", xi_str));
-    free(xi_str);
+    dio_free(xi_str);
 
     int y = c / b;
     append_result(fstr("y = %d\n", y));
@@ -117,7 +270,7 @@ void solve_lde_a0(int b, int c, Interval xi, Interval yi) {
         char *yi_str = interval_to_str(yi);
         append_result(fstr("However, %d is not in the interval %s\n", y, yi_str));
         append_result(fstr("Therefore, the LDE has no solution.\n"));
-        free(yi_str);
+        dio_free(yi_str);
     }
 }
 
@@ -135,17 +288,17 @@ void solve_lde_b0(int a, int c, Interval xi, Interval yi) {
         char *xi_str = interval_to_str(xi);
         append_result(fstr("However, %d is not in the interval %s\n", x, xi_str));
         append_result(fstr("Therefore, the LDE has no solution.\n"));
-        free(xi_str);
+        dio_free(xi_str);
         return;
     }
 
     char *yi_str = interval_to_str(yi);
     append_result(fstr("y is any integer in the interval %s\n", yi_str));
-    free(yi_str);
+    dio_free(yi_str);
 }
 
-void solve_lde_in(int a, int b, int c, Interval xi, Interval yi) {
-    EEA_Table table = eea_table(a, b);
+void solve_lde_in(int a, int b, int c, Interval xi, Interval yi,
+                  EEA_Table table) {
     int d = eea_gcd_table(table);
 
     append_result(fstr("By the Extended Euclidean Algorithm (EEA):\n"));
@@ -159,7 +312,6 @@ void solve_lde_in(int a, int b, int c, Interval xi, Interval yi) {
     if (c % d != 0) {
         append_result(fstr("Since %d does not divide %d, ", d, c));
         append_result(fstr("the LDE has no solution.\n"));
-        list_free(table);
         return;
     }
 
@@ -170,7 +322,7 @@ void solve_lde_in(int a, int b, int c, Interval xi, Interval yi) {
     append_result(fstr("From the EEA Table:\n"));
     soln_str = lde_soln_to_str(a, b, d, part_soln.x, part_soln.y);
     append_result(fstr("\t%s\n", soln_str));
-    free(soln_str);
+    dio_free(soln_str);
 
     part_soln = eea_lde_table(make_lde(a, b, c), table);
     int x0 = part_soln.x;
@@ -178,8 +330,7 @@ void solve_lde_in(int a, int b, int c, Interval xi, Interval yi) {
     append_result(fstr("Thus:\n"));
     soln_str = lde_soln_to_str(a, b, c, x0, y0);
     append_result(fstr("\t%s\n\n", soln_str));
-    free(soln_str);
-    list_free(table);
+    dio_free(soln_str);
 
     append_result(fstr("A particular solution is:\n"));
     append_result(fstr("\tx₀ = %d\n", x0));
@@ -190,14 +341,14 @@ void solve_lde_in(int a, int b, int c, Interval xi, Interval yi) {
     char *y_eq = n_eq_to_str(y0, -a/d);
     append_result(fstr("\tx = %s\n", x_eq));
     append_result(fstr("\ty = %s\n", y_eq));
-    free(x_eq);
-    free(y_eq);
+    dio_free(x_eq);
+    dio_free(y_eq);
     
     Interval n_intvl = int_interval(solve_ineq_sys(x0, b/d, y0, -a/d, xi, yi));
     if (is_valid_interval(n_intvl)) {
         char *n_intvl_str = interval_to_str(n_intvl);
         append_result(fstr("Where:\n\tn ∈ %s\n", n_intvl_str));
-        free(n_intvl_str);
+        dio_free(n_intvl_str);
     } else {
         char *xi_str = interval_to_str(xi);
         char *yi_str = interval_to_str(yi);
@@ -205,38 +356,261 @@ void solve_lde_in(int a, int b, int c, Interval xi, Interval yi) {
         append_result(fstr("\tx ∈ %s\n", xi_str));
         append_result(fstr("\ty ∈ %s\n", yi_str));
         append_result(fstr("Therefore, the LDE has no solution.\n"));
-        free(xi_str);
-        free(yi_str);
+        dio_free(xi_str);
+        dio_free(yi_str);
     }
 }
 
-List lde_result(LDE lde) {
+bool lde_steps(LDE lde, LineSink sink, void *ctx) {
+    TRACE_BEGIN("solve");
+    EEA_Table table = make_list(NULL, 0);
+    if (lde.a != 0 && lde.b != 0) {
+        table = eea_table(lde.a, lde.b);
+    }
+    bool done = lde_steps_table(lde, table, sink, ctx);
+    list_free(table);
+    TRACE_END();
+    return done;
+}
+
+bool lde_steps_table(LDE lde, EEA_Table table, LineSink sink, void *ctx) {
     int a = lde.a;
     int b = lde.b;
     int c = lde.c;
     Interval xi = lde.xi;
     Interval yi = lde.yi;
 
-    result = list_init_empty();
+    result_sink = sink;
+    result_ctx = ctx;
+    result_cancelled = false;
+    STAT_COUNT(STAT_SOLVES, 1);
+    STAT_ENTER(STAT_RENDER);
+    TRACE_BEGIN("render");
     append_result(fstr("Solving the Linear Diophantine Equation (LDE):\n"));
-    append_result(fstr("\t%s\n", lde_to_str(a, b, c)));
+    char *lde_str = lde_to_str(a, b, c);
+    append_result(fstr("\t%s\n", lde_str));
+    dio_free(lde_str);
     append_result(fstr("Where:\n"));
     char *xi_str = interval_to_str(xi);
     char *yi_str = interval_to_str(yi);
     append_result(fstr("\tx ∈ %s\n", xi_str));
     append_result(fstr("\ty ∈ %s\n\n", yi_str));
-    free(xi_str);
-    free(yi_str);
-
-    if (a == 0 && b == 0) {
+    dio_free(xi_str);
+    dio_free(yi_str);
+
+    if (result_cancelled) {
+        TRACE_END();
+        STAT_LEAVE();
+        return false;
+    } else if (a == 0 && b == 0) {
         solve_lde_ab0(c, xi, yi);
     } else if (a == 0) {
         solve_lde_a0(b, c, xi, yi);
     } else if (b == 0) {
         solve_lde_b0(a, c, xi, yi);
     } else {
-        solve_lde_in(a, b, c, xi, yi);
+        solve_lde_in(a, b, c, xi, yi, table);
     }
 
+    TRACE_END();
+    STAT_LEAVE();
+    return !result_cancelled;
+}
+
+bool append_to_list(char *line, void *ctx) {
+    List *result = ctx;
+    list_append((*result), line, char*);
+    return true;
+}
+
+List lde_result(LDE lde) {
+    List result = list_init_empty();
+    lde_steps(lde, append_to_list, &result);
     return result;
 }
+
+void lde_result_free(List result) {
+    for (int i = 0; i < result.size; ++i) {
+        dio_free(list_at(result, i, char*));
+    }
+    list_free(result);
+}
+
+void test_lde_soln_set() {
+    assert(equal_soln_set(
+        lde_soln_set(make_lde_in(9, 5, 137, POS, POS)),
+        (SolnSet) {1, -137, 274, 5, -9,
+                   make_interval(28, 30, false, false), false, true}));
+
+    assert(equal_soln_set(
+        lde_soln_set(make_lde_in(-9, 5, 137, POS, POS)),
+        (SolnSet) {1, 137, 274, 5, 9,
+                   make_interval(-27, POS_INF, false, true), false, true}));
+
+    assert(equal_soln_set(
+        lde_soln_set(make_lde_in(10, 8, 100, NONNEG, NONNEG)),
+        (SolnSet) {2, 50, -50, 4, -5,
+                   make_interval(-12, -10, false, false), false, true}));
+
+    SolnSet set;
+    set = lde_soln_set(make_lde_in(-9, -5, 137, POS, POS));
+    assert(set.d == 1 && !set.exist);
+
+    set = lde_soln_set(make_lde_in(10, 8, 99, POS, POS));
+    assert(set.d == 2 && !set.exist);
+
+    assert(equal_soln_set(
+        lde_soln_set(make_lde_in(0, 5, 10, POS, POS)),
+        (SolnSet) {5, 0, 2, 1, 0,
+                   make_interval(1, POS_INF, false, true), false, true}));
+
+    assert(equal_soln_set(
+        lde_soln_set(make_lde_in(-5, 0, 10, NEG, NONPOS)),
+        (SolnSet) {5, -2, 0, 0, 1,
+                   make_interval(NEG_INF, 0, true, false), false, true}));
+
+    assert(!lde_soln_set(make_lde_in(-5, 0, 10, POS, NONPOS)).exist);
+    assert(!lde_soln_set(make_lde_in(0, 4, 14, NONPOS, POS)).exist);
+
+    set = lde_soln_set(make_lde_in(0, 0, 0, REAL, NONNEG));
+    assert(set.plane && set.exist);
+
+    set = lde_soln_set(make_lde_in(0, 0, 10, REAL, REAL));
+    assert(set.plane && !set.exist);
+}
+
+void test_soln_set_to_str() {
+    char *set_str;
+    set_str = soln_set_to_str(lde_soln_set(make_lde_in(9, 5, 137, POS, POS)));
+    assert(equal_str(set_str, "x = -137 + 5n, y = 274 - 9n, n ∈ [28,30]"));
+    dio_free(set_str);
+
+    set_str = soln_set_to_str(lde_soln_set(make_lde_in(0, 5, 10, POS, POS)));
+    assert(equal_str(set_str, "x = n, y = 2, n ∈ [1,inf)"));
+    dio_free(set_str);
+
+    set_str = soln_set_to_str(lde_soln_set(make_lde(10, 8, 99)));
+    assert(equal_str(set_str, "no solution"));
+    dio_free(set_str);
+
+    set_str = soln_set_to_str(lde_soln_set(make_lde(0, 0, 0)));
+    assert(equal_str(set_str, "x and y are any integers in their domains"));
+    dio_free(set_str);
+}
+
+bool count_lines(char *line, void *ctx) {
+    int *count = ctx;
+    dio_free(line);
+    return --*count > 0;
+}
+
+void test_lde_steps() {
+    LDE lde = make_lde_in(9, 5, 137, POS, POS);
+    List result = lde_result(lde);
+    assert(result.size > 5);
+    assert(equal_str(list_at(result, 0, char*),
+                     "Solving the Linear Diophantine Equation (LDE):\n"));
+
+    // Every line reaches the sink, in order
+    int count = result.size + 1;
+    assert(lde_steps(lde, count_lines, &count));
+    assert(count == 1);
+
+    // The sink cancels after 3 lines
+    count = 3;
+    assert(!lde_steps(lde, count_lines, &count));
+    assert(count == 0);
+
+    // Reusing the table of (a, b) gives the same steps for any c
+    EEA_Table table = eea_table(9, 5);
+    List reused = list_init_empty();
+    assert(lde_steps_table(lde, table, append_to_list, &reused));
+    assert(reused.size == result.size);
+    for (int i = 0; i < result.size; ++i) {
+        assert(equal_str(list_at(reused, i, char*), list_at(result, i, char*)));
+    }
+    lde_result_free(reused);
+    list_free(table);
+
+    lde_result_free(result);
+}
+
+void test_prepared_soln_set() {
+    int coeffs[][2] = {
+        {9, 5}, {-9, 5}, {1386, 322}, {10, 8}, {0, 5}, {-5, 0}, {0, 0},
+        {2147483646, 1000000007},
+    };
+    Interval domains[] = {
+        REAL, POS, NEG, NONNEG, make_interval(-5, 3.5, true, false),
+    };
+    int cs[201];
+    for (int i = 0; i < 201; ++i) {
+        cs[i] = i - 100;
+    }
+    SolnSet sets[201];
+
+    // Every right-hand side gives the same particular solution and n-interval
+    // as solving from scratch
+    for (size_t i = 0; i < sizeof(coeffs) / sizeof(coeffs[0]); ++i) {
+        int a = coeffs[i][0];
+        int b = coeffs[i][1];
+        PreparedLDE prep = prepare_lde(a, b);
+        for (int j = 0; j < 25; ++j) {
+            Interval xi = domains[j % 5];
+            Interval yi = domains[j / 5];
+            prepared_soln_sets(&prep, cs, 201, xi, yi, sets);
+            for (int k = 0; k < 201; ++k) {
+                LDE lde = make_lde_in(a, b, cs[k], xi, yi);
+                Solution soln = (a != 0 && b != 0) ? eea_lde(lde) : NO_SOLN;
+                if (soln.exist) {
+                    assert(sets[k].x0 == soln.x && sets[k].y0 == soln.y);
+                    assert(equal_interval(sets[k].n_intvl, int_interval(
+                        solve_ineq_sys(soln.x, sets[k].dx, soln.y, sets[k].dy,
+                                       xi, yi))));
+                } else if (a != 0 && b != 0) {
+                    assert(!sets[k].exist);
+                }
+                assert(equal_soln_set(prepared_soln_set(&prep, cs[k], xi, yi),
+                                      sets[k]));
+                // The particular solution satisfies the LDE, in 64 bits since
+                // a * x0 may exceed the range of int
+                if (sets[k].exist && !sets[k].plane) {
+                    assert((long long) a * sets[k].x0 +
+                           (long long) b * sets[k].y0 == cs[k]);
+                }
+            }
+        }
+    }
+
+    // Where x1 * (c / d) exceeds the range of int, the particular solution
+    // is moved along the line, in both lde_soln_set() and eea_lde()
+    int big_cs[] = {1000000000, -1000000000, POS_INF, NEG_INF, 999999999};
+    int big_coeffs[][2] = {
+        {7, 5}, {-9, 5}, {1386, -322}, {2147483646, 1000000007},
+        {POS_INF, 2}, {3, NEG_INF}, {65536, 65537},
+    };
+    for (size_t i = 0; i < sizeof(big_coeffs) / sizeof(big_coeffs[0]); ++i) {
+        int a = big_coeffs[i][0];
+        int b = big_coeffs[i][1];
+        PreparedLDE prep = prepare_lde(a, b);
+        for (size_t j = 0; j < sizeof(big_cs) / sizeof(big_cs[0]); ++j) {
+            int c = big_cs[j];
+            SolnSet set = prepared_soln_set(&prep, c, REAL, REAL);
+            Solution soln = eea_lde(make_lde(a, b, c));
+            assert(set.exist == (c % prep.d == 0) && soln.exist == set.exist);
+            if (set.exist) {
+                assert((long long) a * set.x0 + (long long) b * set.y0 == c);
+                assert(soln.x == set.x0 && soln.y == set.y0);
+            }
+        }
+    }
+    SolnSet set = lde_soln_set(make_lde(7, 5, 1000000000));
+    assert(7LL * set.x0 + 5LL * set.y0 == 1000000000);
+}
+
+void test_lde_h() {
+    test_lde_soln_set();
+    test_prepared_soln_set();
+    test_soln_set_to_str();
+    test_lde_steps();
+}
@@ -15,6 +15,9 @@ extern "C" {
 // Represents no solution for an LDE with the field "exist" set to false
 #define NO_SOLN (Solution) {0, 0, false}
 
+// Represents an empty solution set with the field "exist" set to false
+#define NO_SOLN_SET (SolnSet) {0, 0, 0, 0, 0, INVALID_INTVL, false, false}
+
 // Maximum number of results for LDE solutions
 #define MAX_RESULT 10
 
@@ -96,6 +99,157 @@ Solution eea_lde_table(LDE lde, EEA_Table table);
  */
 Solution eea_lde_row(LDE lde, EEAR row);
 
+/**
+ * Produces a particular solution to ax + by = c from a solution (x1, y1) of
+ * ax + by = d, where a ≠ 0, b ≠ 0 and d = gcd(a, b) divides c. The solution
+ * is x1 * (c / d) and y1 * (c / d) if both fit in an int; otherwise x is
+ * moved along the solution line to the value nearest 0, where both fit.
+ * 
+ * @param a Coefficient of x.
+ * @param b Coefficient of y.
+ * @param c Constant term.
+ * @param d GCD of a and b.
+ * @param x1 x value of the solution of ax + by = d.
+ * @param y1 y value of the solution of ax + by = d.
+ * @return A particular solution to ax + by = c.
+ */
+Solution scale_unit_soln(int a, int b, int c, int d, int x1, int y1);
+
+/**
+ * Represents the complete solution set of an LDE in parametric form:
+ *   x = x0 + dx * n
+ *   y = y0 + dy * n
+ * where n is any integer in n_intvl.
+ * 
+ * If a = b = 0 and c = 0, x and y are independent of each other, so any
+ * integer x in the domain of x and y in the domain of y forms a solution.
+ * This case is marked by the field "plane". The domains themselves are not
+ * kept, so functions that handle a plane take them alongside the set.
+ */
+typedef struct SolnSet {
+    int d;              // GCD of a and b
+    int x0;             // x value of the particular solution
+    int y0;             // y value of the particular solution
+    int dx;             // Change in x as n increases by 1
+    int dy;             // Change in y as n increases by 1
+    Interval n_intvl;   // Integer interval of n
+
+    bool plane;         // True if a = b = c = 0
+    bool exist;         // True if a solution exists
+} SolnSet;
+
+/**
+ * Produces the complete solution set of the LDE within interval constraints.
+ * Unlike lde_result(), no text is generated.
+ * 
+ * @param lde The LDE to be solved.
+ * @return The complete solution set of the LDE.
+ */
+SolnSet lde_soln_set(LDE lde);
+
+/**
+ * An LDE with fixed coefficients a and b, prepared once so that it can be
+ * solved for any c and domains without rerunning the EEA.
+ */
+typedef struct PreparedLDE {
+    int a;
+    int b;
+    int d;      // gcd(a, b), or 0 if a = b = 0
+    int x1;     // A solution of ax + by = d, if a ≠ 0 and b ≠ 0
+    int y1;
+    int dx;     // Coefficients of n in the complete solution
+    int dy;
+} PreparedLDE;
+
+/**
+ * Runs the EEA on a and b once, for use with prepared_soln_set().
+ * 
+ * @param a The coefficient of x.
+ * @param b The coefficient of y.
+ * @return The prepared LDE.
+ */
+PreparedLDE prepare_lde(int a, int b);
+
+/**
+ * Produces the complete solution set of ax + by = c in constant time,
+ * where a and b are those of a prepared LDE.
+ * 
+ * @param prep The prepared LDE.
+ * @param c The constant term.
+ * @param xi The domain of x.
+ * @param yi The domain of y.
+ * @return The same solution set as lde_soln_set().
+ */
+SolnSet prepared_soln_set(const PreparedLDE *prep, int c,
+                          Interval xi, Interval yi);
+
+/**
+ * Produces the solution sets for many constant terms in one loop,
+ * without any allocation.
+ * 
+ * @param prep The prepared LDE.
+ * @param cs The constant terms.
+ * @param n Number of constant terms.
+ * @param xi The domain of x.
+ * @param yi The domain of y.
+ * @param sets Receives the solution set for each constant term.
+ */
+void prepared_soln_sets(const PreparedLDE *prep, const int *cs, int n,
+                        Interval xi, Interval yi, SolnSet *sets);
+
+/**
+ * Checks if two SolnSet structures are equal.
+ * 
+ * @param s1 The first SolnSet.
+ * @param s2 The second SolnSet.
+ * @return true if s1 and s2 are equal, false otherwise.
+ */
+bool equal_soln_set(SolnSet s1, SolnSet s2);
+
+/**
+ * Converts a solution set to a one-line summary, such as
+ * "x = -137 + 5n, y = 274 - 9n, n ∈ [28,30]".
+ * 
+ * @param set The solution set to convert.
+ * @return A dynamically allocated string representing set.
+ *         Make sure to call dio_free() after usage.
+ */
+char *soln_set_to_str(SolnSet set);
+
+/**
+ * Receives one line of the steps produced by lde_steps().
+ * 
+ * @param line A dynamically allocated line, owned by the sink from now on.
+ * @param ctx The context passed to lde_steps().
+ * @return true to receive further lines, false to cancel the steps.
+ */
+typedef bool (*LineSink)(char *line, void *ctx);
+
+/**
+ * Produces detailed steps to find all solutions to the LDE 
+ * within interval constraints, passing each line to a sink as soon as
+ * it is ready.
+ * 
+ * @param lde The LDE to be solved.
+ * @param sink Receives each line in the steps.
+ * @param ctx Passed to every call of sink.
+ * @return true if all steps were produced, false if the sink cancelled.
+ */
+bool lde_steps(LDE lde, LineSink sink, void *ctx);
+
+/**
+ * Same as lde_steps(), but reuses the EEA table of a and b, so that
+ * LDEs differing only in c or the domains skip the EEA.
+ * 
+ * @param lde The LDE to be solved.
+ * @param table The result of eea_table(lde.a, lde.b), which is not freed.
+ *              Ignored if lde.a or lde.b is 0.
+ * @param sink Receives each line in the steps.
+ * @param ctx Passed to every call of sink.
+ * @return true if all steps were produced, false if the sink cancelled.
+ */
+bool lde_steps_table(LDE lde, EEA_Table table, LineSink sink, void *ctx);
+
 /**
  * Produces detailed steps to find all solutions to the LDE 
  * within interval constraints.
@@ -105,6 +259,18 @@ Solution eea_lde_row(LDE lde, EEAR row);
  */
 List lde_result(LDE lde);
 
+/**
+ * Frees every line in the result of lde_result() and the list itself.
+ * 
+ * @param result The result to free.
+ */
+void lde_result_free(List result);
+
+/**
+ * Runs unit tests for functions in "lde.h".
+ */
+void test_lde_h();
+
 #ifdef __cplusplus
 }
 #endif
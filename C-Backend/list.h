@@ -5,15 +5,17 @@
 #ifndef LIST_H
 #define LIST_H
 
+#include "memstat.h"
+
 #include <stdlib.h>
 
 /** Initializes an empty list. */
 #define list_init_empty() \
-    make_list(malloc(0), 0)
+    make_list(dio_malloc(0), 0)
 
 /** Initializes a list of a specific size. */
 #define list_init_size(size, type) \
-    make_list(malloc(size * sizeof(type)), size)
+    make_list(dio_malloc(size * sizeof(type)), size)
 
 /** Accesses an element in the list at a specific index. */
 #define list_at(lst, index, type) \
@@ -25,12 +27,12 @@
 
 /** Appends an element to the list. */
 #define list_append(lst, x, type) \
-    lst.arr = (type*) realloc(lst.arr, (lst.size + 1) * sizeof(type)); \
+    lst.arr = (type*) dio_realloc(lst.arr, (lst.size + 1) * sizeof(type)); \
     ((type*) lst.arr)[lst.size++] = x
 
 /** Free a list from the memory. */
 #define list_free(lst) \
-    free(lst.arr); \
+    dio_free(lst.arr); \
     lst.size = 0;
 
 /**
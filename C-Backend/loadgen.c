@@ -0,0 +1,398 @@
+/**
+ * Load-generating client for the solve server.
+ *
+ * Usage: loadgen [--unix PATH | --tcp HOST:PORT | --shm NAME] [--conns C]
+ *                [--depth D] [--requests N] [--seed S] [--corpus FILE]
+ *
+ * Opens C connections, one per thread, and sends N requests over each,
+ * keeping up to D requests in flight (pipelined) per connection. With --shm,
+ * each thread maps the shared-memory ring of the server instead, and keeps
+ * up to D LDEs in flight through it. Requests
+ * are random 32-bit LDEs over a mix of domains, or the LDEs of a corpus file
+ * written by "corpusgen", which each thread sends in turn from its own
+ * offset. Reports throughput and the
+ * latency percentiles of every request, measured from the send of the
+ * request to the receipt of its response line.
+ */
+
+#include "betterc.h"
+#include "corpus.h"
+#include "intvl.h"
+#include "sample.h"
+#include "shmring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Maximum number of requests in flight per connection
+#define MAX_DEPTH 1024
+
+const char *domains[] = {"real", "pos", "nonneg", "[-1000,1000]", "(0,inf)"};
+
+/**
+ * Settings shared by every client thread.
+ */
+typedef struct Options {
+    const char *unix_path;
+    const char *tcp_spec;
+    const char *shm_name;
+    int conns;
+    int depth;
+    long requests;
+    uint64_t seed;
+    Corpus corpus;          // LDEs to send, if "valid" is set
+} Options;
+
+/**
+ * State of one client thread.
+ */
+typedef struct Client {
+    const Options *opts;
+    uint64_t rng;
+    long next;              // Index of the next LDE of the corpus
+    double *latencies;      // Latency of each request in nanoseconds
+    long errors;            // Number of "E" responses
+    bool failed;            // True if the connection failed
+} Client;
+
+double clock_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int connect_server(const Options *opts) {
+    if (opts->unix_path) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", opts->unix_path);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    char host[256] = "127.0.0.1";
+    const char *port = opts->tcp_spec;
+    const char *colon = strrchr(opts->tcp_spec, ':');
+    if (colon) {
+        snprintf(host, sizeof(host), "%.*s",
+                 (int) (colon - opts->tcp_spec), opts->tcp_spec);
+        port = colon + 1;
+    }
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &res)) {
+        return -1;
+    }
+    int fd = socket(res->ai_family, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+/**
+ * Produces a random request.
+ *
+ * @param coeffs Receives a, b and c.
+ * @param x Receives the domain of x.
+ * @param y Receives the domain of y.
+ */
+void random_request(uint64_t *rng, int coeffs[3], const char **x,
+                    const char **y) {
+    int num_domains = sizeof(domains) / sizeof(domains[0]);
+    for (int i = 0; i < 3; ++i) {
+        coeffs[i] = (int) xorshift_next(rng);
+        // Keep within [NEG_INF, POS_INF], which excludes INT_MIN
+        coeffs[i] += (coeffs[i] == -__INT_MAX__ - 1);
+    }
+    *x = domains[xorshift_next(rng) % num_domains];
+    *y = domains[xorshift_next(rng) % num_domains];
+}
+
+/**
+ * Takes the next LDE of the corpus, wrapping around at its end.
+ */
+LDE next_corpus_lde(Client *client) {
+    const Corpus *corpus = &client->opts->corpus;
+    LDE lde = corpus->ldes[client->next];
+    client->next = (client->next + 1) % corpus->size;
+    return lde;
+}
+
+/**
+ * Appends a random request, or the next request of the corpus, to buf.
+ *
+ * @return The length of the request.
+ */
+int make_request(Client *client, char *buf, size_t size) {
+    if (client->opts->corpus.valid) {
+        return corpus_request(next_corpus_lde(client), buf, size);
+    }
+
+    int coeffs[3];
+    const char *x, *y;
+    random_request(&client->rng, coeffs, &x, &y);
+    return snprintf(buf, size, "%d %d %d %s %s\n",
+                    coeffs[0], coeffs[1], coeffs[2], x, y);
+}
+
+/**
+ * Produces a random LDE, as parsed by the server from make_request().
+ */
+LDE make_request_lde(Client *client) {
+    if (client->opts->corpus.valid) {
+        return next_corpus_lde(client);
+    }
+
+    int coeffs[3];
+    const char *x, *y;
+    random_request(&client->rng, coeffs, &x, &y);
+    return make_lde_in(coeffs[0], coeffs[1], coeffs[2],
+                       str_to_interval(x), str_to_interval(y));
+}
+
+void *run_shm_client(void *arg) {
+    Client *client = arg;
+    const Options *opts = client->opts;
+
+    ShmRing ring = shmring_open(opts->shm_name);
+    if (!ring.valid) {
+        perror(opts->shm_name);
+        client->failed = true;
+        return NULL;
+    }
+
+    double sent_at[MAX_DEPTH];
+    uint32_t tickets[MAX_DEPTH];
+    long sent = 0;
+    long received = 0;
+
+    LDE lde = make_request_lde(client);
+
+    while (received < opts->requests) {
+        while (sent < opts->requests && sent - received < opts->depth) {
+            sent_at[sent % MAX_DEPTH] = clock_ns();
+            if (!shmring_try_submit(&ring, lde, &tickets[sent % MAX_DEPTH])) {
+                break;
+            }
+            lde = make_request_lde(client);
+            ++sent;
+        }
+        if (sent == received) {
+            // The ring is full of other threads' requests
+            sched_yield();
+            continue;
+        }
+
+        shmring_wait(&ring, tickets[received % MAX_DEPTH]);
+        client->latencies[received] = clock_ns() - sent_at[received % MAX_DEPTH];
+        ++received;
+    }
+
+    shmring_close(&ring);
+    return NULL;
+}
+
+void *run_client(void *arg) {
+    Client *client = arg;
+    const Options *opts = client->opts;
+
+    int fd = connect_server(opts);
+    if (fd < 0) {
+        perror("connect");
+        client->failed = true;
+        return NULL;
+    }
+
+    double sent_at[MAX_DEPTH];
+    char out[MAX_DEPTH * CORPUS_MAX_REQUEST];
+    char in[65536];
+    size_t in_len = 0;
+    long sent = 0;
+    long received = 0;
+
+    while (received < opts->requests) {
+        // Fill the pipeline up to the configured depth
+        size_t out_len = 0;
+        double now = clock_ns();
+        while (sent < opts->requests && sent - received < opts->depth) {
+            out_len += make_request(client, out + out_len,
+                                    sizeof(out) - out_len);
+            sent_at[sent % MAX_DEPTH] = now;
+            ++sent;
+        }
+        for (size_t done = 0; done < out_len;) {
+            ssize_t n = send(fd, out + done, out_len - done, MSG_NOSIGNAL);
+            if (n <= 0) {
+                client->failed = true;
+                close(fd);
+                return NULL;
+            }
+            done += n;
+        }
+
+        // Wait for at least one response
+        ssize_t n = recv(fd, in + in_len, sizeof(in) - in_len, 0);
+        if (n <= 0) {
+            client->failed = true;
+            close(fd);
+            return NULL;
+        }
+        now = clock_ns();
+        in_len += n;
+
+        char *line = in;
+        char *end = in + in_len;
+        char *newline;
+        while ((newline = memchr(line, '\n', end - line))) {
+            client->errors += (line[0] == 'E');
+            client->latencies[received] = now - sent_at[received % MAX_DEPTH];
+            ++received;
+            line = newline + 1;
+        }
+        in_len = end - line;
+        memmove(in, line, in_len);
+    }
+
+    close(fd);
+    return NULL;
+}
+
+int compare_double(const void *a, const void *b) {
+    double x = *(const double*) a;
+    double y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+double percentile(const double *sorted, long size, double p) {
+    long i = (long) (p * (size - 1) + 0.5);
+    return sorted[i];
+}
+
+int main(int argc, char *argv[]) {
+    Options opts = {NULL, NULL, NULL, 4, 16, 100000, 42, {0}};
+    const char *corpus_path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (equal_str(arg, "--unix") && has_value) {
+            opts.unix_path = argv[++i];
+        } else if (equal_str(arg, "--tcp") && has_value) {
+            opts.tcp_spec = argv[++i];
+        } else if (equal_str(arg, "--shm") && has_value) {
+            opts.shm_name = argv[++i];
+        } else if (equal_str(arg, "--conns") && has_value) {
+            opts.conns = atoi(argv[++i]);
+        } else if (equal_str(arg, "--depth") && has_value) {
+            opts.depth = atoi(argv[++i]);
+        } else if (equal_str(arg, "--requests") && has_value) {
+            opts.requests = atol(argv[++i]);
+        } else if (equal_str(arg, "--seed") && has_value) {
+            opts.seed = strtoull(argv[++i], NULL, 10);
+        } else if (equal_str(arg, "--corpus") && has_value) {
+            corpus_path = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--unix PATH | --tcp HOST:PORT | "
+                            "--shm NAME] [--conns C] [--depth D] [--requests N] "
+                            "[--seed S] [--corpus FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!opts.unix_path && !opts.tcp_spec && !opts.shm_name) {
+        opts.unix_path = "/tmp/diosolver.sock";
+    }
+    if (opts.conns < 1 || opts.depth < 1 || opts.depth > MAX_DEPTH ||
+        opts.requests < 1) {
+        fprintf(stderr, "%s: --conns, --requests and --depth must be positive, "
+                        "and --depth at most %d\n", argv[0], MAX_DEPTH);
+        return 2;
+    }
+
+    if (corpus_path) {
+        FILE *in = fopen(corpus_path, "rb");
+        if (!in) {
+            perror(corpus_path);
+            return 1;
+        }
+        opts.corpus = corpus_read(in);
+        fclose(in);
+        if (!opts.corpus.valid || opts.corpus.size == 0) {
+            fprintf(stderr, "%s: %s is not a corpus, or empty\n",
+                    argv[0], corpus_path);
+            return 1;
+        }
+    }
+
+    Client *clients = calloc(opts.conns, sizeof(Client));
+    pthread_t *threads = malloc(opts.conns * sizeof(pthread_t));
+    double *latencies = malloc(opts.conns * opts.requests * sizeof(double));
+
+    double start = clock_ns();
+    for (int i = 0; i < opts.conns; ++i) {
+        clients[i].opts = &opts;
+        clients[i].rng = opts.seed * 0x9E3779B97F4A7C15ULL + i + 1;
+        clients[i].next = (long) i * opts.corpus.size / opts.conns;
+        clients[i].latencies = latencies + i * opts.requests;
+        pthread_create(&threads[i], NULL,
+                       opts.shm_name ? run_shm_client : run_client, &clients[i]);
+    }
+    long errors = 0;
+    bool failed = false;
+    for (int i = 0; i < opts.conns; ++i) {
+        pthread_join(threads[i], NULL);
+        errors += clients[i].errors;
+        failed |= clients[i].failed;
+    }
+    double elapsed = clock_ns() - start;
+
+    if (failed) {
+        fprintf(stderr, "%s: a connection to the server failed\n", argv[0]);
+        return 1;
+    }
+
+    long total = opts.conns * opts.requests;
+    qsort(latencies, total, sizeof(double), compare_double);
+    printf("requests   %ld (%ld errors)\n", total, errors);
+    printf("conns      %d, depth %d\n", opts.conns, opts.depth);
+    printf("throughput %.0f req/s\n", total / (elapsed / 1e9));
+    printf("latency    p50 %.1f us, p90 %.1f us, p99 %.1f us, "
+           "p99.9 %.1f us, max %.1f us\n",
+           percentile(latencies, total, 0.50) / 1e3,
+           percentile(latencies, total, 0.90) / 1e3,
+           percentile(latencies, total, 0.99) / 1e3,
+           percentile(latencies, total, 0.999) / 1e3,
+           latencies[total - 1] / 1e3);
+
+    free(latencies);
+    free(threads);
+    free(clients);
+    corpus_free(&opts.corpus);
+    return 0;
+}
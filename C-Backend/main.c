@@ -3,6 +3,7 @@
 #include "intvl.h"
 #include "ineq.h"
 #include "lde.h"
+#include "memstat.h"
 
 #include <stdio.h>
 #include <ctype.h>
@@ -45,7 +46,7 @@ Interval ask_intvl(char var) {
 
     char *intvl_str = interval_to_str(intvl);
     printf("\n%s is not a valid interval!\n", intvl_str);
-    free(intvl_str);
+    dio_free(intvl_str);
     return ask_intvl(var);
 }
 
@@ -86,20 +87,13 @@ Interval select_domain(char var) {
 void solve_lde(int a, int b, int c, Interval xi, Interval yi) {
     List result = lde_result(make_lde_in(a, b, c, xi, yi));
     for (int i = 0; i < result.size; ++i) {
-        char *line = list_at(result, i, char*);
-        printf("%s", line);
-        free(line);
+        printf("%s", list_at(result, i, char*));
     }
-    list_free(result);
+    lde_result_free(result);
 }
 
 
 int main() {
-    test_betterc_h();
-    test_eea_h();
-    test_intvl_h();
-    test_ineq_h();
-
     // --- Tests ---
     // clear_screen();
     // solve_lde(0, 0, 0, REAL, NONNEG);
@@ -0,0 +1,416 @@
+#include "memstat.h"
+#include "betterc.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <assert.h>
+
+// Initial number of entries in the block table, a power of 2
+#define BLOCK_TABLE_MIN 1024
+
+/**
+ * Represents a recorded block. ptr is NULL in empty entries.
+ */
+typedef struct Block {
+    void *ptr;          // Start of the block
+    size_t size;        // Size of the block in bytes
+    const char *file;   // Source file that allocated the block
+    int line;           // Line that allocated the block
+} Block;
+
+// Live blocks by address (open addressing with linear probing), and the
+// counters of the process, both guarded by memstat_lock
+pthread_mutex_t memstat_lock = PTHREAD_MUTEX_INITIALIZER;
+Block *blocks;
+size_t blocks_cap;
+size_t blocks_used;
+MemStat total_stat;
+
+_Thread_local MemStat thread_stat;
+
+size_t block_slot(void *ptr) {
+    uint64_t h = (uint64_t) (uintptr_t) ptr * 0x9E3779B97F4A7C15ull;
+    return (h >> 32) & (blocks_cap - 1);
+}
+
+bool insert_block(Block block, Block *stale);
+
+bool grow_blocks() {
+    size_t old_cap = blocks_cap;
+    Block *old = blocks;
+    size_t cap = old_cap ? old_cap * 2 : BLOCK_TABLE_MIN;
+    Block *table = calloc(cap, sizeof(Block));
+    if (!table) {
+        return false;
+    }
+
+    blocks = table;
+    blocks_cap = cap;
+    blocks_used = 0;
+    for (size_t i = 0; i < old_cap; ++i) {
+        if (old[i].ptr) {
+            insert_block(old[i], NULL);
+        }
+    }
+    free(old);
+    return true;
+}
+
+/**
+ * Inserts a block into the table. An entry at the same address belongs to
+ * a block that was released with free() instead of dio_free(), and is
+ * replaced.
+ *
+ * @param block The block.
+ * @param stale Receives the replaced entry, if not NULL.
+ * @return true if an entry was replaced, false otherwise.
+ */
+bool insert_block(Block block, Block *stale) {
+    // Keep the table at most half full, so that probes stay short
+    if ((blocks_used + 1) * 2 > blocks_cap && !grow_blocks()) {
+        return false;
+    }
+    size_t i = block_slot(block.ptr);
+    while (blocks[i].ptr) {
+        if (blocks[i].ptr == block.ptr) {
+            if (stale) {
+                *stale = blocks[i];
+            }
+            blocks[i] = block;
+            return true;
+        }
+        i = (i + 1) & (blocks_cap - 1);
+    }
+    blocks[i] = block;
+    ++blocks_used;
+    return false;
+}
+
+/**
+ * Removes a block from the table.
+ *
+ * @param ptr Start of the block.
+ * @param block Receives the removed block.
+ * @return true if the block was recorded, false otherwise.
+ */
+bool remove_block(void *ptr, Block *block) {
+    if (!blocks_cap) {
+        return false;
+    }
+    size_t i = block_slot(ptr);
+    while (blocks[i].ptr != ptr) {
+        if (!blocks[i].ptr) {
+            return false;
+        }
+        i = (i + 1) & (blocks_cap - 1);
+    }
+    *block = blocks[i];
+
+    // Shift later entries of the same probe sequence back into the gap
+    size_t gap = i;
+    for (size_t j = (i + 1) & (blocks_cap - 1); blocks[j].ptr;
+         j = (j + 1) & (blocks_cap - 1)) {
+        size_t home = block_slot(blocks[j].ptr);
+        if (((j - home) & (blocks_cap - 1)) >= ((j - gap) & (blocks_cap - 1))) {
+            blocks[gap] = blocks[j];
+            gap = j;
+        }
+    }
+    blocks[gap].ptr = NULL;
+    --blocks_used;
+    return true;
+}
+
+void count_alloc(MemStat *stat, size_t size) {
+    ++stat->allocs;
+    stat->bytes += size;
+    ++stat->live_blocks;
+    stat->live_bytes += size;
+    if (stat->live_bytes > stat->peak_bytes) {
+        stat->peak_bytes = stat->live_bytes;
+    }
+}
+
+void count_free(MemStat *stat, size_t size) {
+    ++stat->frees;
+    --stat->live_blocks;
+    stat->live_bytes -= size;
+}
+
+/**
+ * Records an allocated block, or a block that replaced an old one.
+ */
+void record_block(const Block *old, void *ptr, size_t size,
+                  const char *file, int line) {
+    pthread_mutex_lock(&memstat_lock);
+    if (old) {
+        count_free(&total_stat, old->size);
+        count_free(&thread_stat, old->size);
+        --total_stat.frees;
+        --thread_stat.frees;
+    }
+    Block stale;
+    if (insert_block((Block) {ptr, size, file, line}, &stale)) {
+        count_free(&total_stat, stale.size);
+        count_free(&thread_stat, stale.size);
+    }
+    count_alloc(&total_stat, size);
+    count_alloc(&thread_stat, size);
+    pthread_mutex_unlock(&memstat_lock);
+}
+
+bool memstat_enabled() {
+#ifdef DIO_MEMSTAT
+    return true;
+#else
+    return false;
+#endif
+}
+
+void *memstat_malloc(size_t size, const char *file, int line) {
+    void *ptr = malloc(size);
+    if (ptr) {
+        record_block(NULL, ptr, size, file, line);
+    }
+    return ptr;
+}
+
+void *memstat_calloc(size_t num, size_t size, const char *file, int line) {
+    void *ptr = calloc(num, size);
+    if (ptr) {
+        record_block(NULL, ptr, num * size, file, line);
+    }
+    return ptr;
+}
+
+void *memstat_realloc(void *ptr, size_t size, const char *file, int line) {
+    if (!size) {
+        memstat_free(ptr);
+        return NULL;
+    }
+
+    // Forget the old block first, as another thread may reuse its address
+    // as soon as realloc() has released it
+    Block old;
+    pthread_mutex_lock(&memstat_lock);
+    bool recorded = ptr && remove_block(ptr, &old);
+    pthread_mutex_unlock(&memstat_lock);
+
+    void *new_ptr = realloc(ptr, size);
+    if (new_ptr) {
+        record_block(recorded ? &old : NULL, new_ptr, size, file, line);
+    } else if (recorded) {
+        // The old block remains valid
+        pthread_mutex_lock(&memstat_lock);
+        insert_block(old, NULL);
+        pthread_mutex_unlock(&memstat_lock);
+    }
+    return new_ptr;
+}
+
+void memstat_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    pthread_mutex_lock(&memstat_lock);
+    Block block;
+    if (remove_block(ptr, &block)) {
+        count_free(&total_stat, block.size);
+        count_free(&thread_stat, block.size);
+    }
+    pthread_mutex_unlock(&memstat_lock);
+    free(ptr);
+}
+
+MemStat memstat_thread() {
+    return thread_stat;
+}
+
+MemStat memstat_total() {
+    pthread_mutex_lock(&memstat_lock);
+    MemStat stat = total_stat;
+    pthread_mutex_unlock(&memstat_lock);
+    return stat;
+}
+
+MemStat memstat_begin() {
+    // The mark keeps the peak of the enclosing measurement, which is
+    // restored by memstat_end()
+    MemStat mark = thread_stat;
+    thread_stat.peak_bytes = thread_stat.live_bytes;
+    return mark;
+}
+
+MemStat memstat_end(MemStat mark) {
+    MemStat now = thread_stat;
+    if (mark.peak_bytes > thread_stat.peak_bytes) {
+        thread_stat.peak_bytes = mark.peak_bytes;
+    }
+    return (MemStat) {
+        now.allocs - mark.allocs,
+        now.frees - mark.frees,
+        now.bytes - mark.bytes,
+        now.live_blocks - mark.live_blocks,
+        now.live_bytes - mark.live_bytes,
+        now.peak_bytes - mark.live_bytes,
+    };
+}
+
+char *memstat_to_str(MemStat stat) {
+    return fstr("%lld allocs, %lld frees, %lld bytes, peak %lld bytes, "
+                "%lld live", stat.allocs, stat.frees, stat.bytes,
+                stat.peak_bytes, stat.live_blocks);
+}
+
+int compare_block_sites(const void *p1, const void *p2) {
+    const Block *b1 = p1;
+    const Block *b2 = p2;
+    int cmp = strcmp(b1->file, b2->file);
+    return cmp ? cmp : (b1->line > b2->line) - (b1->line < b2->line);
+}
+
+long long memstat_report(FILE *out) {
+    pthread_mutex_lock(&memstat_lock);
+    size_t n = 0;
+    Block *live = malloc((blocks_used ? blocks_used : 1) * sizeof(Block));
+    for (size_t i = 0; live && i < blocks_cap; ++i) {
+        if (blocks[i].ptr) {
+            live[n++] = blocks[i];
+        }
+    }
+    MemStat stat = total_stat;
+    pthread_mutex_unlock(&memstat_lock);
+
+    if (!live) {
+        return stat.live_blocks;
+    }
+    if (n) {
+        fprintf(out, "memstat: %zu block(s) still allocated:\n", n);
+    }
+
+    // Group the blocks by the line that allocated them
+    qsort(live, n, sizeof(Block), compare_block_sites);
+    for (size_t i = 0; i < n;) {
+        size_t j = i;
+        size_t bytes = 0;
+        while (j < n && !compare_block_sites(&live[i], &live[j])) {
+            bytes += live[j++].size;
+        }
+        fprintf(out, "  %s:%d: %zu block(s), %zu byte(s)\n",
+                live[i].file, live[i].line, j - i, bytes);
+        i = j;
+    }
+    free(live);
+    return n;
+}
+
+#ifdef DIO_MEMSTAT
+void report_at_exit() {
+    memstat_report(stderr);
+}
+
+__attribute__((constructor))
+void register_report_at_exit() {
+    atexit(report_at_exit);
+}
+#endif
+
+void test_memstat_alloc() {
+    MemStat mark = memstat_begin();
+    char *str = memstat_malloc(10, __FILE__, __LINE__);
+    int *arr = memstat_calloc(4, sizeof(int), __FILE__, __LINE__);
+    assert(arr[0] == 0 && arr[3] == 0);
+    str = memstat_realloc(str, 100, __FILE__, __LINE__);
+    memstat_free(arr);
+
+    MemStat stat = memstat_end(mark);
+    assert(stat.allocs == 3);
+    assert(stat.frees == 1);
+    assert(stat.bytes == 10 + 16 + 100);
+    assert(stat.live_blocks == 1);
+    assert(stat.live_bytes == 100);
+    assert(stat.peak_bytes == 116);
+
+    memstat_free(str);
+    stat = memstat_end(mark);
+    assert(stat.live_blocks == 0);
+    assert(stat.live_bytes == 0);
+
+    // Blocks not allocated through memstat are released but not counted
+    memstat_free(malloc(8));
+    memstat_free(NULL);
+    assert(memstat_end(mark).frees == 2);
+}
+
+void test_memstat_nested() {
+    MemStat outer = memstat_begin();
+    void *ptr = memstat_malloc(1000, __FILE__, __LINE__);
+    memstat_free(ptr);
+
+    MemStat inner = memstat_begin();
+    ptr = memstat_malloc(10, __FILE__, __LINE__);
+    assert(memstat_end(inner).peak_bytes == 10);
+    memstat_free(ptr);
+
+    MemStat stat = memstat_end(outer);
+    assert(stat.allocs == 2);
+    assert(stat.peak_bytes == 1000);
+    assert(stat.live_blocks == 0);
+}
+
+void test_memstat_table() {
+    // Enough blocks to grow the table, released in a different order
+    enum { N = BLOCK_TABLE_MIN * 2 };
+    void **ptrs = malloc(N * sizeof(void *));
+    MemStat mark = memstat_begin();
+    for (int i = 0; i < N; ++i) {
+        ptrs[i] = memstat_malloc(i % 7 + 1, __FILE__, __LINE__);
+    }
+    assert(memstat_end(mark).live_blocks == N);
+    for (int i = 0; i < N; i += 2) {
+        memstat_free(ptrs[i]);
+    }
+    for (int i = 1; i < N; i += 2) {
+        memstat_free(ptrs[i]);
+    }
+    MemStat stat = memstat_end(mark);
+    assert(stat.frees == N);
+    assert(stat.live_blocks == 0);
+    assert(stat.live_bytes == 0);
+    free(ptrs);
+}
+
+void test_memstat_stale() {
+    // A block released with free() is counted as released once its
+    // address is allocated again
+    MemStat mark = memstat_begin();
+    void *ptr = memstat_malloc(24, __FILE__, __LINE__);
+    free(ptr);
+    void *again = memstat_malloc(24, __FILE__, __LINE__);
+    if (again == ptr) {
+        MemStat stat = memstat_end(mark);
+        assert(stat.frees == 1);
+        assert(stat.live_blocks == 1 && stat.live_bytes == 24);
+        memstat_free(again);
+        stat = memstat_end(mark);
+        assert(stat.live_blocks == 0 && stat.live_bytes == 0);
+    } else {
+        memstat_free(again);
+    }
+}
+
+void test_memstat_to_str() {
+    char *str = memstat_to_str((MemStat) {12, 11, 480, 1, 16, 256});
+    assert(equal_str(str,
+        "12 allocs, 11 frees, 480 bytes, peak 256 bytes, 1 live"));
+    dio_free(str);
+}
+
+void test_memstat_h() {
+    test_memstat_alloc();
+    test_memstat_nested();
+    test_memstat_table();
+    test_memstat_stale();
+    test_memstat_to_str();
+}
@@ -0,0 +1,165 @@
+/**
+ * "memstat.h" provides optional accounting of the heap allocations made by
+ * the backend, for tracking allocation budgets and finding leaks.
+ *
+ * The backend allocates through dio_malloc(), dio_calloc(), dio_realloc()
+ * and dio_free(). They are plain malloc(), calloc(), realloc() and free()
+ * unless the backend is built with DIO_MEMSTAT defined (make MEMSTAT=1),
+ * in which case every allocation is recorded with the file and line that
+ * made it. Each thread then has its own counters, so the allocations of a
+ * single solve or API call can be measured with memstat_begin() and
+ * memstat_end(), and the blocks still allocated when the program exits are
+ * reported on standard error, grouped by the line that allocated them.
+ *
+ * Memory allocated by the backend must be released with dio_free(). A block
+ * released with free() stays counted as live until its address is
+ * allocated again. Memory from malloc() may be released with dio_free(),
+ * and is simply not counted.
+ */
+
+#ifndef MEMSTAT_H
+#define MEMSTAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef DIO_MEMSTAT
+#define dio_malloc(size) memstat_malloc(size, __FILE__, __LINE__)
+#define dio_calloc(num, size) memstat_calloc(num, size, __FILE__, __LINE__)
+#define dio_realloc(ptr, size) memstat_realloc(ptr, size, __FILE__, __LINE__)
+#define dio_free(ptr) memstat_free(ptr)
+#else
+#define dio_malloc(size) malloc(size)
+#define dio_calloc(num, size) calloc(num, size)
+#define dio_realloc(ptr, size) realloc(ptr, size)
+#define dio_free(ptr) free(ptr)
+#endif
+
+/**
+ * Represents allocation counters, either since the start of the program
+ * or between memstat_begin() and memstat_end().
+ */
+typedef struct MemStat {
+    long long allocs;       // Allocations, including reallocations
+    long long frees;        // Blocks released
+    long long bytes;        // Bytes requested by the allocations
+    long long live_blocks;  // Blocks allocated and not yet released
+    long long live_bytes;   // Bytes allocated and not yet released
+    long long peak_bytes;   // Highest value of live_bytes
+} MemStat;
+
+/**
+ * Checks if the backend was built with DIO_MEMSTAT defined.
+ *
+ * @return true if the allocations of the backend are counted.
+ */
+bool memstat_enabled();
+
+/**
+ * Allocates and records a block, like malloc().
+ *
+ * @param size Number of bytes to allocate.
+ * @param file Source file of the allocation.
+ * @param line Line of the allocation.
+ * @return The allocated block, or NULL if out of memory.
+ */
+void *memstat_malloc(size_t size, const char *file, int line);
+
+/**
+ * Allocates and records a zeroed block, like calloc().
+ *
+ * @param num Number of elements.
+ * @param size Size of each element in bytes.
+ * @param file Source file of the allocation.
+ * @param line Line of the allocation.
+ * @return The allocated block, or NULL if out of memory.
+ */
+void *memstat_calloc(size_t num, size_t size, const char *file, int line);
+
+/**
+ * Resizes a block and records it under the new line, like realloc().
+ *
+ * @param ptr The block to resize, or NULL to allocate a new one.
+ * @param size New size in bytes.
+ * @param file Source file of the reallocation.
+ * @param line Line of the reallocation.
+ * @return The resized block, or NULL if out of memory.
+ */
+void *memstat_realloc(void *ptr, size_t size, const char *file, int line);
+
+/**
+ * Releases a block, like free().
+ *
+ * @param ptr The block to release, or NULL.
+ */
+void memstat_free(void *ptr);
+
+/**
+ * Produces the counters of the calling thread since it started.
+ *
+ * @return The counters of the calling thread.
+ */
+MemStat memstat_thread();
+
+/**
+ * Produces the counters of all threads since the program started.
+ *
+ * @return The counters of the process.
+ */
+MemStat memstat_total();
+
+/**
+ * Starts measuring the allocations of the calling thread. Measurements
+ * may be nested.
+ *
+ * @return A mark to pass to memstat_end().
+ */
+MemStat memstat_begin();
+
+/**
+ * Finishes measuring the allocations of the calling thread.
+ *
+ * @param mark The mark from memstat_begin().
+ * @return The counters since the mark. live_blocks and live_bytes hold
+ *         what is still allocated (i.e. leaked, if the measured code should
+ *         release everything), and peak_bytes the highest usage above the
+ *         usage at the mark.
+ */
+MemStat memstat_end(MemStat mark);
+
+/**
+ * Converts counters to a one-line string,
+ * such as "12 allocs, 12 frees, 480 bytes, peak 256 bytes, 0 live",
+ * where "live" is the number of blocks not released.
+ *
+ * @param stat The counters to convert.
+ * @return A dynamically allocated string.
+ *         Make sure to call dio_free() after usage.
+ */
+char *memstat_to_str(MemStat stat);
+
+/**
+ * Prints the blocks that are still allocated, grouped by the line that
+ * allocated them.
+ *
+ * @param out The stream to print to.
+ * @return The number of blocks still allocated.
+ */
+long long memstat_report(FILE *out);
+
+/**
+ * Runs unit tests for functions in "memstat.h".
+ */
+void test_memstat_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
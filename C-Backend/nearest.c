@@ -0,0 +1,223 @@
+#include "nearest.h"
+#include "intvl.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+double metric_norm(Metric metric, double ex, double ey) {
+    switch (metric) {
+    case METRIC_L1:
+        return fabs(ex) + fabs(ey);
+    case METRIC_L2:
+        return hypot(ex, ey);
+    default:
+        return fmax(fabs(ex), fabs(ey));
+    }
+}
+
+/**
+ * Finds a real n that minimizes the length of (dx * n - u, dy * n - v),
+ * where dx and dy are not both 0.
+ *
+ * @param metric The metric.
+ * @param dx The change in x as n increases by 1.
+ * @param dy The change in y as n increases by 1.
+ * @param u The x value of the target relative to the particular solution.
+ * @param v The y value of the target relative to the particular solution.
+ * @return The minimizer closest to 0.
+ */
+double line_minimizer(Metric metric, double dx, double dy, double u, double v) {
+    if (metric == METRIC_L2) {
+        // The orthogonal projection of (u, v) onto the line
+        return (dx * u + dy * v) / (dx * dx + dy * dy);
+    }
+
+    // The length is piecewise linear in n, so it is minimized where one
+    // component is 0 or, for L∞, where both components have equal lengths
+    double kinks[4];
+    int num_kinks = 0;
+    if (dx != 0) {
+        kinks[num_kinks++] = u / dx;
+    }
+    if (dy != 0) {
+        kinks[num_kinks++] = v / dy;
+    }
+    if (metric == METRIC_LINF && dx + dy != 0) {
+        kinks[num_kinks++] = (u + v) / (dx + dy);
+    }
+    if (metric == METRIC_LINF && dx - dy != 0) {
+        kinks[num_kinks++] = (u - v) / (dx - dy);
+    }
+
+    // The minimizers form an interval between two kinks of equal length
+    double low = kinks[0];
+    double high = kinks[0];
+    double best_norm = metric_norm(metric, dx * low - u, dy * low - v);
+    for (int i = 1; i < num_kinks; ++i) {
+        double norm = metric_norm(metric, dx * kinks[i] - u, dy * kinks[i] - v);
+        if (norm < best_norm) {
+            low = high = kinks[i];
+            best_norm = norm;
+        } else if (norm == best_norm) {
+            low = fmin(low, kinks[i]);
+            high = fmax(high, kinks[i]);
+        }
+    }
+    return fmin(fmax(0, low), high);
+}
+
+/**
+ * Rounds t to the nearest integer within an integer interval.
+ *
+ * @param t The value to be rounded.
+ * @param intvl The integer interval.
+ * @return The nearest integer to t in the interval.
+ */
+long long round_into(double t, Interval intvl) {
+    return fmin(fmax(round(t), intvl.low), intvl.high);
+}
+
+Nearest soln_set_nearest(SolnSet set, Interval xi, Interval yi,
+                         double tx, double ty, Metric metric) {
+    Nearest nearest = {0, 0, 0, 0, false};
+    if (!set.exist) {
+        return nearest;
+    }
+
+    nearest.exist = true;
+    if (set.plane) {
+        // Each norm grows with the length of either component, so the
+        // nearest point of a box rounds and clamps each coordinate
+        nearest.x = round_into(tx, int_interval(xi));
+        nearest.y = round_into(ty, int_interval(yi));
+        nearest.dist = metric_norm(metric, nearest.x - tx, nearest.y - ty);
+        return nearest;
+    }
+
+    // A convex function of n is minimized over the integers of an interval
+    // at the floor or the ceiling of its minimizer, clamped to the interval
+    double n = line_minimizer(metric, set.dx, set.dy, tx - set.x0, ty - set.y0);
+    double low = set.n_intvl.low;
+    double high = set.n_intvl.high;
+    long long candidates[] = {fmin(fmax(floor(n), low), high),
+                              fmin(fmax(ceil(n), low), high)};
+
+    for (int i = 0; i < 2; ++i) {
+        long long cand = candidates[i];
+        long long x = set.x0 + (long long) set.dx * cand;
+        long long y = set.y0 + (long long) set.dy * cand;
+        double dist = metric_norm(metric, x - tx, y - ty);
+        if (i == 0 || dist < nearest.dist ||
+            (dist == nearest.dist && llabs(cand) < llabs(nearest.n))) {
+            nearest.n = cand;
+            nearest.x = x;
+            nearest.y = y;
+            nearest.dist = dist;
+        }
+    }
+    return nearest;
+}
+
+Nearest lde_nearest(LDE lde, double tx, double ty, Metric metric) {
+    return soln_set_nearest(lde_soln_set(lde), lde.xi, lde.yi, tx, ty, metric);
+}
+
+void prepared_nearest(const PreparedLDE *prep, int c, Interval xi, Interval yi,
+                      const double *txs, const double *tys, int n,
+                      Metric metric, Nearest *nearest) {
+    SolnSet set = prepared_soln_set(prep, c, xi, yi);
+    for (int i = 0; i < n; ++i) {
+        nearest[i] = soln_set_nearest(set, xi, yi, txs[i], tys[i], metric);
+    }
+}
+
+void test_metric_norm() {
+    assert(metric_norm(METRIC_L1, 3, -4) == 7);
+    assert(metric_norm(METRIC_L2, 3, -4) == 5);
+    assert(metric_norm(METRIC_LINF, 3, -4) == 4);
+    assert(metric_norm(METRIC_LINF, 0, 0) == 0);
+}
+
+void test_soln_set_nearest() {
+    LDE lde = make_lde_in(9, 5, 137, POS, POS);
+
+    // The target is nearest to the middle solution, or to an end of the
+    // n-interval when it lies beyond the segment
+    Nearest nearest = lde_nearest(lde, 8.2, 12.5, METRIC_L2);
+    assert(nearest.exist && nearest.n == 29);
+    assert(nearest.x == 8 && nearest.y == 13);
+    nearest = lde_nearest(lde, 100, 0, METRIC_L1);
+    assert(nearest.exist && nearest.n == 30 && nearest.dist == 91);
+    nearest = lde_nearest(lde, -100, 100, METRIC_LINF);
+    assert(nearest.exist && nearest.n == 28 && nearest.dist == 103);
+
+    // Without domains, the target is projected onto the whole line
+    lde = make_lde(9, 5, 137);
+    nearest = lde_nearest(lde, 1003, -1774, METRIC_L2);
+    assert(nearest.exist && nearest.x == 1003 && nearest.y == -1778);
+    assert(nearest.dist == 4);
+
+    // Equally near solutions are broken towards n = 0
+    lde = make_lde(1, -1, 0);
+    nearest = lde_nearest(lde, 1, 0, METRIC_L1);
+    assert(nearest.exist && nearest.n == 0 && nearest.dist == 1);
+
+    assert(!lde_nearest(make_lde(10, 8, 99), 0, 0, METRIC_L2).exist);
+
+    // A plane over x in [1, 5] and y >= 0
+    lde = make_lde_in(0, 0, 0, make_interval(1, 5, false, false), NONNEG);
+    nearest = lde_nearest(lde, 2.6, -7, METRIC_LINF);
+    assert(nearest.exist && nearest.x == 3 && nearest.y == 0);
+    assert(nearest.dist == 7);
+}
+
+void test_nearest_over_n() {
+    // Every n of each bounded solution set is tried, for targets on and off
+    // the segment of solutions
+    int coeffs[][2] = {{3, -8}, {10, 15}, {0, 4}, {6, 0}, {2, 2}};
+    Interval xi = make_interval(-40, 25, true, false);
+    Interval yi = make_interval(-10, 10, false, false);
+    int cs[] = {-36, -4, 0, 7, 30};
+    double txs[] = {-55.5, -7.25, -1, 0, 0.5, 3.75, 12, 60};
+    double tys[] = {4.5, -30, 9.9, 0, -0.5, 1.25, 100, -2};
+    int num_targets = sizeof(txs) / sizeof(txs[0]);
+    Metric metrics[] = {METRIC_L1, METRIC_L2, METRIC_LINF};
+
+    for (size_t k = 0; k < sizeof(coeffs) / sizeof(coeffs[0]); ++k) {
+        PreparedLDE prep = prepare_lde(coeffs[k][0], coeffs[k][1]);
+        for (size_t m = 0; m < sizeof(cs) / sizeof(cs[0]); ++m) {
+            SolnSet set = prepared_soln_set(&prep, cs[m], xi, yi);
+            for (int r = 0; r < 3; ++r) {
+                Nearest nearest[sizeof(txs) / sizeof(txs[0])];
+                prepared_nearest(&prep, cs[m], xi, yi, txs, tys, num_targets,
+                                 metrics[r], nearest);
+
+                for (int t = 0; t < num_targets; ++t) {
+                    if (!set.exist) {
+                        assert(!nearest[t].exist);
+                        continue;
+                    }
+
+                    double best = INFINITY;
+                    for (int n = set.n_intvl.low; n <= set.n_intvl.high; ++n) {
+                        best = fmin(best, metric_norm(metrics[r],
+                            set.x0 + set.dx * n - txs[t],
+                            set.y0 + set.dy * n - tys[t]));
+                    }
+                    assert(nearest[t].exist);
+                    assert(fabs(nearest[t].dist - best) < 1e-9);
+                    assert(is_in_interval(nearest[t].n, set.n_intvl));
+                    assert(nearest[t].x == set.x0 + set.dx * nearest[t].n);
+                    assert(nearest[t].y == set.y0 + set.dy * nearest[t].n);
+                }
+            }
+        }
+    }
+}
+
+void test_nearest_h() {
+    test_metric_norm();
+    test_soln_set_nearest();
+    test_nearest_over_n();
+}
@@ -0,0 +1,105 @@
+/**
+ * "nearest.h" finds the solution of an LDE closest to a target point
+ * (tx, ty) within the domains of x and y.
+ *
+ * The distance from (x0 + dx * n, y0 + dy * n) to the target is a convex
+ * function of n under any norm. So its real minimizer is projected from the
+ * target onto the solution line, and the nearest integer n is the floor or
+ * the ceiling of that minimizer, clamped to the n-interval. This takes
+ * constant time, however many solutions there are.
+ */
+
+#ifndef NEAREST_H
+#define NEAREST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lde.h"
+
+/**
+ * Distance between two points.
+ */
+typedef enum Metric {
+    METRIC_L1,          // |x1 - x2| + |y1 - y2|
+    METRIC_L2,          // sqrt((x1 - x2)^2 + (y1 - y2)^2)
+    METRIC_LINF,        // max(|x1 - x2|, |y1 - y2|)
+} Metric;
+
+/**
+ * Represents the solution of an LDE nearest to a target. If several
+ * solutions are equally near, the one whose n is closest to 0 is chosen.
+ */
+typedef struct Nearest {
+    long long n;        // Parameter of the solution, 0 for a plane
+    long long x;        // x value of the nearest solution
+    long long y;        // y value of the nearest solution
+    double dist;        // Distance to the target
+
+    bool exist;         // True if the LDE has a solution
+} Nearest;
+
+/**
+ * Measures the length of a vector (ex, ey) under a metric.
+ *
+ * @param metric The metric.
+ * @param ex The x component.
+ * @param ey The y component.
+ * @return The length of the vector.
+ */
+double metric_norm(Metric metric, double ex, double ey);
+
+/**
+ * Finds the solution in a solution set nearest to a target in constant time.
+ *
+ * @param set The solution set of an LDE.
+ * @param xi The domain of x.
+ * @param yi The domain of y.
+ * @param tx The x value of the target.
+ * @param ty The y value of the target.
+ * @param metric The metric to measure distance by.
+ * @return The nearest solution, with "exist" set to false if there is none.
+ */
+Nearest soln_set_nearest(SolnSet set, Interval xi, Interval yi,
+                         double tx, double ty, Metric metric);
+
+/**
+ * Solves an LDE and finds its solution nearest to a target.
+ *
+ * @param lde The LDE.
+ * @param tx The x value of the target.
+ * @param ty The y value of the target.
+ * @param metric The metric to measure distance by.
+ * @return The nearest solution, with "exist" set to false if there is none.
+ */
+Nearest lde_nearest(LDE lde, double tx, double ty, Metric metric);
+
+/**
+ * Finds the nearest solutions of ax + by = c to many targets in one loop,
+ * without any allocation. The solution set is produced once.
+ *
+ * @param prep The prepared LDE.
+ * @param c The constant term.
+ * @param xi The domain of x.
+ * @param yi The domain of y.
+ * @param txs The x values of the targets.
+ * @param tys The y values of the targets.
+ * @param n Number of targets.
+ * @param metric The metric to measure distance by.
+ * @param nearest Receives the nearest solution to each target.
+ */
+void prepared_nearest(const PreparedLDE *prep, int c, Interval xi, Interval yi,
+                      const double *txs, const double *tys, int n,
+                      Metric metric, Nearest *nearest);
+
+/**
+ * Runs unit tests for functions in "nearest.h".
+ */
+void test_nearest_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
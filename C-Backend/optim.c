@@ -0,0 +1,172 @@
+#include "optim.h"
+#include "intvl.h"
+
+#include <assert.h>
+#include <math.h>
+
+Objective make_objective(int p, int q, bool maximize) {
+    return (Objective) {p, q, maximize};
+}
+
+/**
+ * Picks the integer t within [low, high] that optimizes coeff * t.
+ *
+ * @param low The smallest t, or NEG_INF if unbounded below.
+ * @param high The largest t, or POS_INF if unbounded above.
+ * @param coeff The coefficient of t.
+ * @param maximize True to maximize, false to minimize.
+ * @param t Receives the optimal t, the one closest to 0 if coeff is 0.
+ * @return false if the objective is unbounded, true otherwise.
+ */
+bool optimize_linear(double low, double high, long long coeff, bool maximize,
+                     long long *t) {
+    if (coeff == 0) {
+        *t = (low > 0) ? low : (high < 0) ? high : 0;
+        return true;
+    }
+
+    if ((coeff > 0) == maximize) {
+        *t = high;
+        return high != POS_INF;
+    }
+    *t = low;
+    return low != NEG_INF;
+}
+
+Optimum soln_set_optimum(SolnSet set, Interval xi, Interval yi, Objective obj) {
+    Optimum opt = {OPT_INFEASIBLE, 0, 0, 0, 0};
+    if (!set.exist) {
+        return opt;
+    }
+
+    if (set.plane) {
+        // The optimum of a box is at the corner picked by the signs of p
+        // and q, or on the axis where a coefficient is 0
+        Interval x_ints = int_interval(xi);
+        Interval y_ints = int_interval(yi);
+        if (!optimize_linear(x_ints.low, x_ints.high, obj.p, obj.maximize,
+                             &opt.x) ||
+            !optimize_linear(y_ints.low, y_ints.high, obj.q, obj.maximize,
+                             &opt.y)) {
+            opt.x = opt.y = 0;
+            opt.status = OPT_UNBOUNDED;
+            return opt;
+        }
+    } else {
+        // Fits in 64 bits, since |p|, |q|, |dx| and |dy| are below 2^31
+        long long slope = (long long) obj.p * set.dx + (long long) obj.q * set.dy;
+        if (!optimize_linear(set.n_intvl.low, set.n_intvl.high, slope,
+                             obj.maximize, &opt.n)) {
+            opt.n = 0;
+            opt.status = OPT_UNBOUNDED;
+            return opt;
+        }
+        opt.x = set.x0 + (long long) set.dx * opt.n;
+        opt.y = set.y0 + (long long) set.dy * opt.n;
+    }
+
+    opt.status = OPT_OPTIMAL;
+    opt.value = (double) obj.p * opt.x + (double) obj.q * opt.y;
+    return opt;
+}
+
+Optimum lde_optimum(LDE lde, Objective obj) {
+    return soln_set_optimum(lde_soln_set(lde), lde.xi, lde.yi, obj);
+}
+
+void prepared_optima(const PreparedLDE *prep, const int *cs, int n,
+                     Interval xi, Interval yi, Objective obj, Optimum *optima) {
+    for (int i = 0; i < n; ++i) {
+        optima[i] = soln_set_optimum(prepared_soln_set(prep, cs[i], xi, yi),
+                                     xi, yi, obj);
+    }
+}
+
+void test_soln_set_optimum() {
+    LDE lde = make_lde_in(9, 5, 137, POS, POS);
+
+    // The solutions are (3, 22), (8, 13) and (13, 4) for n = 28, 29, 30
+    Optimum opt = lde_optimum(lde, make_objective(1, 1, false));
+    assert(opt.status == OPT_OPTIMAL);
+    assert(opt.n == 30 && opt.x == 13 && opt.y == 4 && opt.value == 17);
+
+    opt = lde_optimum(lde, make_objective(1, 1, true));
+    assert(opt.status == OPT_OPTIMAL);
+    assert(opt.n == 28 && opt.x == 3 && opt.y == 22 && opt.value == 25);
+
+    // Every solution has the same value, so n closest to 0 is chosen
+    opt = lde_optimum(lde, make_objective(9, 5, true));
+    assert(opt.status == OPT_OPTIMAL && opt.n == 28 && opt.value == 137);
+
+    // x + y decreases as n increases, and only n <= 30 is bounded
+    lde.xi = REAL;
+    opt = lde_optimum(lde, make_objective(1, 1, false));
+    assert(opt.status == OPT_OPTIMAL && opt.n == 30);
+    opt = lde_optimum(lde, make_objective(1, 1, true));
+    assert(opt.status == OPT_UNBOUNDED);
+
+    opt = lde_optimum(make_lde(10, 8, 99), make_objective(1, 1, false));
+    assert(opt.status == OPT_INFEASIBLE);
+
+    // A plane over x in [1, 5] and y >= 0
+    lde = make_lde_in(0, 0, 0, make_interval(1, 5, false, false), NONNEG);
+    opt = lde_optimum(lde, make_objective(1, -1, true));
+    assert(opt.status == OPT_OPTIMAL && opt.x == 5 && opt.y == 0);
+    opt = lde_optimum(lde, make_objective(0, -2, false));
+    assert(opt.status == OPT_UNBOUNDED);
+    opt = lde_optimum(lde, make_objective(0, 1, false));
+    assert(opt.status == OPT_OPTIMAL && opt.x == 1 && opt.y == 0);
+
+    // Values beyond the range of int
+    lde = make_lde_in(1, -1, 0, NONNEG, make_interval(0, POS_INF - 1, false, false));
+    opt = lde_optimum(lde, make_objective(POS_INF, POS_INF, true));
+    assert(opt.status == OPT_OPTIMAL && opt.x == POS_INF - 1);
+    assert(opt.value == 2.0 * POS_INF * (POS_INF - 1.0));
+}
+
+void test_optimum_over_n() {
+    // Every n of each bounded solution set is tried
+    int coeffs[][2] = {{4, 7}, {-12, 18}, {5, 0}, {0, 3}, {1, 1}};
+    Interval xi = make_interval(-30, 30, false, false);
+    Interval yi = make_interval(-5, 12, true, false);
+    int cs[] = {-25, -6, 0, 6, 11, 24};
+    int num_cs = sizeof(cs) / sizeof(cs[0]);
+
+    for (size_t k = 0; k < sizeof(coeffs) / sizeof(coeffs[0]); ++k) {
+        PreparedLDE prep = prepare_lde(coeffs[k][0], coeffs[k][1]);
+        for (int p = -2; p <= 2; ++p) {
+            for (int q = -2; q <= 2; ++q) {
+                for (int max = 0; max < 2; ++max) {
+                    Objective obj = make_objective(p, q, max);
+                    Optimum optima[sizeof(cs) / sizeof(cs[0])];
+                    prepared_optima(&prep, cs, num_cs, xi, yi, obj, optima);
+
+                    for (int m = 0; m < num_cs; ++m) {
+                        SolnSet set = prepared_soln_set(&prep, cs[m], xi, yi);
+                        Optimum opt = optima[m];
+                        if (!set.exist) {
+                            assert(opt.status == OPT_INFEASIBLE);
+                            continue;
+                        }
+
+                        double best = max ? -INFINITY : INFINITY;
+                        for (int n = set.n_intvl.low; n <= set.n_intvl.high; ++n) {
+                            double value = p * (set.x0 + set.dx * n) +
+                                           q * (set.y0 + set.dy * n);
+                            best = max ? fmax(best, value) : fmin(best, value);
+                        }
+                        assert(opt.status == OPT_OPTIMAL && opt.value == best);
+                        assert(is_in_interval(opt.n, set.n_intvl));
+                        assert(opt.x == set.x0 + set.dx * opt.n);
+                        assert(opt.y == set.y0 + set.dy * opt.n);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void test_optim_h() {
+    test_soln_set_optimum();
+    test_optimum_over_n();
+}
@@ -0,0 +1,105 @@
+/**
+ * "optim.h" finds the solution of an LDE that minimizes or maximizes a
+ * linear objective p * x + q * y within the domains of x and y.
+ *
+ * Along the solution set x = x0 + dx * n, y = y0 + dy * n, the objective is
+ * (p * x0 + q * y0) + (p * dx + q * dy) * n, which is linear in n. So the
+ * optimum is at an end of the n-interval, or unbounded if that end is
+ * infinite, and is found in constant time without enumerating solutions.
+ */
+
+#ifndef OPTIM_H
+#define OPTIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lde.h"
+
+/**
+ * Outcome of an optimization.
+ */
+typedef enum OptStatus {
+    OPT_OPTIMAL,        // An optimal solution exists
+    OPT_UNBOUNDED,      // The objective improves without bound
+    OPT_INFEASIBLE,     // The LDE has no solution within the domains
+} OptStatus;
+
+/**
+ * A linear objective p * x + q * y.
+ */
+typedef struct Objective {
+    int p;              // Coefficient of x
+    int q;              // Coefficient of y
+    bool maximize;      // True to maximize, false to minimize
+} Objective;
+
+/**
+ * Represents the optimum of an objective over the solutions of an LDE.
+ * If several solutions are optimal, the one whose n (or, for a plane, whose
+ * x and y) are closest to 0 is chosen.
+ */
+typedef struct Optimum {
+    OptStatus status;
+    long long n;        // Parameter of the solution, if not a plane
+    long long x;        // x value of the optimal solution
+    long long y;        // y value of the optimal solution
+    double value;       // Value of the objective, rounded to a double
+} Optimum;
+
+/**
+ * Creates an objective with specified coefficients.
+ *
+ * @param p Coefficient of x.
+ * @param q Coefficient of y.
+ * @param maximize True to maximize, false to minimize.
+ * @return An initialized objective.
+ */
+Objective make_objective(int p, int q, bool maximize);
+
+/**
+ * Optimizes an objective over a solution set in constant time.
+ *
+ * @param set The solution set of an LDE.
+ * @param xi The domain of x.
+ * @param yi The domain of y.
+ * @param obj The objective.
+ * @return The optimum, with "status" telling whether it exists.
+ */
+Optimum soln_set_optimum(SolnSet set, Interval xi, Interval yi, Objective obj);
+
+/**
+ * Solves an LDE and optimizes an objective over its solutions.
+ *
+ * @param lde The LDE.
+ * @param obj The objective.
+ * @return The optimum, with "status" telling whether it exists.
+ */
+Optimum lde_optimum(LDE lde, Objective obj);
+
+/**
+ * Optimizes an objective for many constant terms in one loop, without any
+ * allocation.
+ *
+ * @param prep The prepared LDE.
+ * @param cs The constant terms.
+ * @param n Number of constant terms.
+ * @param xi The domain of x.
+ * @param yi The domain of y.
+ * @param obj The objective.
+ * @param optima Receives the optimum for each constant term.
+ */
+void prepared_optima(const PreparedLDE *prep, const int *cs, int n,
+                     Interval xi, Interval yi, Objective obj, Optimum *optima);
+
+/**
+ * Runs unit tests for functions in "optim.h".
+ */
+void test_optim_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,245 @@
+#include "proto.h"
+#include "jsonl.h"
+#include "lde.h"
+#include "latency.h"
+#include "memstat.h"
+#include "stats.h"
+#include "trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+
+// Maximum number of fields in a request
+#define MAX_FIELDS 5
+
+// Maximum length of a field
+#define MAX_FIELD_LEN 64
+
+bool proto_int(const char *str, int *n) {
+    char *end;
+    errno = 0;
+    long value = strtol(str, &end, 10);
+    if (end == str || *end || errno == ERANGE ||
+        value < NEG_INF || value > POS_INF) {
+        return false;
+    }
+    *n = value;
+    return true;
+}
+
+void append_bound(StrBuf *out, double bound) {
+    if (bound == NEG_INF) {
+        strbuf_append(out, " -inf");
+    } else if (bound == POS_INF) {
+        strbuf_append(out, " inf");
+    } else {
+        strbuf_append(out, " %.0f", bound);
+    }
+}
+
+bool append_stats(StrBuf *out) {
+    if (!stats_enabled()) {
+        strbuf_append(out, "E statistics require a build with STATS=1\n");
+        return false;
+    }
+
+    Stats stats = stats_snapshot();
+    strbuf_append(out, "T cycles_per_ns=%.3f", stat_cycles_per_ns());
+    for (int i = 0; i < NUM_STAT_PHASES; ++i) {
+        const char *name = stat_phase_name(i);
+        strbuf_append(out, " %s_calls=%llu %s_cycles=%llu",
+                      name, (unsigned long long) stats.calls[i],
+                      name, (unsigned long long) stats.cycles[i]);
+    }
+    for (int i = 0; i < NUM_STAT_COUNTERS; ++i) {
+        strbuf_append(out, " %s=%llu", stat_counter_name(i),
+                      (unsigned long long) stats.counts[i]);
+    }
+    strbuf_append(out, "\n");
+    return true;
+}
+
+bool append_latency(StrBuf *out) {
+    if (!latency_on) {
+        strbuf_append(out, "E latency is not recorded\n");
+        return false;
+    }
+
+    Latency *lat = dio_malloc(sizeof(Latency));
+    latency_snapshot(lat);
+    char *lat_str = latency_to_str(lat);
+    strbuf_append(out, "L %s\n", lat_str);
+    dio_free(lat_str);
+    dio_free(lat);
+    return true;
+}
+
+/**
+ * Checks if a request is a command such as "STATS".
+ *
+ * @param p The request, after leading spaces.
+ * @param command The command.
+ * @return true if the request is the command, optionally followed by spaces.
+ */
+bool is_command(const char *p, const char *command) {
+    size_t len = strlen(command);
+    return !strncmp(p, command, len) && strspn(p + len, " \t\r") == strlen(p + len);
+}
+
+/**
+ * Parses the fields of a request line.
+ *
+ * @param p The request, after leading spaces.
+ * @param coeffs Receives a, b and c.
+ * @param xi Receives the domain of x.
+ * @param yi Receives the domain of y.
+ * @return NULL if the request is valid, or an error message otherwise.
+ */
+const char *parse_fields(const char *p, int coeffs[3],
+                         Interval *xi, Interval *yi) {
+    char fields[MAX_FIELDS][MAX_FIELD_LEN];
+    int num_fields = 0;
+    while (*p && *p != '\r') {
+        size_t len = strcspn(p, " \t\r");
+        if (num_fields == MAX_FIELDS || len >= MAX_FIELD_LEN) {
+            return "too many or too long fields";
+        }
+        memcpy(fields[num_fields], p, len);
+        fields[num_fields++][len] = '\0';
+        p += len;
+        while (*p == ' ' || *p == '\t') {
+            ++p;
+        }
+    }
+
+    if (num_fields < 3) {
+        return "expected a b c [x-domain [y-domain]]";
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (!proto_int(fields[i], &coeffs[i])) {
+            return "a, b and c must be integers within range";
+        }
+    }
+
+    *xi = (num_fields > 3) ? str_to_interval(fields[3]) : REAL;
+    *yi = (num_fields > 4) ? str_to_interval(fields[4]) : REAL;
+    if (!is_valid_interval(*xi) || !is_valid_interval(*yi)) {
+        return "invalid domain";
+    }
+    return NULL;
+}
+
+bool proto_handle(const char *line, StrBuf *out) {
+    const char *p = line;
+    while (*p == ' ' || *p == '\t') {
+        ++p;
+    }
+    if (*p == '{') {
+        return jsonl_handle(line, out);
+    }
+    if (is_command(p, "STATS")) {
+        return append_stats(out);
+    }
+    if (is_command(p, "LATENCY")) {
+        return append_latency(out);
+    }
+
+    LatProbe probe = latency_begin();
+    TRACE_BEGIN("request");
+    int coeffs[3];
+    Interval xi;
+    Interval yi;
+    TRACE_BEGIN("parse");
+    const char *error = parse_fields(p, coeffs, &xi, &yi);
+    TRACE_END();
+    if (error) {
+        strbuf_append(out, "E %s\n", error);
+        TRACE_END();
+        return false;
+    }
+
+    SolnSet set = lde_soln_set(make_lde_in(coeffs[0], coeffs[1], coeffs[2],
+                                           xi, yi));
+    if (!set.exist) {
+        strbuf_append(out, "N %d\n", set.d);
+    } else if (set.plane) {
+        strbuf_append(out, "P\n");
+    } else {
+        strbuf_append(out, "S %d %d %d %d %d", set.d, set.x0, set.y0,
+                      set.dx, set.dy);
+        append_bound(out, set.n_intvl.low);
+        append_bound(out, set.n_intvl.high);
+        strbuf_append(out, "\n");
+    }
+    TRACE_END();
+    latency_end(probe, LAT_TEXT, coeffs[0], coeffs[1], coeffs[2]);
+    return true;
+}
+
+void test_proto_handle() {
+    StrBuf out = make_strbuf();
+
+    assert(proto_handle("9 5 137 pos pos", &out));
+    assert(equal_str(out.str, "S 1 -137 274 5 -9 28 30\n"));
+
+    strbuf_clear(&out);
+    assert(proto_handle("  -9 5 137\treal (0,inf)\r", &out));
+    assert(equal_str(out.str, "S 1 137 274 5 9 -30 inf\n"));
+
+    strbuf_clear(&out);
+    assert(proto_handle("1 1 0", &out));
+    assert(equal_str(out.str, "S 1 0 0 1 -1 -inf inf\n"));
+
+    strbuf_clear(&out);
+    assert(proto_handle("-9 5 137 pos", &out));
+    assert(equal_str(out.str, "S 1 137 274 5 9 -27 inf\n"));
+
+    strbuf_clear(&out);
+    assert(proto_handle("10 8 99", &out));
+    assert(equal_str(out.str, "N 2\n"));
+
+    strbuf_clear(&out);
+    assert(proto_handle("0 0 0 [0,5] nonneg", &out));
+    assert(equal_str(out.str, "P\n"));
+
+    strbuf_clear(&out);
+    assert(proto_handle("{\"id\":1,\"a\":10,\"b\":8,\"c\":99}", &out));
+    assert(!strncmp(out.str, "{\"id\":1,\"ok\":true,\"exist\":false", 31));
+
+    strbuf_clear(&out);
+    if (stats_enabled()) {
+        assert(proto_handle("STATS", &out));
+        assert(!strncmp(out.str, "T cycles_per_ns=", 16));
+        assert(strstr(out.str, " solves="));
+    } else {
+        assert(!proto_handle("STATS\r", &out));
+        assert(out.str[0] == 'E');
+    }
+
+    strbuf_clear(&out);
+    if (latency_on) {
+        assert(proto_handle("LATENCY ", &out));
+        assert(!strncmp(out.str, "L ", 2));
+    } else {
+        assert(!proto_handle("LATENCY", &out));
+        assert(out.str[0] == 'E');
+    }
+
+    const char *bad[] = {
+        "", "1 2", "1 2 x", "1 2 3000000000", "1 2 3 (1,0)",
+        "1 2 3 real real real",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        strbuf_clear(&out);
+        assert(!proto_handle(bad[i], &out));
+        assert(out.str[0] == 'E');
+    }
+
+    strbuf_free(&out);
+}
+
+void test_proto_h() {
+    test_proto_handle();
+}
@@ -0,0 +1,57 @@
+/**
+ * "proto.h" provides the compact text protocol of the solve server.
+ *
+ * Each request is a line of space-separated fields:
+ *   a b c [x-domain [y-domain]]
+ * where the domains are accepted by str_to_interval() without spaces,
+ * such as "pos" or "[0,10)", and default to "real". The request "STATS"
+ * asks for the counters of "stats.h" instead, and "LATENCY" for the
+ * latency percentiles of "latency.h".
+ *
+ * Each response is a line starting with a status letter:
+ *   S d x0 y0 dx dy n_low n_high    Solutions exist (bounds may be -inf/inf)
+ *   P                               Any x and y in their domains (a = b = c = 0)
+ *   N d                             No solution
+ *   T name=value ...                Counters since the server started, such
+ *                                   as "eea_cycles=1234 eea_steps=56"
+ *   L path[/class]=n,p50,p99,p999 ...
+ *                                   Number of requests and their latency
+ *                                   percentiles in ns since recording
+ *                                   started, such as "text=9,210,650,650"
+ *   E message                       Malformed request
+ *
+ * A request line starting with '{' is handled as in "jsonl.h" instead,
+ * and answered with a JSON line.
+ */
+
+#ifndef PROTO_H
+#define PROTO_H
+
+#include "betterc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum length of a request line, excluding the newline
+#define PROTO_MAX_LINE 4096
+
+/**
+ * Handles a single request line.
+ *
+ * @param line The request, without the trailing newline.
+ * @param out Receives the response, including the trailing newline.
+ * @return true if the request was solved, false if it was malformed.
+ */
+bool proto_handle(const char *line, StrBuf *out);
+
+/**
+ * Runs unit tests for functions in "proto.h".
+ */
+void test_proto_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
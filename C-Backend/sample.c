@@ -0,0 +1,268 @@
+#include "sample.h"
+#include "intvl.h"
+
+#include <assert.h>
+
+// Number of random words drawn from the PRNG at a time
+#define SAMPLE_CHUNK 256
+
+uint64_t xorshift_next(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1Dull;
+}
+
+void xorshift_fill(void *ctx, uint64_t *words, int n) {
+    uint64_t *state = ctx;
+    for (int i = 0; i < n; ++i) {
+        words[i] = xorshift_next(state);
+    }
+}
+
+void rand_below(RandFill fill, void *ctx, uint32_t bound,
+                uint64_t *values, int n) {
+    // The top 32 bits of a word times bound, divided by 2^32, are in
+    // [0, bound). Products whose low half is below 2^32 mod bound would
+    // make some results more likely, so they are redrawn.
+    uint32_t threshold = -bound % bound;
+    fill(ctx, values, n);
+    uint32_t lowest = UINT32_MAX;
+    for (int i = 0; i < n; ++i) {
+        values[i] = (uint64_t) (uint32_t) (values[i] >> 32) * bound;
+        uint32_t low = values[i];
+        lowest = (low < lowest) ? low : lowest;
+    }
+    if (lowest < threshold) {
+        for (int i = 0; i < n; ++i) {
+            while ((uint32_t) values[i] < threshold) {
+                fill(ctx, &values[i], 1);
+                values[i] = (values[i] >> 32) * bound;
+            }
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        values[i] >>= 32;
+    }
+}
+
+/**
+ * Counts the integers in an integer interval.
+ *
+ * @param ints An integer interval.
+ * @return The number of integers, or INF_COUNT if an end is infinite.
+ */
+uint64_t int_interval_count(Interval ints) {
+    if (!is_valid_interval(ints)) {
+        return 0;
+    }
+    if (ints.low == NEG_INF || ints.high == POS_INF) {
+        return INF_COUNT;
+    }
+    return (uint64_t) ((long long) ints.high - (long long) ints.low + 1);
+}
+
+uint64_t soln_set_count(SolnSet set, Interval xi, Interval yi) {
+    if (!set.exist) {
+        return 0;
+    }
+    if (!set.plane) {
+        return int_interval_count(set.n_intvl);
+    }
+
+    // Both counts are below 2^32, so the product cannot overflow
+    uint64_t x_count = int_interval_count(int_interval(xi));
+    uint64_t y_count = int_interval_count(int_interval(yi));
+    if (x_count == INF_COUNT || y_count == INF_COUNT) {
+        return INF_COUNT;
+    }
+    return x_count * y_count;
+}
+
+SampleStatus soln_set_samples(SolnSet set, Interval xi, Interval yi,
+                              RandFill fill, void *ctx, int k,
+                              Sample *samples) {
+    uint64_t count = soln_set_count(set, xi, yi);
+    if (count == 0) {
+        return SAMPLE_EMPTY;
+    }
+    if (count == INF_COUNT) {
+        return SAMPLE_INFINITE;
+    }
+
+    uint64_t draws[SAMPLE_CHUNK];
+    if (set.plane) {
+        // A uniform point of a box has uniform, independent coordinates
+        Interval x_ints = int_interval(xi);
+        Interval y_ints = int_interval(yi);
+        uint32_t x_width = int_interval_count(x_ints);
+        uint32_t y_width = count / x_width;
+        uint64_t ys[SAMPLE_CHUNK];
+        for (int i = 0; i < k; i += SAMPLE_CHUNK) {
+            int m = (k - i < SAMPLE_CHUNK) ? k - i : SAMPLE_CHUNK;
+            rand_below(fill, ctx, x_width, draws, m);
+            rand_below(fill, ctx, y_width, ys, m);
+            for (int j = 0; j < m; ++j) {
+                samples[i + j].n = 0;
+                samples[i + j].x = (long long) x_ints.low + (long long) draws[j];
+                samples[i + j].y = (long long) y_ints.low + (long long) ys[j];
+            }
+        }
+        return SAMPLE_OK;
+    }
+
+    long long low = set.n_intvl.low;
+    for (int i = 0; i < k; i += SAMPLE_CHUNK) {
+        int m = (k - i < SAMPLE_CHUNK) ? k - i : SAMPLE_CHUNK;
+        rand_below(fill, ctx, count, draws, m);
+        for (int j = 0; j < m; ++j) {
+            long long n = low + (long long) draws[j];
+            samples[i + j].n = n;
+            samples[i + j].x = set.x0 + (long long) set.dx * n;
+            samples[i + j].y = set.y0 + (long long) set.dy * n;
+        }
+    }
+    return SAMPLE_OK;
+}
+
+SampleStatus lde_samples(LDE lde, RandFill fill, void *ctx, int k,
+                         Sample *samples) {
+    return soln_set_samples(lde_soln_set(lde), lde.xi, lde.yi,
+                            fill, ctx, k, samples);
+}
+
+/**
+ * A RandFill that replays a fixed sequence of words, for testing.
+ */
+void replay_fill(void *ctx, uint64_t *words, int n) {
+    uint64_t **next = ctx;
+    for (int i = 0; i < n; ++i) {
+        words[i] = *(*next)++;
+    }
+}
+
+void test_rand_below() {
+    // 2^32 mod 3 = 1, so a word whose top half is 0 is redrawn
+    uint64_t words[] = {0, 1ull << 63, UINT64_MAX};
+    uint64_t *next = words;
+    uint64_t values[2];
+    rand_below(replay_fill, &next, 3, values, 2);
+    assert(values[0] == 2 && values[1] == 1);
+    assert(next == words + 3);
+
+    uint64_t state = 42;
+    uint64_t many[1000];
+    rand_below(xorshift_fill, &state, 7, many, 1000);
+    bool seen[7] = {false};
+    for (int i = 0; i < 1000; ++i) {
+        assert(many[i] < 7);
+        seen[many[i]] = true;
+    }
+    for (int i = 0; i < 7; ++i) {
+        assert(seen[i]);
+    }
+}
+
+void test_soln_set_count() {
+    Interval xi = make_interval(0, 10, true, false);
+    assert(soln_set_count(lde_soln_set(make_lde_in(2, 3, 1, xi, REAL)),
+                          xi, REAL) == 3);
+    assert(soln_set_count(lde_soln_set(make_lde(2, 3, 1)),
+                          REAL, REAL) == INF_COUNT);
+    assert(soln_set_count(lde_soln_set(make_lde(10, 8, 99)), REAL, REAL) == 0);
+
+    // A plane counts the pairs of integers in both domains
+    xi = make_interval(1, 5, false, false);
+    Interval yi = make_interval(-2, 7, true, true);
+    assert(soln_set_count(lde_soln_set(make_lde_in(0, 0, 0, xi, yi)),
+                          xi, yi) == 5 * 8);
+    assert(soln_set_count(lde_soln_set(make_lde_in(0, 0, 0, xi, REAL)),
+                          xi, REAL) == INF_COUNT);
+
+    // The widest bounded domains still fit in 64 bits
+    Interval wide = make_interval(NEG_INF + 1, POS_INF - 1, false, false);
+    uint64_t width = 2ull * POS_INF - 1;
+    assert(soln_set_count(lde_soln_set(make_lde_in(0, 0, 0, wide, wide)),
+                          wide, wide) == width * width);
+    assert(soln_set_count(lde_soln_set(make_lde_in(1, -1, 0, wide, wide)),
+                          wide, wide) == width);
+}
+
+void test_soln_set_samples() {
+    // x = -1 + 3n and y = 1 - 2n for n = 1, 2, 3
+    Interval xi = make_interval(0, 10, true, false);
+    LDE lde = make_lde_in(2, 3, 1, xi, REAL);
+    Sample samples[3000];
+    uint64_t state = 1;
+    assert(lde_samples(lde, xorshift_fill, &state, 3000, samples) == SAMPLE_OK);
+
+    int hits[3] = {0};
+    for (int i = 0; i < 3000; ++i) {
+        assert(2 * samples[i].x + 3 * samples[i].y == 1);
+        assert(is_in_interval(samples[i].x, xi));
+        ++hits[(samples[i].x - 2) / 3];
+    }
+    for (int i = 0; i < 3; ++i) {
+        assert(hits[i] > 900 && hits[i] < 1100);
+    }
+
+    // Chunks of the batch draw the same solutions as separate calls
+    uint64_t batch_state = 7;
+    uint64_t split_state = 7;
+    SolnSet set = lde_soln_set(lde);
+    assert(soln_set_samples(set, xi, REAL, xorshift_fill, &batch_state,
+                            600, samples) == SAMPLE_OK);
+    Sample split[600];
+    for (int i = 0; i < 600; i += SAMPLE_CHUNK) {
+        int m = (600 - i < SAMPLE_CHUNK) ? 600 - i : SAMPLE_CHUNK;
+        assert(soln_set_samples(set, xi, REAL, xorshift_fill, &split_state,
+                                m, split + i) == SAMPLE_OK);
+    }
+    for (int i = 0; i < 600; ++i) {
+        assert(split[i].n == samples[i].n && split[i].x == samples[i].x &&
+               split[i].y == samples[i].y);
+    }
+
+    // A wide but finite set is sampled over all of its n-interval
+    Interval wide = make_interval(NEG_INF + 1, POS_INF - 1, false, false);
+    lde = make_lde_in(1, -1, 0, wide, wide);
+    assert(lde_samples(lde, xorshift_fill, &state, 1000, samples) == SAMPLE_OK);
+    bool low_half = false, high_half = false;
+    for (int i = 0; i < 1000; ++i) {
+        assert(samples[i].x == samples[i].y);
+        assert(is_in_interval(samples[i].x, wide));
+        low_half |= samples[i].x < -(1LL << 30);
+        high_half |= samples[i].x > (1LL << 30);
+    }
+    assert(low_half && high_half);
+
+    assert(lde_samples(make_lde(2, 3, 1), xorshift_fill, &state, 1,
+                       samples) == SAMPLE_INFINITE);
+    assert(lde_samples(make_lde(10, 8, 99), xorshift_fill, &state, 1,
+                       samples) == SAMPLE_EMPTY);
+
+    // A plane over x in [1, 5] and y in (-2, 7)
+    xi = make_interval(1, 5, false, false);
+    Interval yi = make_interval(-2, 7, true, true);
+    lde = make_lde_in(0, 0, 0, xi, yi);
+    assert(lde_samples(lde, xorshift_fill, &state, 1000, samples) == SAMPLE_OK);
+    bool seen[5][8] = {{false}};
+    for (int i = 0; i < 1000; ++i) {
+        assert(is_in_interval(samples[i].x, xi));
+        assert(is_in_interval(samples[i].y, yi));
+        seen[samples[i].x - 1][samples[i].y + 1] = true;
+    }
+    for (int x = 0; x < 5; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            assert(seen[x][y]);
+        }
+    }
+    assert(lde_samples(make_lde_in(0, 0, 0, xi, REAL), xorshift_fill, &state,
+                       1, samples) == SAMPLE_INFINITE);
+}
+
+void test_sample_h() {
+    test_rand_below();
+    test_soln_set_count();
+    test_soln_set_samples();
+}
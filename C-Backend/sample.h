@@ -0,0 +1,136 @@
+/**
+ * "sample.h" counts the solutions of an LDE within the domains of x and y,
+ * and draws solutions uniformly at random from them.
+ *
+ * The solutions are in one-to-one correspondence with the integers of the
+ * n-interval, so both take constant time per solution: a sample is a
+ * uniform n between the ends of the interval, mapped to x and y. Drawing k
+ * samples costs O(k), however many solutions there are.
+ *
+ * Random words are taken from the PRNG a chunk at a time, through one call
+ * of a RandFill, and mapped to n by a 32-bit multiply and a shift (Lemire's
+ * method) in a loop without calls or divisions. GCC vectorises that loop
+ * at -O3; at the default -O2 it stays scalar but branch-free.
+ */
+
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lde.h"
+
+#include <stdint.h>
+
+// Count of a solution set with infinitely many solutions
+#define INF_COUNT UINT64_MAX
+
+/**
+ * Fills an array with uniformly random 64-bit words, so that any PRNG can
+ * be plugged into the sampling functions.
+ *
+ * @param ctx The state of the PRNG, updated in place.
+ * @param words Receives the random words.
+ * @param n Number of words.
+ */
+typedef void (*RandFill)(void *ctx, uint64_t *words, int n);
+
+/**
+ * Outcome of sampling.
+ */
+typedef enum SampleStatus {
+    SAMPLE_OK,          // The samples were drawn
+    SAMPLE_EMPTY,       // The LDE has no solution within the domains
+    SAMPLE_INFINITE,    // There are infinitely many solutions to draw from
+} SampleStatus;
+
+/**
+ * Represents a solution drawn from a solution set.
+ */
+typedef struct Sample {
+    long long n;        // Parameter of the solution, 0 for a plane
+    long long x;        // x value of the solution
+    long long y;        // y value of the solution
+} Sample;
+
+/**
+ * Advances a xorshift64* generator.
+ *
+ * @param state The nonzero state, updated in place.
+ * @return 64 random bits.
+ */
+uint64_t xorshift_next(uint64_t *state);
+
+/**
+ * A RandFill by xorshift64*.
+ *
+ * @param ctx Points to a nonzero uint64_t state.
+ * @param words Receives the random words.
+ * @param n Number of words.
+ */
+void xorshift_fill(void *ctx, uint64_t *words, int n);
+
+/**
+ * Draws integers uniformly from [0, bound), redrawing the few words that
+ * would bias the result.
+ *
+ * @param fill The PRNG.
+ * @param ctx The state of the PRNG.
+ * @param bound The number of possible values, which must not be 0.
+ * @param values Receives the random integers.
+ * @param n Number of integers.
+ */
+void rand_below(RandFill fill, void *ctx, uint32_t bound,
+                uint64_t *values, int n);
+
+/**
+ * Counts the solutions in a solution set in constant time.
+ *
+ * @param set The solution set of an LDE.
+ * @param xi The domain of x.
+ * @param yi The domain of y.
+ * @return The number of solutions, or INF_COUNT if unbounded.
+ */
+uint64_t soln_set_count(SolnSet set, Interval xi, Interval yi);
+
+/**
+ * Draws k solutions uniformly and independently from a finite solution set.
+ *
+ * @param set The solution set of an LDE.
+ * @param xi The domain of x.
+ * @param yi The domain of y.
+ * @param fill The PRNG.
+ * @param ctx The state of the PRNG.
+ * @param k Number of solutions to draw.
+ * @param samples Receives the solutions if SAMPLE_OK is returned.
+ * @return SAMPLE_OK, or why no solution can be drawn.
+ */
+SampleStatus soln_set_samples(SolnSet set, Interval xi, Interval yi,
+                              RandFill fill, void *ctx, int k,
+                              Sample *samples);
+
+/**
+ * Solves an LDE and draws k solutions uniformly from its solutions.
+ *
+ * @param lde The LDE.
+ * @param fill The PRNG.
+ * @param ctx The state of the PRNG.
+ * @param k Number of solutions to draw.
+ * @param samples Receives the solutions if SAMPLE_OK is returned.
+ * @return SAMPLE_OK, or why no solution can be drawn.
+ */
+SampleStatus lde_samples(LDE lde, RandFill fill, void *ctx, int k,
+                         Sample *samples);
+
+/**
+ * Runs unit tests for functions in "sample.h".
+ */
+void test_sample_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
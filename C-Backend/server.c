@@ -0,0 +1,427 @@
+/**
+ * Local solve server.
+ *
+ * Usage: diosolverd [--unix PATH] [--tcp [HOST:]PORT] [--shm NAME]
+ *                   [--threads N]
+ *
+ * Listens on a Unix-domain socket, a TCP socket, or both, and answers
+ * requests in the text protocol of "proto.h" (or JSON lines). The request
+ * "STATS" returns the counters of "stats.h" if built with STATS=1, and
+ * "LATENCY" the latency percentiles of "latency.h", which are also printed
+ * on standard error on SIGUSR1. With --shm, it also creates a shared-memory
+ * ring (see "shmring.h") and serves it on a dedicated thread. Connections
+ * are kept alive, and clients may pipeline any number of requests;
+ * responses are sent in request order.
+ *
+ * Each worker thread runs its own epoll loop and accepts connections from
+ * the shared listening sockets (with EPOLLEXCLUSIVE, so only one worker is
+ * woken per connection). A connection stays on the worker that accepted it,
+ * and its requests are solved on that worker, so no locks are taken on the
+ * request path.
+ */
+
+#define _GNU_SOURCE
+
+#include "diosolver.h"
+#include "proto.h"
+#include "shmring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Maximum number of events handled per epoll_wait()
+#define MAX_EVENTS 64
+
+// Size of each read from a connection
+#define READ_SIZE 16384
+
+// Stop reading from a connection while this much output is pending
+#define MAX_PENDING_OUTPUT (1 << 20)
+
+/**
+ * Kinds of objects registered with epoll.
+ */
+typedef enum Kind {
+    LISTENER,
+    CONNECTION,
+    SHUTDOWN,
+} Kind;
+
+/**
+ * An object registered with epoll. Every registered struct starts with one.
+ */
+typedef struct Handle {
+    Kind kind;
+    int fd;
+} Handle;
+
+/**
+ * A client connection.
+ */
+typedef struct Conn {
+    Handle handle;
+    char *in;           // Bytes received but not yet handled
+    size_t in_len;
+    size_t in_cap;
+    StrBuf out;         // Responses not yet sent
+    size_t out_sent;    // Bytes of out already sent
+    uint32_t events;    // Events registered with epoll
+    bool closing;       // True once no more requests are read
+} Conn;
+
+Handle listeners[2];
+int num_listeners = 0;
+Handle shutdown_handle = {SHUTDOWN, -1};
+
+void on_signal(int sig) {
+    (void) sig;
+    uint64_t one = 1;
+    if (write(shutdown_handle.fd, &one, sizeof(one)) < 0) {
+        // Nothing else can be done in a signal handler
+    }
+}
+
+int listen_unix(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path is too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(path);
+    if (fd < 0 || bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0 ||
+        listen(fd, SOMAXCONN) < 0) {
+        perror(path);
+        return -1;
+    }
+    return fd;
+}
+
+int listen_tcp(const char *spec) {
+    // spec is either "PORT" or "HOST:PORT"
+    char host[256] = "127.0.0.1";
+    const char *port = spec;
+    const char *colon = strrchr(spec, ':');
+    if (colon) {
+        snprintf(host, sizeof(host), "%.*s", (int) (colon - spec), spec);
+        port = colon + 1;
+    }
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    int err = getaddrinfo(host, port, &hints, &res);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", spec, gai_strerror(err));
+        return -1;
+    }
+
+    int fd = socket(res->ai_family,
+                    SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    if (fd >= 0) {
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+    if (fd < 0 || bind(fd, res->ai_addr, res->ai_addrlen) < 0 ||
+        listen(fd, SOMAXCONN) < 0) {
+        perror(spec);
+        freeaddrinfo(res);
+        return -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+void close_conn(int epfd, Conn *conn) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, conn->handle.fd, NULL);
+    close(conn->handle.fd);
+    free(conn->in);
+    strbuf_free(&conn->out);
+    free(conn);
+}
+
+void accept_conns(int epfd, int listen_fd) {
+    while (true) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Conn *conn = calloc(1, sizeof(Conn));
+        conn->handle = (Handle) {CONNECTION, fd};
+        conn->out = make_strbuf();
+        conn->events = EPOLLIN | EPOLLRDHUP;
+
+        struct epoll_event ev = {conn->events, {.ptr = conn}};
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            free(conn);
+        }
+    }
+}
+
+/**
+ * Sends pending output, and registers for EPOLLOUT if the socket is full.
+ *
+ * @return false if the connection failed, or is closing and has sent
+ *         every response.
+ */
+bool flush_conn(int epfd, Conn *conn) {
+    TRACE_BEGIN("output");
+    while (conn->out_sent < conn->out.len) {
+        ssize_t n = send(conn->handle.fd, conn->out.str + conn->out_sent,
+                         conn->out.len - conn->out_sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN) {
+            TRACE_END();
+            return false;
+        }
+        if (n < 0) {
+            break;
+        }
+        conn->out_sent += n;
+    }
+    TRACE_END();
+
+    size_t backlog = conn->out.len - conn->out_sent;
+    if (backlog == 0) {
+        strbuf_clear(&conn->out);
+        conn->out_sent = 0;
+    }
+
+    // Stop reading new requests while a large backlog is pending, and for
+    // good once the client has finished sending
+    bool reading = !conn->closing && backlog < MAX_PENDING_OUTPUT;
+    uint32_t events = (reading ? EPOLLIN | EPOLLRDHUP : 0) |
+                      (backlog > 0 ? EPOLLOUT : 0);
+    if (events != conn->events) {
+        struct epoll_event ev = {events, {.ptr = conn}};
+        epoll_ctl(epfd, EPOLL_CTL_MOD, conn->handle.fd, &ev);
+        conn->events = events;
+    }
+    return backlog > 0 || !conn->closing;
+}
+
+/**
+ * Reads requests, answers every complete line, and sends the responses.
+ * A connection that the client has closed stays open until every response
+ * is sent.
+ *
+ * @return false if the connection failed or is finished.
+ */
+bool serve_conn(int epfd, Conn *conn) {
+    while (!conn->closing) {
+        if (conn->in_cap - conn->in_len < READ_SIZE) {
+            conn->in_cap = conn->in_len + READ_SIZE;
+            conn->in = realloc(conn->in, conn->in_cap);
+        }
+        ssize_t n = recv(conn->handle.fd, conn->in + conn->in_len,
+                         conn->in_cap - conn->in_len, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN) {
+            break;
+        }
+        if (n <= 0) {
+            conn->closing = true;
+            break;
+        }
+        conn->in_len += n;
+        if ((size_t) n < READ_SIZE) {
+            break;
+        }
+    }
+
+    // Answer every complete line received so far, in order
+    char *line = conn->in;
+    char *end = conn->in + conn->in_len;
+    char *newline;
+    while ((newline = memchr(line, '\n', end - line))) {
+        *newline = '\0';
+        if (newline - line > PROTO_MAX_LINE) {
+            strbuf_append(&conn->out, "E line too long\n");
+        } else {
+            proto_handle(line, &conn->out);
+        }
+        line = newline + 1;
+    }
+    if (end - line > PROTO_MAX_LINE) {
+        strbuf_append(&conn->out, "E line too long\n");
+        conn->closing = true;
+        line = end;
+    }
+    conn->in_len = end - line;
+    memmove(conn->in, line, conn->in_len);
+
+    return flush_conn(epfd, conn);
+}
+
+void *worker(void *arg) {
+    (void) arg;
+    trace_thread_name("worker");
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+
+    for (int i = 0; i < num_listeners; ++i) {
+        struct epoll_event ev = {EPOLLIN | EPOLLEXCLUSIVE, {.ptr = &listeners[i]}};
+        epoll_ctl(epfd, EPOLL_CTL_ADD, listeners[i].fd, &ev);
+    }
+    struct epoll_event ev = {EPOLLIN, {.ptr = &shutdown_handle}};
+    epoll_ctl(epfd, EPOLL_CTL_ADD, shutdown_handle.fd, &ev);
+
+    struct epoll_event events[MAX_EVENTS];
+    bool running = true;
+    while (running) {
+        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        for (int i = 0; i < n; ++i) {
+            Handle *handle = events[i].data.ptr;
+            if (handle->kind == SHUTDOWN) {
+                running = false;
+            } else if (handle->kind == LISTENER) {
+                accept_conns(epfd, handle->fd);
+            } else {
+                Conn *conn = (Conn*) handle;
+                bool ok = true;
+                if (events[i].events & EPOLLOUT) {
+                    ok = flush_conn(epfd, conn);
+                }
+                if (ok && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP |
+                                               EPOLLERR))) {
+                    ok = serve_conn(epfd, conn);
+                }
+                if (!ok) {
+                    close_conn(epfd, conn);
+                }
+            }
+        }
+    }
+
+    // Connections still open are released with the process
+    close(epfd);
+    return NULL;
+}
+
+void *serve_ring(void *ring) {
+    trace_thread_name("shm solver");
+    shmring_serve(ring);
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    const char *unix_path = NULL;
+    const char *tcp_spec = NULL;
+    const char *shm_name = NULL;
+    long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; ++i) {
+        if (equal_str(argv[i], "--unix") && i + 1 < argc) {
+            unix_path = argv[++i];
+        } else if (equal_str(argv[i], "--tcp") && i + 1 < argc) {
+            tcp_spec = argv[++i];
+        } else if (equal_str(argv[i], "--shm") && i + 1 < argc) {
+            shm_name = argv[++i];
+        } else if (equal_str(argv[i], "--threads") && i + 1 < argc) {
+            num_threads = atol(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--unix PATH] [--tcp [HOST:]PORT] "
+                            "[--shm NAME] [--threads N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!unix_path && !tcp_spec && !shm_name) {
+        unix_path = "/tmp/diosolver.sock";
+    }
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+
+    if (unix_path) {
+        int fd = listen_unix(unix_path);
+        if (fd < 0) {
+            return 1;
+        }
+        listeners[num_listeners++] = (Handle) {LISTENER, fd};
+    }
+    if (tcp_spec) {
+        int fd = listen_tcp(tcp_spec);
+        if (fd < 0) {
+            return 1;
+        }
+        listeners[num_listeners++] = (Handle) {LISTENER, fd};
+    }
+
+    ShmRing ring = {-1, NULL, NULL, 0, false};
+    if (shm_name) {
+        ring = shmring_create(shm_name, 1024);
+        if (!ring.valid) {
+            perror(shm_name);
+            return 1;
+        }
+    }
+
+    // The eventfd is never reset, so every worker sees it and stops
+    shutdown_handle.fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+    latency_enable();
+    latency_dump_on_signal(SIGUSR1, stderr);
+
+    pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+    for (long i = 0; i < num_threads; ++i) {
+        pthread_create(&threads[i], NULL, worker, NULL);
+    }
+    pthread_t ring_thread;
+    if (ring.valid) {
+        pthread_create(&ring_thread, NULL, serve_ring, &ring);
+    }
+    fprintf(stderr, "diosolverd %s: %ld worker(s) listening on%s%s%s%s%s%s\n",
+            diosolver_version(), num_threads,
+            unix_path ? " unix:" : "", unix_path ? unix_path : "",
+            tcp_spec ? " tcp:" : "", tcp_spec ? tcp_spec : "",
+            shm_name ? " shm:" : "", shm_name ? shm_name : "");
+
+    for (long i = 0; i < num_threads; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    if (ring.valid) {
+        shmring_stop(&ring);
+        pthread_join(ring_thread, NULL);
+        shmring_close(&ring);
+        shmring_unlink(shm_name);
+    }
+
+    for (int i = 0; i < num_listeners; ++i) {
+        close(listeners[i].fd);
+    }
+    if (unix_path) {
+        unlink(unix_path);
+    }
+    return 0;
+}
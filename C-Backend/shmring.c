@@ -0,0 +1,434 @@
+#include "shmring.h"
+#include "latency.h"
+#include "stats.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <assert.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+// Values of ShmSlot.done
+#define SLOT_PENDING 0
+#define SLOT_SOLVED 1
+#define SLOT_WAITING 2
+
+// Longest sleep of a producer before it checks whether the solver stopped
+#define WAIT_TIMEOUT_NS 100000000
+
+#define INVALID_SHMRING (ShmRing) {-1, NULL, NULL, 0, false}
+
+/**
+ * Sleeps while *addr equals val, until woken or the timeout expires.
+ * Falls back to yielding where futexes are unavailable.
+ */
+void futex_wait(uint32_t *addr, uint32_t val, long timeout_ns) {
+#ifdef __linux__
+    struct timespec ts = {timeout_ns / 1000000000, timeout_ns % 1000000000};
+    syscall(SYS_futex, addr, FUTEX_WAIT, val, timeout_ns ? &ts : NULL,
+            NULL, 0);
+#else
+    (void) addr;
+    (void) val;
+    (void) timeout_ns;
+    sched_yield();
+#endif
+}
+
+void futex_wake(uint32_t *addr) {
+#ifdef __linux__
+    syscall(SYS_futex, addr, FUTEX_WAKE, __INT_MAX__, NULL, NULL, 0);
+#else
+    (void) addr;
+#endif
+}
+
+void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * Produces the number of polls before sleeping on this host.
+ */
+int spin_limit() {
+    static int limit = -1;
+    if (limit < 0) {
+        limit = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SHMRING_SPIN : 0;
+    }
+    return limit;
+}
+
+ShmRing map_shmring(int fd, size_t size) {
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return INVALID_SHMRING;
+    }
+
+    ShmRingHeader *header = map;
+    return (ShmRing) {fd, header, (ShmSlot*) (header + 1), size, true};
+}
+
+ShmRing shmring_create(const char *name, int capacity) {
+    uint32_t cap = 1;
+    while (cap < (uint32_t) capacity && cap < (1u << 24)) {
+        cap <<= 1;
+    }
+
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        return INVALID_SHMRING;
+    }
+
+    size_t size = sizeof(ShmRingHeader) + (size_t) cap * sizeof(ShmSlot);
+    if (ftruncate(fd, size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return INVALID_SHMRING;
+    }
+
+    ShmRing ring = map_shmring(fd, size);
+    if (!ring.valid) {
+        shm_unlink(name);
+        return ring;
+    }
+
+    // The memory is zeroed by ftruncate(), so only the tickets need setting
+    for (uint32_t i = 0; i < cap; ++i) {
+        ring.slots[i].seq = i;
+    }
+    *ring.header = (ShmRingHeader) {SHMRING_MAGIC, 0, sizeof(ShmSlot), cap};
+    // Publish the version last, so that shmring_open() sees a complete ring
+    __atomic_store_n(&ring.header->version, SHMRING_VERSION, __ATOMIC_RELEASE);
+    return ring;
+}
+
+ShmRing shmring_open(const char *name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return INVALID_SHMRING;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(ShmRingHeader)) {
+        close(fd);
+        return INVALID_SHMRING;
+    }
+
+    ShmRing ring = map_shmring(fd, st.st_size);
+    if (!ring.valid) {
+        return ring;
+    }
+
+    const ShmRingHeader *header = ring.header;
+    uint32_t cap = header->capacity;
+    if (header->magic != SHMRING_MAGIC ||
+        __atomic_load_n(&header->version, __ATOMIC_ACQUIRE) != SHMRING_VERSION ||
+        header->slot_size != sizeof(ShmSlot) ||
+        cap == 0 || (cap & (cap - 1)) != 0 ||
+        ring.size != sizeof(ShmRingHeader) + (size_t) cap * sizeof(ShmSlot)) {
+        shmring_close(&ring);
+        return INVALID_SHMRING;
+    }
+    return ring;
+}
+
+void shmring_close(ShmRing *ring) {
+    if (!ring->valid) {
+        return;
+    }
+    munmap(ring->header, ring->size);
+    close(ring->fd);
+    *ring = INVALID_SHMRING;
+}
+
+void shmring_unlink(const char *name) {
+    shm_unlink(name);
+}
+
+bool shmring_try_submit(ShmRing *ring, LDE lde, uint32_t *ticket) {
+    ShmRingHeader *header = ring->header;
+    uint32_t mask = header->capacity - 1;
+    uint32_t pos = __atomic_load_n(&header->tail, __ATOMIC_RELAXED);
+    ShmSlot *slot;
+
+    // Claim the slot of the next ticket, unless its previous user holds it
+    while (true) {
+        slot = &ring->slots[pos & mask];
+        int32_t diff = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&header->tail, &pos, pos + 1,
+                                            true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&header->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    cache_record_pack(&slot->record, lde, NO_SOLN_SET);
+    slot->done = SLOT_PENDING;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_SEQ_CST);
+
+    // Only make a system call if the solver is asleep
+    if (__atomic_exchange_n(&header->sleeping, 0, __ATOMIC_SEQ_CST)) {
+        futex_wake(&header->sleeping);
+    }
+    *ticket = pos;
+    return true;
+}
+
+SolnSet shmring_wait(ShmRing *ring, uint32_t ticket) {
+    ShmRingHeader *header = ring->header;
+    ShmSlot *slot = &ring->slots[ticket & (header->capacity - 1)];
+
+    bool solved = false;
+    for (int i = 0; i < spin_limit() && !solved; ++i) {
+        solved = __atomic_load_n(&slot->done, __ATOMIC_ACQUIRE) == SLOT_SOLVED;
+        cpu_relax();
+    }
+    while (!solved) {
+        uint32_t done = SLOT_PENDING;
+        __atomic_compare_exchange_n(&slot->done, &done, SLOT_WAITING, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE);
+        if (done == SLOT_SOLVED) {
+            solved = true;
+        } else if (__atomic_load_n(&header->stopped, __ATOMIC_SEQ_CST)) {
+            break;
+        } else {
+            STAT_COUNT(STAT_RING_SLEEPS, 1);
+            futex_wait(&slot->done, SLOT_WAITING, WAIT_TIMEOUT_NS);
+        }
+    }
+
+    SolnSet set = solved ? cache_record_soln_set(&slot->record) : NO_SOLN_SET;
+    if (solved) {
+        __atomic_store_n(&slot->seq, ticket + header->capacity,
+                         __ATOMIC_RELEASE);
+    }
+    return set;
+}
+
+void shmring_solve_batch(ShmRing *ring, const LDE *ldes, SolnSet *sets, int n) {
+    // Tickets of submitted LDEs, in the order of submission, which is also
+    // the order the solver finishes them
+    uint32_t tickets[256];
+    int max_in_flight = sizeof(tickets) / sizeof(tickets[0]);
+    int submitted = 0;
+    int finished = 0;
+
+    while (finished < n) {
+        while (submitted < n && submitted - finished < max_in_flight &&
+               shmring_try_submit(ring, ldes[submitted],
+                                  &tickets[submitted % max_in_flight])) {
+            ++submitted;
+        }
+        if (submitted == finished &&
+            __atomic_load_n(&ring->header->stopped, __ATOMIC_ACQUIRE)) {
+            sets[finished++] = NO_SOLN_SET;
+            submitted = finished;
+            continue;
+        }
+        if (submitted == finished) {
+            // Other producers fill the ring, so wait for them to free a slot
+            sched_yield();
+            continue;
+        }
+        sets[finished] = shmring_wait(ring, tickets[finished % max_in_flight]);
+        ++finished;
+    }
+}
+
+int shmring_process(ShmRing *ring) {
+    ShmRingHeader *header = ring->header;
+    uint32_t mask = header->capacity - 1;
+    uint32_t head = header->head;
+    int count = 0;
+
+    while (true) {
+        ShmSlot *slot = &ring->slots[head & mask];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != head + 1) {
+            break;
+        }
+
+        LatProbe probe = latency_begin();
+        LDE lde = cache_record_lde(&slot->record);
+        cache_record_pack(&slot->record, lde, lde_soln_set(lde));
+        latency_end(probe, LAT_RING, lde.a, lde.b, lde.c);
+        if (__atomic_exchange_n(&slot->done, SLOT_SOLVED, __ATOMIC_RELEASE) ==
+            SLOT_WAITING) {
+            futex_wake(&slot->done);
+        }
+        ++head;
+        ++count;
+    }
+
+    __atomic_store_n(&header->head, head, __ATOMIC_RELAXED);
+    return count;
+}
+
+void shmring_serve(ShmRing *ring) {
+    ShmRingHeader *header = ring->header;
+    uint32_t mask = header->capacity - 1;
+    int idle = 0;
+
+    while (!__atomic_load_n(&header->stopped, __ATOMIC_ACQUIRE)) {
+        if (shmring_process(ring)) {
+            idle = 0;
+            continue;
+        }
+        if (++idle < spin_limit()) {
+            cpu_relax();
+            continue;
+        }
+
+        // Announce the sleep before checking for work one last time, so that
+        // a producer publishing in between sees it and wakes the solver
+        __atomic_store_n(&header->sleeping, 1, __ATOMIC_SEQ_CST);
+        uint32_t head = header->head;
+        if (__atomic_load_n(&ring->slots[head & mask].seq, __ATOMIC_SEQ_CST) !=
+                head + 1 &&
+            !__atomic_load_n(&header->stopped, __ATOMIC_SEQ_CST)) {
+            STAT_COUNT(STAT_RING_SLEEPS, 1);
+            futex_wait(&header->sleeping, 1, 0);
+        }
+        __atomic_store_n(&header->sleeping, 0, __ATOMIC_RELAXED);
+        idle = 0;
+    }
+}
+
+void shmring_stop(ShmRing *ring) {
+    ShmRingHeader *header = ring->header;
+    __atomic_store_n(&header->stopped, 1, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&header->sleeping, 0, __ATOMIC_SEQ_CST);
+    futex_wake(&header->sleeping);
+}
+
+/**
+ * Arguments of a producer thread in the tests.
+ */
+typedef struct TestProducer {
+    const char *name;
+    const LDE *ldes;
+    SolnSet *sets;
+    int n;
+} TestProducer;
+
+void *test_producer(void *arg) {
+    TestProducer *producer = arg;
+    // Each producer maps the ring itself, as another process would
+    ShmRing ring = shmring_open(producer->name);
+    assert(ring.valid);
+    shmring_solve_batch(&ring, producer->ldes, producer->sets, producer->n);
+    shmring_close(&ring);
+    return NULL;
+}
+
+void *test_solver(void *arg) {
+    shmring_serve(arg);
+    return NULL;
+}
+
+void test_shmring_submit() {
+    char name[64];
+    snprintf(name, sizeof(name), "/diosolver-test-%d", (int) getpid());
+
+    assert(!shmring_open(name).valid);
+    ShmRing ring = shmring_create(name, 3);
+    assert(ring.valid);
+    assert(ring.header->capacity == 4);
+
+    // Results are written back in place, and slots are freed by the producer
+    LDE lde = make_lde_in(9, 5, 137, POS, POS);
+    uint32_t tickets[5];
+    for (int i = 0; i < 4; ++i) {
+        assert(shmring_try_submit(&ring, lde, &tickets[i]));
+        assert(tickets[i] == (uint32_t) i);
+    }
+    assert(!shmring_try_submit(&ring, lde, &tickets[4]));
+    assert(shmring_process(&ring) == 4);
+    assert(shmring_process(&ring) == 0);
+    assert(!shmring_try_submit(&ring, lde, &tickets[4]));
+    assert(equal_soln_set(shmring_wait(&ring, tickets[0]), lde_soln_set(lde)));
+    assert(shmring_try_submit(&ring, make_lde(10, 8, 99), &tickets[4]));
+    assert(shmring_process(&ring) == 1);
+    assert(!shmring_wait(&ring, tickets[4]).exist);
+    for (int i = 1; i < 4; ++i) {
+        assert(equal_soln_set(shmring_wait(&ring, tickets[i]),
+                              lde_soln_set(lde)));
+    }
+
+    // Unsolved LDEs are abandoned once the solver stops
+    assert(shmring_try_submit(&ring, lde, &tickets[0]));
+    shmring_stop(&ring);
+    assert(!shmring_wait(&ring, tickets[0]).exist);
+
+    shmring_close(&ring);
+    assert(!ring.valid);
+    shmring_unlink(name);
+    assert(!shmring_open(name).valid);
+}
+
+void test_shmring_serve() {
+    char name[64];
+    snprintf(name, sizeof(name), "/diosolver-test-%d", (int) getpid());
+
+    enum { NUM_PRODUCERS = 4, NUM_LDES = 3000 };
+    static LDE ldes[NUM_LDES];
+    static SolnSet sets[NUM_PRODUCERS][NUM_LDES];
+    Interval domains[] = {REAL, POS, NEG, NONNEG, make_interval(-50, 50, true, false)};
+    for (int i = 0; i < NUM_LDES; ++i) {
+        ldes[i] = make_lde_in(i % 97 - 48, i % 89 - 44, i % 1009 - 504,
+                              domains[i % 5], domains[i / 5 % 5]);
+    }
+
+    // The ring is smaller than a batch, so producers contend for slots
+    ShmRing ring = shmring_create(name, 64);
+    assert(ring.valid);
+    pthread_t solver;
+    pthread_create(&solver, NULL, test_solver, &ring);
+
+    pthread_t threads[NUM_PRODUCERS];
+    TestProducer producers[NUM_PRODUCERS];
+    for (int i = 0; i < NUM_PRODUCERS; ++i) {
+        producers[i] = (TestProducer) {name, ldes, sets[i], NUM_LDES};
+        pthread_create(&threads[i], NULL, test_producer, &producers[i]);
+    }
+    for (int i = 0; i < NUM_PRODUCERS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    shmring_stop(&ring);
+    pthread_join(solver, NULL);
+
+    for (int i = 0; i < NUM_LDES; ++i) {
+        SolnSet expected = lde_soln_set(ldes[i]);
+        for (int j = 0; j < NUM_PRODUCERS; ++j) {
+            assert(equal_soln_set(sets[j][i], expected));
+        }
+    }
+    assert(ring.header->head == NUM_PRODUCERS * NUM_LDES);
+
+    shmring_close(&ring);
+    shmring_unlink(name);
+}
+
+void test_shmring_h() {
+    test_shmring_submit();
+    test_shmring_serve();
+}
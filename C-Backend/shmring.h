@@ -0,0 +1,184 @@
+/**
+ * "shmring.h" provides a shared-memory ring buffer for submitting LDEs to a
+ * solver in another process on the same host, without a copy or a system
+ * call per request in the common case.
+ *
+ * Any number of producers share one solver (MPSC). A producer claims the
+ * next free slot, packs its LDE into the slot, and publishes it. The solver
+ * takes published slots in order, writes the solution set back into the same
+ * slot, and marks it solved. The producer then reads the result and frees
+ * the slot. Both sides spin briefly before sleeping on a futex, and a waker
+ * only makes a system call if the other side is actually asleep.
+ *
+ * Shared memory layout (host byte order):
+ *   ShmRingHeader                    (192 bytes)
+ *   ShmSlot[capacity]                (capacity is a power of 2)
+ *
+ * The lifetime of the slot of ticket t (arithmetic modulo 2^32) is:
+ *   seq == t                  Free for the producer of ticket t
+ *   seq == t + 1, PENDING     Published, waiting for the solver
+ *   seq == t + 1, SOLVED      Solved, waiting for the producer
+ *   seq == t + capacity       Freed, i.e. free for ticket t + capacity
+ */
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include "cache.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Identifies a ring ("DRNG")
+#define SHMRING_MAGIC 0x474E5244u
+
+// Incremented whenever the layout of ShmRingHeader or ShmSlot changes
+#define SHMRING_VERSION 1
+
+// Number of polls before a producer or the solver goes to sleep.
+// On a single CPU, the other side cannot make progress while one spins,
+// so both sleep right away instead.
+#define SHMRING_SPIN 2000
+
+/**
+ * Header at the beginning of the shared memory. The cursors are kept on
+ * separate cache lines, as producers and the solver write them concurrently.
+ */
+typedef struct ShmRingHeader {
+    uint32_t magic;         // Must be SHMRING_MAGIC
+    uint32_t version;       // Must be SHMRING_VERSION
+    uint32_t slot_size;     // Must be sizeof(ShmSlot)
+    uint32_t capacity;      // Number of slots, a power of 2
+    uint32_t sleeping;      // 1 if the solver sleeps (futex word)
+    uint32_t stopped;       // 1 once shmring_stop() has been called
+    uint32_t reserved[10];
+    uint32_t tail;          // Next ticket to be claimed by a producer
+    uint32_t tail_pad[15];
+    uint32_t head;          // Next ticket to be solved
+    uint32_t head_pad[15];
+} ShmRingHeader;
+
+/**
+ * A single slot in the ring.
+ */
+typedef struct ShmSlot {
+    uint32_t seq;           // Ticket and stage of the slot (see above)
+    uint32_t done;          // Result state (futex word of the producer)
+    CacheRecord record;     // The LDE, and its solution set once solved
+} ShmSlot;
+
+/**
+ * Represents a mapped ring.
+ */
+typedef struct ShmRing {
+    int fd;                 // File descriptor of the shared memory object
+    ShmRingHeader *header;  // Start of the mapped memory
+    ShmSlot *slots;         // Slots following the header
+    size_t size;            // Size of the mapped memory in bytes
+
+    bool valid;             // True if the ring is mapped
+} ShmRing;
+
+/**
+ * Creates a ring, replacing any existing ring of the same name.
+ *
+ * @param name Name of the shared memory object, such as "/diosolver".
+ * @param capacity Number of slots, rounded up to a power of 2.
+ * @return The mapped ring, or a ring with "valid" set to false if the
+ *         shared memory object cannot be created.
+ */
+ShmRing shmring_create(const char *name, int capacity);
+
+/**
+ * Opens an existing ring.
+ *
+ * @param name Name of the shared memory object.
+ * @return The mapped ring, or a ring with "valid" set to false if the ring
+ *         does not exist or has an incompatible format.
+ */
+ShmRing shmring_open(const char *name);
+
+/**
+ * Unmaps a ring. The ring itself stays available to other processes.
+ *
+ * @param ring The ring to close.
+ */
+void shmring_close(ShmRing *ring);
+
+/**
+ * Removes the name of a ring. Processes that have it mapped keep using it.
+ *
+ * @param name Name of the shared memory object.
+ */
+void shmring_unlink(const char *name);
+
+/**
+ * Submits an LDE if a slot is free.
+ *
+ * @param ring The ring to submit to.
+ * @param lde The LDE to be solved.
+ * @param ticket Receives the ticket to pass to shmring_wait().
+ * @return true if the LDE was submitted, false if the ring is full.
+ */
+bool shmring_try_submit(ShmRing *ring, LDE lde, uint32_t *ticket);
+
+/**
+ * Waits for the solution set of a submitted LDE, and frees its slot.
+ * Every ticket must be waited for exactly once.
+ *
+ * @param ring The ring the LDE was submitted to.
+ * @param ticket The ticket from shmring_try_submit().
+ * @return The complete solution set of the LDE, or NO_SOLN_SET if the
+ *         solver stopped before solving it.
+ */
+SolnSet shmring_wait(ShmRing *ring, uint32_t ticket);
+
+/**
+ * Solves a batch of LDEs through the ring, keeping as many in flight as
+ * the ring allows.
+ *
+ * @param ring The ring to submit to.
+ * @param ldes The LDEs to be solved.
+ * @param sets Receives the solution set of each LDE.
+ * @param n Number of LDEs.
+ */
+void shmring_solve_batch(ShmRing *ring, const LDE *ldes, SolnSet *sets, int n);
+
+/**
+ * Solves every LDE published so far. Only one process or thread may
+ * act as the solver of a ring at any time.
+ *
+ * @param ring The ring to serve.
+ * @return The number of LDEs solved.
+ */
+int shmring_process(ShmRing *ring);
+
+/**
+ * Solves LDEs as they are published, sleeping while the ring is empty,
+ * until shmring_stop() is called.
+ *
+ * @param ring The ring to serve.
+ */
+void shmring_serve(ShmRing *ring);
+
+/**
+ * Makes shmring_serve() return, and wakes any producers still waiting.
+ *
+ * @param ring The ring to stop.
+ */
+void shmring_stop(ShmRing *ring);
+
+/**
+ * Runs unit tests for functions in "shmring.h".
+ */
+void test_shmring_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
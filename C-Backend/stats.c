@@ -0,0 +1,289 @@
+#include "stats.h"
+#include "betterc.h"
+#include "memstat.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <assert.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * Counters of a thread. Only the thread itself writes them, so updates need
+ * no atomic read-modify-write; stats_snapshot() reads them with atomic loads.
+ */
+typedef struct ThreadStats {
+    Stats stats;
+    struct ThreadStats *prev;
+    struct ThreadStats *next;
+} ThreadStats;
+
+// Counters of running threads, the sum of the counters of exited threads,
+// and the sum at the last stats_reset(), all guarded by stats_lock
+pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+ThreadStats *thread_list;
+Stats exited_stats;
+Stats reset_stats;
+
+pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+pthread_key_t stats_key;
+
+_Thread_local ThreadStats *local_stats;
+_Thread_local StatPhase current_phase = NUM_STAT_PHASES;
+_Thread_local uint64_t phase_start;
+
+const char *stat_phase_names[NUM_STAT_PHASES] = {
+    "eea", "particular", "ineq", "render",
+};
+
+const char *stat_counter_names[NUM_STAT_COUNTERS] = {
+    "solves", "eea_steps", "lines", "bytes", "cache_misses", "ring_sleeps",
+};
+
+void add_stats(Stats *sum, const Stats *stats, int sign) {
+    for (int i = 0; i < NUM_STAT_PHASES; ++i) {
+        sum->calls[i] += sign * __atomic_load_n(&stats->calls[i], __ATOMIC_RELAXED);
+        sum->cycles[i] += sign * __atomic_load_n(&stats->cycles[i], __ATOMIC_RELAXED);
+    }
+    for (int i = 0; i < NUM_STAT_COUNTERS; ++i) {
+        sum->counts[i] += sign * __atomic_load_n(&stats->counts[i], __ATOMIC_RELAXED);
+    }
+}
+
+void retire_thread_stats(void *ptr) {
+    ThreadStats *ts = ptr;
+    pthread_mutex_lock(&stats_lock);
+    add_stats(&exited_stats, &ts->stats, 1);
+    if (ts->prev) {
+        ts->prev->next = ts->next;
+    } else {
+        thread_list = ts->next;
+    }
+    if (ts->next) {
+        ts->next->prev = ts->prev;
+    }
+    pthread_mutex_unlock(&stats_lock);
+    free(ts);
+}
+
+void create_stats_key() {
+    pthread_key_create(&stats_key, retire_thread_stats);
+}
+
+ThreadStats *register_thread_stats() {
+    ThreadStats *ts = calloc(1, sizeof(ThreadStats));
+    if (!ts) {
+        abort();
+    }
+    pthread_once(&stats_once, create_stats_key);
+    pthread_setspecific(stats_key, ts);
+
+    pthread_mutex_lock(&stats_lock);
+    ts->next = thread_list;
+    if (thread_list) {
+        thread_list->prev = ts;
+    }
+    thread_list = ts;
+    pthread_mutex_unlock(&stats_lock);
+
+    local_stats = ts;
+    return ts;
+}
+
+void add_relaxed(uint64_t *counter, uint64_t n) {
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + n,
+                     __ATOMIC_RELAXED);
+}
+
+bool stats_enabled() {
+#ifdef DIO_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t stat_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+double cycles_per_ns;
+
+void measure_cycles_per_ns() {
+    struct timespec start;
+    struct timespec end;
+    struct timespec pause = {0, 20000000};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t start_cycles = stat_cycles();
+    nanosleep(&pause, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    uint64_t end_cycles = stat_cycles();
+
+    double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    cycles_per_ns = (end_cycles - start_cycles) / ns;
+}
+
+double stat_cycles_per_ns() {
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, measure_cycles_per_ns);
+    return cycles_per_ns;
+}
+
+StatPhase stat_enter(StatPhase phase) {
+    uint64_t now = stat_cycles();
+    ThreadStats *ts = local_stats ? local_stats : register_thread_stats();
+    StatPhase outer = current_phase;
+    if (outer != NUM_STAT_PHASES) {
+        add_relaxed(&ts->stats.cycles[outer], now - phase_start);
+    }
+    add_relaxed(&ts->stats.calls[phase], 1);
+    current_phase = phase;
+    phase_start = now;
+    return outer;
+}
+
+void stat_leave(StatPhase outer) {
+    uint64_t now = stat_cycles();
+    ThreadStats *ts = local_stats ? local_stats : register_thread_stats();
+    if (current_phase != NUM_STAT_PHASES) {
+        add_relaxed(&ts->stats.cycles[current_phase], now - phase_start);
+    }
+    current_phase = outer;
+    phase_start = now;
+}
+
+void stat_count(StatCounter counter, uint64_t n) {
+    ThreadStats *ts = local_stats ? local_stats : register_thread_stats();
+    add_relaxed(&ts->stats.counts[counter], n);
+}
+
+const char *stat_phase_name(StatPhase phase) {
+    return stat_phase_names[phase];
+}
+
+const char *stat_counter_name(StatCounter counter) {
+    return stat_counter_names[counter];
+}
+
+/**
+ * Sums the counters of all threads since the program started.
+ * stats_lock must be held.
+ */
+Stats total_stats() {
+    Stats sum = exited_stats;
+    for (ThreadStats *ts = thread_list; ts; ts = ts->next) {
+        add_stats(&sum, &ts->stats, 1);
+    }
+    return sum;
+}
+
+Stats stats_snapshot() {
+    pthread_mutex_lock(&stats_lock);
+    Stats stats = total_stats();
+    add_stats(&stats, &reset_stats, -1);
+    pthread_mutex_unlock(&stats_lock);
+    return stats;
+}
+
+void stats_reset() {
+    pthread_mutex_lock(&stats_lock);
+    reset_stats = total_stats();
+    pthread_mutex_unlock(&stats_lock);
+}
+
+char *stats_to_str(Stats stats) {
+    double per_ns = stat_cycles_per_ns();
+    StrBuf buf = make_strbuf();
+    strbuf_append(&buf, "%-12s %12s %16s %12s %12s\n",
+                  "phase", "calls", "cycles", "cycles/call", "us");
+    for (int i = 0; i < NUM_STAT_PHASES; ++i) {
+        double per_call = stats.calls[i] ? (double) stats.cycles[i] / stats.calls[i] : 0;
+        strbuf_append(&buf, "%-12s %12llu %16llu %12.1f %12.1f\n",
+                      stat_phase_names[i], (unsigned long long) stats.calls[i],
+                      (unsigned long long) stats.cycles[i], per_call,
+                      stats.cycles[i] / per_ns / 1e3);
+    }
+    for (int i = 0; i < NUM_STAT_COUNTERS; ++i) {
+        strbuf_append(&buf, "%-12s %12llu\n", stat_counter_names[i],
+                      (unsigned long long) stats.counts[i]);
+    }
+    return buf.str;
+}
+
+void *test_stats_thread(void *arg) {
+    (void) arg;
+    stat_count(STAT_SOLVES, 5);
+    StatPhase outer = stat_enter(STAT_RENDER);
+    stat_leave(outer);
+    return NULL;
+}
+
+void test_stat_phases() {
+    stats_reset();
+
+    // Nested phases charge their cycles to the innermost phase only
+    StatPhase outer = stat_enter(STAT_RENDER);
+    StatPhase inner = stat_enter(STAT_INEQ);
+    uint64_t start = stat_cycles();
+    assert(inner == STAT_RENDER);
+    while (stat_cycles() - start < 100000) {
+    }
+    stat_leave(inner);
+    stat_leave(outer);
+    assert(outer == NUM_STAT_PHASES);
+
+    Stats stats = stats_snapshot();
+    assert(stats.calls[STAT_RENDER] == 1);
+    assert(stats.calls[STAT_INEQ] == 1);
+    assert(stats.calls[STAT_EEA] == 0);
+    assert(stats.cycles[STAT_INEQ] >= 100000);
+}
+
+void test_stat_threads() {
+    stats_reset();
+    stat_count(STAT_SOLVES, 2);
+
+    // Counters of exited threads are kept
+    pthread_t threads[4];
+    for (int i = 0; i < 4; ++i) {
+        pthread_create(&threads[i], NULL, test_stats_thread, NULL);
+    }
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    Stats stats = stats_snapshot();
+    assert(stats.counts[STAT_SOLVES] == 22);
+    assert(stats.calls[STAT_RENDER] == 4);
+
+    stats_reset();
+    assert(stats_snapshot().counts[STAT_SOLVES] == 0);
+}
+
+void test_stats_to_str() {
+    Stats stats = {0};
+    stats.calls[STAT_EEA] = 2;
+    stats.counts[STAT_EEA_STEPS] = 44;
+    char *str = stats_to_str(stats);
+    assert(str[0] == 'p');
+    char *line = fstr("%-12s %12llu\n", "eea_steps", 44ull);
+    assert(strstr(str, line));
+    dio_free(line);
+    dio_free(str);
+}
+
+void test_stats_h() {
+    test_stat_phases();
+    test_stat_threads();
+    test_stats_to_str();
+}
@@ -0,0 +1,163 @@
+/**
+ * "stats.h" provides optional timing and counters for the phases of a solve,
+ * to find out where the time of a slow solve goes.
+ *
+ * The backend marks its phases with STAT_ENTER() and STAT_LEAVE(), and its
+ * events with STAT_COUNT(). These expand to nothing unless the backend is
+ * built with DIO_STATS defined (make STATS=1). Otherwise, each thread
+ * accumulates the CPU cycles spent in every phase and the counts of every
+ * event in its own counters, without locks, and stats_snapshot() sums the
+ * counters of all threads.
+ *
+ * Phases may be nested, such as the EEA inside rendering the steps. The
+ * cycles of a nested phase are charged to it only, not to the enclosing
+ * phase, so the cycles of all phases add up to the instrumented time.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Phases of a solve.
+ */
+typedef enum StatPhase {
+    STAT_EEA,           // EEA tables and rows
+    STAT_PARTICULAR,    // Particular solutions from an EEA row
+    STAT_INEQ,          // solve_ineq_sys() and int_interval()
+    STAT_RENDER,        // Formatting the steps and solution sets as text
+    NUM_STAT_PHASES,
+} StatPhase;
+
+/**
+ * Counted events.
+ */
+typedef enum StatCounter {
+    STAT_SOLVES,        // Solution sets and steps produced
+    STAT_EEA_STEPS,     // Division steps of the EEA
+    STAT_LINES,         // Lines of steps rendered
+    STAT_BYTES,         // Bytes of text rendered
+    STAT_CACHE_MISSES,  // Cache lookups that fell back to a full solve
+    STAT_RING_SLEEPS,   // Ring waits that fell back from spinning to a futex
+    NUM_STAT_COUNTERS,
+} StatCounter;
+
+#ifdef DIO_STATS
+#define STAT_ENTER(phase) StatPhase stat_outer_phase = stat_enter(phase)
+#define STAT_LEAVE() stat_leave(stat_outer_phase)
+#define STAT_COUNT(counter, n) stat_count(counter, n)
+#else
+#define STAT_ENTER(phase)
+#define STAT_LEAVE()
+#define STAT_COUNT(counter, n)
+#endif
+
+/**
+ * Represents the counters of one thread or of the whole process.
+ */
+typedef struct Stats {
+    uint64_t calls[NUM_STAT_PHASES];    // Number of times each phase started
+    uint64_t cycles[NUM_STAT_PHASES];   // Cycles spent in each phase
+    uint64_t counts[NUM_STAT_COUNTERS]; // Number of each event
+} Stats;
+
+/**
+ * Checks if the backend was built with DIO_STATS defined.
+ *
+ * @return true if the phases of the backend are timed and counted.
+ */
+bool stats_enabled();
+
+/**
+ * Reads the cycle counter (the time stamp counter on x86, or a monotonic
+ * clock in nanoseconds elsewhere).
+ *
+ * @return The current cycle count.
+ */
+uint64_t stat_cycles();
+
+/**
+ * Produces the number of cycles per nanosecond, measured on the first call.
+ *
+ * @return The rate of stat_cycles().
+ */
+double stat_cycles_per_ns();
+
+/**
+ * Starts a phase on the calling thread. Used through STAT_ENTER().
+ *
+ * @param phase The phase to start.
+ * @return The phase that was running, to be passed to stat_leave().
+ */
+StatPhase stat_enter(StatPhase phase);
+
+/**
+ * Ends the current phase on the calling thread, and resumes the phase that
+ * was running before. Used through STAT_LEAVE().
+ *
+ * @param outer The phase returned by stat_enter().
+ */
+void stat_leave(StatPhase outer);
+
+/**
+ * Counts events on the calling thread. Used through STAT_COUNT().
+ *
+ * @param counter The kind of event.
+ * @param n Number of events.
+ */
+void stat_count(StatCounter counter, uint64_t n);
+
+/**
+ * Produces the name of a phase, such as "eea".
+ *
+ * @param phase The phase.
+ * @return A static string.
+ */
+const char *stat_phase_name(StatPhase phase);
+
+/**
+ * Produces the name of a counter, such as "eea_steps".
+ *
+ * @param counter The counter.
+ * @return A static string.
+ */
+const char *stat_counter_name(StatCounter counter);
+
+/**
+ * Sums the counters of all threads, including threads that have exited,
+ * since the last call to stats_reset().
+ *
+ * @return The counters of the process.
+ */
+Stats stats_snapshot();
+
+/**
+ * Starts counting from zero again in stats_snapshot().
+ */
+void stats_reset();
+
+/**
+ * Converts counters to a table with one line per phase and per counter.
+ *
+ * @param stats The counters to convert.
+ * @return A dynamically allocated string.
+ *         Make sure to call dio_free() after usage.
+ */
+char *stats_to_str(Stats stats);
+
+/**
+ * Runs unit tests for functions in "stats.h".
+ */
+void test_stats_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
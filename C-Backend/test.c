@@ -0,0 +1,31 @@
+/**
+ * Runs the unit tests of every module in the C backend.
+ */
+
+#include "diosolver.h"
+
+#include <stdio.h>
+
+int main() {
+    test_betterc_h();
+    test_memstat_h();
+    test_stats_h();
+    test_trace_h();
+    test_eea_h();
+    test_intvl_h();
+    test_ineq_h();
+    test_lde_h();
+    test_cache_h();
+    test_jsonl_h();
+    test_proto_h();
+    test_shmring_h();
+    test_corpus_h();
+    test_optim_h();
+    test_nearest_h();
+    test_sample_h();
+    test_frob_h();
+    test_latency_h();
+
+    printf("All tests passed.\n");
+    return 0;
+}
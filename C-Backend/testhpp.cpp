@@ -0,0 +1,201 @@
+/**
+ * Runs the unit tests of the C++ headers of the backend, checking their
+ * results against the C functions that they mirror.
+ */
+
+#include "diosolver.h"
+#include "diosolver.hpp"
+#include "eea.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <ranges>
+#include <string>
+#include <vector>
+
+// Evaluated by the compiler, so a mistake fails the build
+static_assert(dio::const_gcd(240, 46) == 2);
+static_assert(dio::const_gcd(-5, 0) == 5);
+static_assert(dio::const_eea_table_size(5, -7) == 5);
+static_assert(dio::ConstLDE<9, 5>::prep.d == 1);
+static_assert(dio::ConstLDE<9, 5>::particular(137).x == -137);
+static_assert(dio::ConstLDE<9, 5>::particular(137).y == 274);
+static_assert(!dio::ConstLDE<10, 8>::particular(99).exist);
+static_assert(dio::ConstLDE<7, 5>::particular(1000000000).y == 200000000);
+static_assert(dio::ConstLDE<1346269, 832040>::table.size() == 31);
+
+/**
+ * Checks ConstLDE<A, B> against the C functions for many c and domains.
+ */
+template <int A, int B>
+void check_const_lde() {
+    using Const = dio::ConstLDE<A, B>;
+
+    EEA_Table table = eea_table(A, B);
+    assert(table.size == (int) Const::table.size());
+    for (int i = 0; i < table.size; ++i) {
+        assert(equal_eear(list_at(table, i, EEAR), Const::table[i]));
+    }
+    list_free(table);
+
+    PreparedLDE prep = prepare_lde(A, B);
+    assert(prep.d == Const::prep.d && prep.x1 == Const::prep.x1 &&
+           prep.y1 == Const::prep.y1 && prep.dx == Const::prep.dx &&
+           prep.dy == Const::prep.dy);
+
+    const Interval domains[] = {
+        make_interval(NEG_INF, POS_INF, true, true),
+        make_interval(0, POS_INF, true, true),
+        make_interval(NEG_INF, 0, true, false),
+        make_interval(-50, 75, false, true),
+        make_interval(3, 4, true, true),
+    };
+    const int cs[] = {0, 1, -1, 2, 7, -99, 137, -1000, 1000000000, POS_INF,
+                      NEG_INF};
+    for (int c : cs) {
+        if constexpr (A != 0 && B != 0) {
+            Solution soln = eea_lde(make_lde(A, B, c));
+            Solution const_soln = Const::particular(c);
+            assert(soln.exist == const_soln.exist);
+            assert(!soln.exist || (soln.x == const_soln.x &&
+                                   soln.y == const_soln.y));
+        }
+        for (Interval xi : domains) {
+            for (Interval yi : domains) {
+                SolnSet set = lde_soln_set(make_lde_in(A, B, c, xi, yi));
+                assert(equal_soln_set(Const::soln_set(c, xi, yi), set));
+            }
+        }
+    }
+}
+
+void test_const_lde() {
+    check_const_lde<9, 5>();
+    check_const_lde<-9, 5>();
+    check_const_lde<5, -7>();
+    check_const_lde<10, 8>();
+    check_const_lde<-12, -18>();
+    check_const_lde<5, 5>();
+    check_const_lde<1, 1>();
+    check_const_lde<1346269, -832040>();
+    check_const_lde<2147483646, 1000000007>();
+    check_const_lde<0, 7>();
+    check_const_lde<-3, 0>();
+    check_const_lde<0, 0>();
+}
+
+void test_eea_hpp() {
+    test_const_lde();
+}
+
+void test_eea_table_owner() {
+    dio::EEATable table(5, -7);
+    EEA_Table c_table = eea_table(5, -7);
+    assert(table.size() == 5 && table.gcd() == 1);
+    int i = 0;
+    for (const EEAR &row : table) {
+        assert(equal_eear(row, list_at(c_table, i, EEAR)));
+        ++i;
+    }
+    list_free(c_table);
+
+    dio::EEATable moved(std::move(table));
+    assert(table.size() == 0 && table.rows().empty());
+    assert(moved.size() == 5 && equal_eear(moved[2], make_eear(1, -1, 2, 1)));
+
+    table = dio::EEATable(10, 8);
+    assert(table.gcd() == 2);
+}
+
+void test_result() {
+    LDE lde = make_lde_in(9, 5, 137, make_interval(0, POS_INF, true, true),
+                          make_interval(0, POS_INF, true, true));
+    dio::Result result(lde);
+    List c_result = lde_result(lde);
+    assert(result.size() == (size_t) c_result.size);
+    size_t i = 0;
+    for (std::string_view line : result) {
+        assert(line == list_at(c_result, i, char*));
+        assert(result[i] == line);
+        ++i;
+    }
+    assert(i == result.size());
+    lde_result_free(c_result);
+
+    // The same lines are streamed by steps(), with or without the table
+    std::vector<std::string> lines;
+    assert(dio::steps(lde, [&lines] (std::string_view line) {
+        lines.emplace_back(line);
+        return true;
+    }));
+    assert(std::ranges::equal(lines, result));
+
+    dio::EEATable table(lde.a, lde.b);
+    lines.clear();
+    assert(dio::steps(lde, table, [&lines] (std::string_view line) {
+        lines.emplace_back(line);
+        return true;
+    }));
+    assert(std::ranges::equal(lines, result));
+
+    int calls = 0;
+    assert(!dio::steps(lde, [&calls] (std::string_view) {
+        return ++calls < 2;
+    }));
+    assert(calls == 2);
+
+    dio::Result moved(std::move(result));
+    assert(result.size() == 0 && result.begin() == result.end());
+    assert(moved.size() == i);
+}
+
+void test_solutions() {
+    LDE lde = make_lde_in(9, 5, 137, make_interval(0, POS_INF, true, true),
+                          make_interval(0, POS_INF, true, true));
+    SolnSet set = lde_soln_set(lde);
+    dio::Solutions solutions(set);
+    assert(!solutions.infinite() && solutions.size() == 3);
+    long long n = 28;
+    for (dio::SolnPoint point : solutions) {
+        assert(point.n == n++);
+        assert(9 * point.x + 5 * point.y == 137);
+        assert(point.x > 0 && point.y > 0);
+    }
+    assert(n == 31);
+
+    dio::CString str = dio::soln_set_str(set);
+    char *c_str = soln_set_to_str(set);
+    assert(str.view() == c_str);
+    dio_free(c_str);
+
+    // An unbounded set is cut off at the range of int, and can be taken
+    // from lazily
+    dio::Solutions unbounded(lde_soln_set(make_lde(2, 3, 1)));
+    assert(unbounded.infinite());
+    assert(unbounded.size() == 2LL * POS_INF + 1);
+    std::vector<dio::SolnPoint> points;
+    for (dio::SolnPoint point : unbounded | std::views::take(3)) {
+        points.push_back(point);
+    }
+    assert(points.size() == 3 && points[0].n == NEG_INF);
+    assert(points[2] == unbounded.at(NEG_INF + 2));
+    assert(2 * points[2].x + 3 * points[2].y == 1);
+
+    assert(dio::Solutions(lde_soln_set(make_lde(10, 8, 99))).empty());
+    assert(dio::Solutions(lde_soln_set(make_lde(0, 0, 0))).empty());
+}
+
+void test_diosolver_hpp() {
+    test_eea_table_owner();
+    test_result();
+    test_solutions();
+}
+
+int main() {
+    test_eea_hpp();
+    test_diosolver_hpp();
+
+    printf("All C++ tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,324 @@
+#include "trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <assert.h>
+
+/**
+ * A finished span.
+ */
+typedef struct TraceEvent {
+    const char *name;
+    uint64_t start_ns;
+    uint64_t dur_ns;
+} TraceEvent;
+
+/**
+ * Spans of a thread. Only the thread itself appends to it; trace_write()
+ * reads the events published by count.
+ */
+typedef struct TraceBuffer {
+    int tid;                            // Thread number in the trace
+    const char *name;                   // Thread name, or NULL
+    uint32_t count;                     // Number of events published
+    uint32_t dropped;                   // Number of events that did not fit
+    int depth;                          // Number of open spans
+    TraceEvent open[TRACE_MAX_DEPTH];   // Open spans, innermost last
+    TraceEvent events[TRACE_MAX_EVENTS];
+    bool retired;                       // True once its thread has exited
+    struct TraceBuffer *next;
+} TraceBuffer;
+
+bool trace_on = false;
+
+// Buffers of all threads that recorded a span, newest first. Buffers are
+// never freed, as trace_write() may still be reading them; the buffer of an
+// exited thread is taken over by the next thread that records a span, which
+// continues its timeline under the same tid.
+TraceBuffer *trace_buffers;
+int trace_num_threads;
+
+pthread_once_t trace_once = PTHREAD_ONCE_INIT;
+pthread_key_t trace_key;
+
+// Start of the current trace, and the file to write it to
+uint64_t trace_epoch_ns;
+char *trace_path;
+
+_Thread_local TraceBuffer *local_buffer;
+_Thread_local const char *local_name;
+
+uint64_t trace_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void retire_trace_buffer(void *ptr) {
+    TraceBuffer *buf = ptr;
+    buf->depth = 0;
+    __atomic_store_n(&buf->retired, true, __ATOMIC_RELEASE);
+}
+
+void create_trace_key() {
+    pthread_key_create(&trace_key, retire_trace_buffer);
+}
+
+/**
+ * Takes over the buffer of an exited thread.
+ *
+ * @return The buffer, or NULL if every thread with a buffer is running.
+ */
+TraceBuffer *reuse_trace_buffer() {
+    for (TraceBuffer *buf = __atomic_load_n(&trace_buffers, __ATOMIC_ACQUIRE);
+         buf; buf = buf->next) {
+        bool retired = true;
+        if (__atomic_load_n(&buf->retired, __ATOMIC_RELAXED) &&
+            __atomic_compare_exchange_n(&buf->retired, &retired, false, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return buf;
+        }
+    }
+    return NULL;
+}
+
+TraceBuffer *register_trace_buffer() {
+    pthread_once(&trace_once, create_trace_key);
+    TraceBuffer *buf = reuse_trace_buffer();
+    if (!buf) {
+        buf = calloc(1, sizeof(TraceBuffer));
+        if (!buf) {
+            return NULL;
+        }
+        buf->tid = __atomic_add_fetch(&trace_num_threads, 1, __ATOMIC_RELAXED);
+
+        // Push without a lock, so that registering never blocks on a writer
+        buf->next = __atomic_load_n(&trace_buffers, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&trace_buffers, &buf->next, buf,
+                                            true, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED)) {
+        }
+    }
+    buf->name = local_name;
+    pthread_setspecific(trace_key, buf);
+    local_buffer = buf;
+    return buf;
+}
+
+bool trace_start(const char *path) {
+    if (trace_on) {
+        return false;
+    }
+    free(trace_path);
+    trace_path = path ? strdup(path) : NULL;
+
+    // Buffers of an earlier trace start over. Spans still open when it
+    // finished were never ended, so they are forgotten; spans still open
+    // now are left out by their start time.
+    for (TraceBuffer *buf = __atomic_load_n(&trace_buffers, __ATOMIC_ACQUIRE);
+         buf; buf = buf->next) {
+        __atomic_store_n(&buf->count, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&buf->depth, 0, __ATOMIC_RELAXED);
+        buf->dropped = 0;
+    }
+    trace_epoch_ns = trace_now_ns();
+    __atomic_store_n(&trace_on, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool trace_finish() {
+    __atomic_store_n(&trace_on, false, __ATOMIC_RELEASE);
+    if (!trace_path) {
+        return true;
+    }
+
+    FILE *out = fopen(trace_path, "w");
+    if (!out) {
+        return false;
+    }
+    trace_write(out);
+    bool ok = !ferror(out);
+    ok = !fclose(out) && ok;
+    free(trace_path);
+    trace_path = NULL;
+    return ok;
+}
+
+void trace_thread_name(const char *name) {
+    local_name = name;
+    if (local_buffer) {
+        local_buffer->name = name;
+    }
+}
+
+void trace_begin(const char *name) {
+    TraceBuffer *buf = local_buffer ? local_buffer : register_trace_buffer();
+    if (!buf) {
+        return;
+    }
+    if (buf->depth < TRACE_MAX_DEPTH) {
+        buf->open[buf->depth] = (TraceEvent) {name, trace_now_ns(), 0};
+    }
+    ++buf->depth;
+}
+
+void trace_end() {
+    TraceBuffer *buf = local_buffer;
+    if (!buf || buf->depth == 0) {
+        return;
+    }
+    if (--buf->depth >= TRACE_MAX_DEPTH) {
+        return;
+    }
+
+    TraceEvent event = buf->open[buf->depth];
+    event.dur_ns = trace_now_ns() - event.start_ns;
+    uint32_t count = buf->count;
+    if (count == TRACE_MAX_EVENTS) {
+        ++buf->dropped;
+        return;
+    }
+    buf->events[count] = event;
+    __atomic_store_n(&buf->count, count + 1, __ATOMIC_RELEASE);
+}
+
+void write_trace_event(FILE *out, const TraceEvent *event, int pid, int tid) {
+    fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+            "\"pid\":%d,\"tid\":%d}", event->name,
+            (event->start_ns - trace_epoch_ns) / 1e3, event->dur_ns / 1e3,
+            pid, tid);
+}
+
+long trace_write(FILE *out) {
+    int pid = getpid();
+    long written = 0;
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+            "\"args\":{\"name\":\"diosolver\"}}", pid);
+
+    for (TraceBuffer *buf = __atomic_load_n(&trace_buffers, __ATOMIC_ACQUIRE);
+         buf; buf = buf->next) {
+        if (buf->name) {
+            fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                    "\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    pid, buf->tid, buf->name);
+        }
+        if (buf->dropped) {
+            fprintf(out, ",\n{\"name\":\"dropped %u spans\",\"ph\":\"i\","
+                    "\"s\":\"t\",\"ts\":0,\"pid\":%d,\"tid\":%d}",
+                    buf->dropped, pid, buf->tid);
+        }
+
+        uint32_t count = __atomic_load_n(&buf->count, __ATOMIC_ACQUIRE);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (buf->events[i].start_ns >= trace_epoch_ns) {
+                write_trace_event(out, &buf->events[i], pid, buf->tid);
+                ++written;
+            }
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+    return written;
+}
+
+void finish_trace_at_exit() {
+    if (!trace_finish()) {
+        perror("DIO_TRACE");
+    }
+}
+
+__attribute__((constructor))
+void start_trace_from_env() {
+    const char *path = getenv("DIO_TRACE");
+    if (path && *path && trace_start(path)) {
+        atexit(finish_trace_at_exit);
+    }
+}
+
+void *test_trace_thread(void *arg) {
+    trace_thread_name(arg);
+    TRACE_BEGIN("worker_span");
+    TRACE_END();
+    return NULL;
+}
+
+void test_trace_spans() {
+    // Leave a trace requested through DIO_TRACE alone
+    if (trace_on) {
+        return;
+    }
+
+    // Spans outside a trace are not recorded
+    TRACE_BEGIN("ignored");
+    TRACE_END();
+
+    char path[] = "/tmp/diosolver-trace-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    assert(trace_start(path));
+    assert(!trace_start(path));
+
+    trace_thread_name("main");
+    TRACE_BEGIN("outer");
+    TRACE_BEGIN("inner");
+    TRACE_END();
+    TRACE_END();
+    TRACE_END();
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, test_trace_thread, "test worker");
+    pthread_join(thread, NULL);
+    assert(trace_finish());
+
+    FILE *in = fopen(path, "r");
+    char json[4096];
+    size_t len = fread(json, 1, sizeof(json) - 1, in);
+    json[len] = '\0';
+    fclose(in);
+    unlink(path);
+
+    assert(!strncmp(json, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 39));
+    assert(strstr(json, "{\"name\":\"inner\",\"ph\":\"X\",\"ts\":"));
+    assert(strstr(json, "{\"name\":\"outer\",\"ph\":\"X\",\"ts\":"));
+    assert(strstr(json, "{\"name\":\"worker_span\",\"ph\":\"X\",\"ts\":"));
+    assert(strstr(json, "\"args\":{\"name\":\"test worker\"}"));
+    assert(!strstr(json, "ignored"));
+    assert(!strcmp(json + len - 4, "\n]}\n"));
+}
+
+void test_trace_restart() {
+    if (trace_on) {
+        return;
+    }
+
+    // The buffer of an exited thread is taken over by the next thread
+    assert(trace_start(NULL));
+    pthread_t thread;
+    pthread_create(&thread, NULL, test_trace_thread, "first worker");
+    pthread_join(thread, NULL);
+    int num_threads = trace_num_threads;
+    pthread_create(&thread, NULL, test_trace_thread, "second worker");
+    pthread_join(thread, NULL);
+    assert(trace_num_threads == num_threads);
+
+    // A span left open when a trace finishes is forgotten by the next one
+    TRACE_BEGIN("unfinished");
+    assert(trace_finish());
+    assert(trace_start(NULL));
+    assert(local_buffer->depth == 0);
+    TRACE_BEGIN("restarted");
+    TRACE_END();
+    assert(local_buffer->count == 1 && local_buffer->depth == 0);
+    assert(!strcmp(local_buffer->events[0].name, "restarted"));
+    assert(trace_finish());
+}
+
+void test_trace_h() {
+    test_trace_spans();
+    test_trace_restart();
+}
@@ -0,0 +1,100 @@
+/**
+ * "trace.h" provides an opt-in tracer that records what the solver did as
+ * a timeline, for latency investigations.
+ *
+ * The backend marks spans such as "parse", "eea" or "render" with
+ * TRACE_BEGIN() and TRACE_END(). While tracing is off, each mark costs a
+ * single branch. Once tracing is on, each thread appends its finished spans
+ * to its own buffer without locks, and trace_write() exports every buffer
+ * in the Chrome trace event format, which chrome://tracing and Perfetto
+ * (ui.perfetto.dev) open directly. The buffer of a thread that exits is
+ * taken over by the next thread to record a span, so there are never more
+ * buffers than threads running at once.
+ *
+ * Any program linked with the backend starts tracing when the environment
+ * variable DIO_TRACE is set, and writes the trace to the file it names when
+ * the program exits:
+ *   DIO_TRACE=trace.json ./diosolver 9 5 137
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of spans recorded per thread; later spans are dropped
+#define TRACE_MAX_EVENTS (1 << 16)
+
+// Maximum nesting of spans on a thread
+#define TRACE_MAX_DEPTH 32
+
+#define TRACE_BEGIN(name) \
+    do { if (trace_on) trace_begin(name); } while (0)
+
+#define TRACE_END() \
+    do { if (trace_on) trace_end(); } while (0)
+
+// True while spans are recorded
+extern bool trace_on;
+
+/**
+ * Starts recording spans.
+ *
+ * @param path File that trace_finish() writes the trace to,
+ *             or NULL to only record.
+ * @return true if tracing started, false if it was already on.
+ */
+bool trace_start(const char *path);
+
+/**
+ * Stops recording spans, writes the trace to the file passed to
+ * trace_start() if any, and discards the recorded spans.
+ *
+ * @return true if the trace was written (or no file was given), false if
+ *         the file cannot be written.
+ */
+bool trace_finish();
+
+/**
+ * Names the calling thread in the trace, such as "GUI" or "worker".
+ *
+ * @param name A string that outlives the trace.
+ */
+void trace_thread_name(const char *name);
+
+/**
+ * Starts a span on the calling thread. Used through TRACE_BEGIN().
+ *
+ * @param name Name of the span, a string that outlives the trace.
+ */
+void trace_begin(const char *name);
+
+/**
+ * Ends the innermost span on the calling thread. Used through TRACE_END().
+ */
+void trace_end();
+
+/**
+ * Writes the spans recorded so far in the Chrome trace event format.
+ *
+ * @param out The stream to write to.
+ * @return The number of spans written.
+ */
+long trace_write(FILE *out);
+
+/**
+ * Runs unit tests for functions in "trace.h".
+ */
+void test_trace_h();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,10 +1,16 @@
 #include "Dialog.h"
 #include "MainWindow.h"
-#include "../C-Backend/lde.h"
+#include "SolutionTable.h"
+#include "LatticePlot.h"
+#include "OutputBuffer.h"
+#include "../C-Backend/diosolver.hpp"
+#include "../C-Backend/trace.h"
 
 #include <QLabel>
 #include <QTextBrowser>
+#include <QTabWidget>
 #include <QDesktopServices>
+#include <QtConcurrent>
 
 Dialog::Dialog(MainWindow *win, const QString &title) : QDialog(win) {
     setWindowTitle(title);
@@ -47,16 +53,73 @@ AboutDialog::AboutDialog(MainWindow *win) : Dialog(win, "About DioSolver") {
 }
 
 ResultDialog::ResultDialog(MainWindow *win, LDE lde) : Dialog(win, "Result") {
-    QTextEdit *editor = new QTextEdit(this);
+    QTabWidget *tabWidget = new QTabWidget(this);
+    dialogLayout->insertWidget(0, tabWidget);
+
+    // QPlainTextEdit only lays out the lines in view, however long the result
+    editor = new QPlainTextEdit(this);
     editor->setReadOnly(true);
     editor->setMinimumSize(400, 400);
-    dialogLayout->insertWidget(0, editor);
+    tabWidget->addTab(editor, "Steps");
+
+    // The solution set takes constant time, so it is ready right away
+    SolnSet set = lde_soln_set(lde);
+    if (set.exist && !set.plane) {
+        tabWidget->addTab(new SolutionTable(set, this), "Solutions");
+        tabWidget->addTab(new LatticePlot(lde, set, this), "Plot");
+    }
+
+    // A busy indicator, since the number of lines is not known in advance
+    progressBar = new QProgressBar(this);
+    progressBar->setRange(0, 0);
+    progressBar->setTextVisible(false);
+    dialogLayout->insertWidget(1, progressBar);
+
+    cancelButton = new QPushButton("Cancel", this);
+    dialogLayout->insertWidget(2, cancelButton, 0, Qt::AlignCenter);
+    okButton->setVisible(false);
+
+    // Lines arriving between two frames are inserted together
+    output = new OutputBuffer(editor);
+
+    // Solve on a worker thread, and stream each line back as it is produced
+    watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::resultsReadyAt,
+            this, &ResultDialog::appendLines);
+    connect(watcher, &QFutureWatcher<QString>::finished,
+            this, &ResultDialog::finish);
+    connect(cancelButton, &QPushButton::clicked, watcher,
+            &QFutureWatcher<QString>::cancel);
+
+    watcher->setFuture(QtConcurrent::run([lde] (QPromise<QString> &promise) {
+        trace_thread_name("worker");
+        dio::steps(lde, [&promise] (std::string_view line) {
+            promise.addResult(QString::fromUtf8(line.data(), line.size()));
+            return !promise.isCanceled();
+        });
+    }));
+}
+
+ResultDialog::~ResultDialog() {
+    // The worker stops at its next line, and outlives the dialog until then
+    watcher->cancel();
+}
+
+void ResultDialog::appendLines(int begin, int end) {
+    QString text;
+    for (int i = begin; i < end; ++i) {
+        text += watcher->resultAt(i);
+    }
+    output->append(text);
+}
 
-    List result = lde_result(lde);
-    for (int i = 0; i < result.size; ++i) {
-        char *line = list_at(result, i, char*);
-        editor->insertPlainText(line);
-        free(line);
+void ResultDialog::finish() {
+    if (watcher->isCanceled()) {
+        output->append("\n(Cancelled)\n");
     }
-    list_free(result);
+    output->flush();
+    progressBar->setVisible(false);
+    cancelButton->setVisible(false);
+    okButton->setVisible(true);
+    okButton->setFocus();
 }
@@ -3,8 +3,12 @@
 #include <QDialog>
 #include <QBoxLayout>
 #include <QPushButton>
+#include <QProgressBar>
+#include <QPlainTextEdit>
+#include <QFutureWatcher>
 
 class MainWindow;
+class OutputBuffer;
 
 struct LDE;
 
@@ -31,4 +35,15 @@ class ResultDialog : public Dialog {
 
 public:
     ResultDialog(MainWindow *win, LDE lde);
+    ~ResultDialog();
+
+private:
+    QPlainTextEdit *editor;
+    QProgressBar *progressBar;
+    QPushButton *cancelButton;
+    QFutureWatcher<QString> *watcher;
+    OutputBuffer *output;
+
+    void appendLines(int begin, int end);
+    void finish();
 };
@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -15,19 +15,33 @@ SOURCES += \
     ../C-Backend/intvl.c \
     ../C-Backend/lde.c \
     ../C-Backend/list.c \
+    ../C-Backend/memstat.c \
+    ../C-Backend/stats.c \
+    ../C-Backend/trace.c \
     Dialog.cpp \
+    LatticePlot.cpp \
     Main.cpp \
-    MainWindow.cpp
+    MainWindow.cpp \
+    OutputBuffer.cpp \
+    SolutionTable.cpp
 
 HEADERS += \
     ../C-Backend/betterc.h \
+    ../C-Backend/diosolver.hpp \
     ../C-Backend/eea.h \
+    ../C-Backend/eea.hpp \
     ../C-Backend/ineq.h \
     ../C-Backend/intvl.h \
     ../C-Backend/lde.h \
     ../C-Backend/list.h \
+    ../C-Backend/memstat.h \
+    ../C-Backend/stats.h \
+    ../C-Backend/trace.h \
     Dialog.h \
-    MainWindow.h
+    LatticePlot.h \
+    MainWindow.h \
+    OutputBuffer.h \
+    SolutionTable.h
 
 TARGET = "LDE Solver"
 VERSION = "1.1.0"
@@ -0,0 +1,237 @@
+#include "LatticePlot.h"
+
+#include <QPainter>
+#include <QPainterPath>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <cmath>
+
+// Smallest distance in pixels between neighbouring solutions that are drawn
+// as individual points. Closer solutions are drawn as a density band.
+const double MIN_POINT_SPACING = 4;
+
+// Radius in pixels of an individual solution
+const double POINT_RADIUS = 2.5;
+
+LatticePlot::LatticePlot(LDE lde, SolnSet set, QWidget *parent)
+    : QWidget(parent), lde(lde), set(set) {
+    setMinimumSize(400, 400);
+
+    // Start at the middle solution, with neighbouring solutions 24px apart
+    double low = set.n_intvl.low;
+    double high = set.n_intvl.high;
+    double n = 0;
+    if (low != NEG_INF && high != POS_INF) {
+        n = std::floor((low + high) / 2);
+    } else if (low != NEG_INF) {
+        n = low;
+    } else if (high != POS_INF) {
+        n = high;
+    }
+    centerX = set.x0 + set.dx * n;
+    centerY = set.y0 + set.dy * n;
+    double step = std::hypot(set.dx, set.dy);
+    scale = step > 0 ? 24 / step : 24;
+}
+
+QPointF LatticePlot::toScreen(double x, double y) const {
+    return QPointF(width() / 2.0 + (x - centerX) * scale,
+                   height() / 2.0 - (y - centerY) * scale);
+}
+
+QPointF LatticePlot::toWorld(QPointF pos) const {
+    return QPointF(centerX + (pos.x() - width() / 2.0) / scale,
+                   centerY - (pos.y() - height() / 2.0) / scale);
+}
+
+void LatticePlot::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), palette().base());
+
+    // Axes
+    painter.setPen(QPen(palette().mid(), 1));
+    QPointF origin = toScreen(0, 0);
+    painter.drawLine(QPointF(0, origin.y()), QPointF(width(), origin.y()));
+    painter.drawLine(QPointF(origin.x(), 0), QPointF(origin.x(), height()));
+
+    drawDomain(painter);
+    drawSolutions(painter);
+}
+
+void LatticePlot::drawDomain(QPainter &painter) {
+    // Infinite bounds extend just past the visible area
+    QPointF topLeft = toWorld(QPointF(-1, -1));
+    QPointF bottomRight = toWorld(QPointF(width() + 1, height() + 1));
+    double left = lde.xi.low == NEG_INF ? topLeft.x() : lde.xi.low;
+    double right = lde.xi.high == POS_INF ? bottomRight.x() : lde.xi.high;
+    double bottom = lde.yi.low == NEG_INF ? bottomRight.y() : lde.yi.low;
+    double top = lde.yi.high == POS_INF ? topLeft.y() : lde.yi.high;
+    left = qMax(left, topLeft.x());
+    right = qMin(right, bottomRight.x());
+    bottom = qMax(bottom, bottomRight.y());
+    top = qMin(top, topLeft.y());
+    if (left > right || bottom > top) {
+        return;
+    }
+
+    QColor fill = palette().highlight().color();
+    fill.setAlpha(30);
+    QRectF domain(toScreen(left, top), toScreen(right, bottom));
+    painter.fillRect(domain, fill);
+
+    // Closed bounds are solid, open bounds are dashed
+    auto drawEdge = [&] (bool finite, bool open, QPointF from, QPointF to) {
+        if (finite) {
+            painter.setPen(QPen(palette().highlight(), 1,
+                                open ? Qt::DashLine : Qt::SolidLine));
+            painter.drawLine(from, to);
+        }
+    };
+    drawEdge(lde.xi.low == left, lde.xi.left_open,
+             domain.topLeft(), domain.bottomLeft());
+    drawEdge(lde.xi.high == right, lde.xi.right_open,
+             domain.topRight(), domain.bottomRight());
+    drawEdge(lde.yi.low == bottom, lde.yi.left_open,
+             domain.bottomLeft(), domain.bottomRight());
+    drawEdge(lde.yi.high == top, lde.yi.right_open,
+             domain.topLeft(), domain.topRight());
+}
+
+void LatticePlot::drawSolutions(QPainter &painter) {
+    if (set.plane || (set.dx == 0 && set.dy == 0)) {
+        return;
+    }
+
+    // Range of the parameter t for which (x0 + dx t, y0 + dy t) is visible
+    QPointF topLeft = toWorld(QPointF(0, 0));
+    QPointF bottomRight = toWorld(QPointF(width(), height()));
+    double tLow = -INFINITY;
+    double tHigh = INFINITY;
+    auto clip = [&] (double start, double step, double min, double max) {
+        if (step == 0) {
+            if (start < min || start > max) {
+                tLow = INFINITY;
+            }
+            return;
+        }
+        double t1 = (min - start) / step;
+        double t2 = (max - start) / step;
+        tLow = qMax(tLow, qMin(t1, t2));
+        tHigh = qMin(tHigh, qMax(t1, t2));
+    };
+    clip(set.x0, set.dx, topLeft.x(), bottomRight.x());
+    clip(set.y0, set.dy, bottomRight.y(), topLeft.y());
+    if (tLow > tHigh) {
+        return;
+    }
+
+    painter.setPen(QPen(palette().text(), 1));
+    painter.drawLine(toScreen(set.x0 + set.dx * tLow, set.y0 + set.dy * tLow),
+                     toScreen(set.x0 + set.dx * tHigh, set.y0 + set.dy * tHigh));
+
+    // Only the solutions in view are considered, straight from n
+    double nLow = qMax(std::ceil(tLow), set.n_intvl.low);
+    double nHigh = qMin(std::floor(tHigh), set.n_intvl.high);
+    if (!set.exist || nLow > nHigh) {
+        return;
+    }
+
+    double spacing = scale * std::hypot(set.dx, set.dy);
+    if (spacing < MIN_POINT_SPACING) {
+        drawDensity(painter, qint64(nLow), qint64(nHigh));
+    } else {
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(palette().highlight());
+        for (qint64 n = nLow; n <= nHigh; ++n) {
+            painter.drawEllipse(toScreen(set.x0 + set.dx * double(n),
+                                         set.y0 + set.dy * double(n)),
+                                POINT_RADIUS, POINT_RADIUS);
+        }
+    }
+
+    painter.setPen(QPen(palette().text(), 1));
+    painter.drawText(rect().adjusted(8, 8, -8, -8), Qt::AlignTop | Qt::AlignLeft,
+                     QString("n ∈ [%1, %2] in view: %3 solution(s)")
+                         .arg(qint64(nLow)).arg(qint64(nHigh))
+                         .arg(qint64(nHigh - nLow + 1)));
+}
+
+void LatticePlot::drawDensity(QPainter &painter, qint64 nLow, qint64 nHigh) {
+    // Walk the pixels along the axis in which the line is longer, and count
+    // the solutions falling in each pixel arithmetically
+    bool columns = std::abs(set.dx) >= std::abs(set.dy);
+    double start = columns ? set.x0 : set.y0;
+    double step = columns ? set.dx : set.dy;
+    int pixels = columns ? width() : height();
+    double maxCount = 1 + 1 / (scale * std::abs(step));
+
+    QColor color = palette().highlight().color();
+    for (int i = 0; i < pixels; ++i) {
+        // World interval [from, to) covered by the pixel
+        QPointF first = toWorld(QPointF(i, i));
+        QPointF last = toWorld(QPointF(i + 1, i + 1));
+        double from = columns ? first.x() : last.y();
+        double to = columns ? last.x() : first.y();
+
+        double lo, hi;
+        if (step > 0) {
+            lo = std::ceil((from - start) / step);
+            hi = std::ceil((to - start) / step) - 1;
+        } else {
+            lo = std::floor((to - start) / step) + 1;
+            hi = std::floor((from - start) / step);
+        }
+        lo = qMax(lo, double(nLow));
+        hi = qMin(hi, double(nHigh));
+        if (lo > hi) {
+            continue;
+        }
+
+        double count = hi - lo + 1;
+        color.setAlphaF(0.15 + 0.85 * std::log1p(count) / std::log1p(maxCount));
+        double n = (lo + hi) / 2;
+        QPointF pos = toScreen(set.x0 + set.dx * n, set.y0 + set.dy * n);
+        if (columns) {
+            painter.fillRect(QRectF(i, pos.y() - 1.5, 1, 3), color);
+        } else {
+            painter.fillRect(QRectF(pos.x() - 1.5, i, 3, 1), color);
+        }
+    }
+}
+
+void LatticePlot::wheelEvent(QWheelEvent *event) {
+    // Zoom around the cursor, keeping the point under it in place
+    QPointF pos = event->position();
+    QPointF anchor = toWorld(pos);
+    scale = qBound(1e-12, scale * std::pow(1.0015, event->angleDelta().y()), 1e3);
+    centerX = anchor.x() - (pos.x() - width() / 2.0) / scale;
+    centerY = anchor.y() + (pos.y() - height() / 2.0) / scale;
+    update();
+}
+
+void LatticePlot::mousePressEvent(QMouseEvent *event) {
+    if (event->button() == Qt::LeftButton) {
+        dragging = true;
+        dragPos = event->position();
+        setCursor(Qt::ClosedHandCursor);
+    }
+}
+
+void LatticePlot::mouseMoveEvent(QMouseEvent *event) {
+    if (!dragging) {
+        return;
+    }
+    QPointF delta = event->position() - dragPos;
+    dragPos = event->position();
+    centerX -= delta.x() / scale;
+    centerY += delta.y() / scale;
+    update();
+}
+
+void LatticePlot::mouseReleaseEvent(QMouseEvent *event) {
+    if (event->button() == Qt::LeftButton) {
+        dragging = false;
+        unsetCursor();
+    }
+}
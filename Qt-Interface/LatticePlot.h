@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../C-Backend/lde.h"
+
+#include <QWidget>
+#include <QPointF>
+
+class LatticePlot : public QWidget {
+    Q_OBJECT
+
+public:
+    LatticePlot(LDE lde, SolnSet set, QWidget *parent = nullptr);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
+private:
+    LDE lde;
+    SolnSet set;
+
+    double centerX;
+    double centerY;
+    double scale;
+    QPointF dragPos;
+    bool dragging = false;
+
+    QPointF toScreen(double x, double y) const;
+    QPointF toWorld(QPointF pos) const;
+
+    void drawDomain(QPainter &painter);
+    void drawSolutions(QPainter &painter);
+    void drawDensity(QPainter &painter, qint64 nLow, qint64 nHigh);
+};
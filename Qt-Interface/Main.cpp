@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "../C-Backend/trace.h"
 
 #include <QApplication>
 #include <QFontDatabase>
@@ -13,6 +14,7 @@ void loadStyleSheet(const QString &filename) {
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
+    trace_thread_name("GUI");
     QFontDatabase::addApplicationFont(":/font/JetBrainsMono-VariableFont_wght.ttf");
     loadStyleSheet(":/conf/Styles.qss");
 
@@ -1,10 +1,25 @@
 #include "MainWindow.h"
 #include "Dialog.h"
-#include "../C-Backend/lde.h"
+#include "../C-Backend/diosolver.hpp"
+#include "../C-Backend/trace.h"
 
 #include <QGridLayout>
 #include <QLabel>
 #include <QPushButton>
+#include <QtConcurrent>
+
+// Delay after the last edit before the LDE is solved again
+const int SOLVE_DELAY_MS = 30;
+
+QSharedPointer<const dio::EEATable> EEACache::table(int a, int b) {
+    QMutexLocker locker(&mutex);
+    if (!cached || a != this->a || b != this->b) {
+        cached.reset(new dio::EEATable(a, b));
+        this->a = a;
+        this->b = b;
+    }
+    return cached;
+}
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     setWindowTitle("DioSolver");
@@ -22,15 +37,38 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 
     ldeFrame = new LDEFrame(this);
     mainLayout->addWidget(ldeFrame);
+    mainLayout->addSpacing(20);
+
+    liveEditor = new QPlainTextEdit(this);
+    liveEditor->setReadOnly(true);
+    liveEditor->setMinimumHeight(200);
+    mainLayout->addWidget(liveEditor, 1);
 
     ButtonFrame *buttonFrame = new ButtonFrame(this);
-    mainLayout->addStretch();
-    mainLayout->addSpacing(50);
+    mainLayout->addSpacing(30);
     mainLayout->addWidget(buttonFrame);
 
+    // Solve again shortly after the input stops changing
+    solveTimer = new QTimer(this);
+    solveTimer->setSingleShot(true);
+    solveTimer->setInterval(SOLVE_DELAY_MS);
+    connect(solveTimer, &QTimer::timeout, this, &MainWindow::startSolve);
+
+    solveWatcher = new QFutureWatcher<QString>(this);
+    connect(solveWatcher, &QFutureWatcher<QString>::finished,
+            this, &MainWindow::showSolve);
+    eeaCache.reset(new EEACache);
+
+    watchLDEFrame();
+    startSolve();
+
     resize(450, height());
 }
 
+MainWindow::~MainWindow() {
+    solveWatcher->cancel();
+}
+
 void MainWindow::clearLDE() {
     mainLayout->removeWidget(ldeFrame);
     ldeFrame->setParent(nullptr);
@@ -38,6 +76,54 @@ void MainWindow::clearLDE() {
 
     ldeFrame = new LDEFrame(this);
     mainLayout->insertWidget(2, ldeFrame);
+    watchLDEFrame();
+    solveTimer->start();
+}
+
+void MainWindow::watchLDEFrame() {
+    connect(ldeFrame, &LDEFrame::changed, solveTimer, [this] {
+        solveTimer->start();
+    });
+}
+
+void MainWindow::startSolve() {
+    // A newer input supersedes any solve still running
+    solveWatcher->cancel();
+
+    TRACE_BEGIN("parse");
+    LDE lde = solveLDE();
+    TRACE_END();
+    QSharedPointer<EEACache> cache = eeaCache;
+    solveWatcher->setFuture(QtConcurrent::run([lde, cache] (QPromise<QString> &promise) {
+        trace_thread_name("worker");
+        TRACE_BEGIN("live solve");
+        QString text;
+        auto appendLine = [&promise, &text] (std::string_view line) {
+            text += QString::fromUtf8(line.data(), line.size());
+            return !promise.isCanceled();
+        };
+        bool done;
+        if (lde.a != 0 && lde.b != 0) {
+            // Only a change to a or b reruns the EEA
+            QSharedPointer<const dio::EEATable> table = cache->table(lde.a, lde.b);
+            done = dio::steps(lde, *table, appendLine);
+        } else {
+            done = dio::steps(lde, appendLine);
+        }
+        if (done) {
+            promise.addResult(text);
+        }
+        TRACE_END();
+    }));
+}
+
+void MainWindow::showSolve() {
+    if (solveWatcher->isCanceled() || solveWatcher->resultCount() == 0) {
+        return;
+    }
+    TRACE_BEGIN("output");
+    liveEditor->setPlainText(solveWatcher->result());
+    TRACE_END();
 }
 
 LDE MainWindow::solveLDE() {
@@ -80,6 +166,12 @@ LDEFrame::LDEFrame(MainWindow *win) : QFrame(win) {
 
     yBox = new DomainBox("Domain of y", this);
     gridLayout->addWidget(yBox, 2, 0, 1, 6);
+
+    for (IntLineEdit *field : {aField, bField, cField}) {
+        connect(field, &QLineEdit::textChanged, this, &LDEFrame::changed);
+    }
+    connect(xBox, &DomainBox::changed, this, &LDEFrame::changed);
+    connect(yBox, &DomainBox::changed, this, &LDEFrame::changed);
 }
 
 int LDEFrame::aValue() {
@@ -122,7 +214,9 @@ DomainBox::DomainBox(const QString &title, LDEFrame *frame)
     connect(intvlBox, &QComboBox::currentIndexChanged, this, [this] (int index) {
         static const int lastIndex = defined_intvls.size() - 1;
         intvlFrame->setVisible(index == lastIndex);
+        emit changed();
     });
+    connect(intvlFrame, &IntervalFrame::changed, this, &DomainBox::changed);
 }
 
 Interval DomainBox::interval() {
@@ -161,6 +255,11 @@ IntervalFrame::IntervalFrame(DomainBox *domainBox) : QFrame(domainBox) {
 
     rightBox = new QCheckBox("Include Right Endpoint", this);
     gridLayout->addWidget(rightBox, 1, 2);
+
+    connect(fromBox, &QLineEdit::textChanged, this, &IntervalFrame::changed);
+    connect(toBox, &QLineEdit::textChanged, this, &IntervalFrame::changed);
+    connect(leftBox, &QCheckBox::toggled, this, &IntervalFrame::changed);
+    connect(rightBox, &QCheckBox::toggled, this, &IntervalFrame::changed);
 }
 
 Interval IntervalFrame::customInterval() {
@@ -7,6 +7,11 @@
 #include <QGroupBox>
 #include <QComboBox>
 #include <QCheckBox>
+#include <QPlainTextEdit>
+#include <QTimer>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QFutureWatcher>
 
 class LDEFrame;
 class DomainBox;
@@ -15,11 +20,27 @@ class IntervalFrame;
 struct Interval;
 struct LDE;
 
+namespace dio {
+class EEATable;
+}
+
+class EEACache {
+public:
+    QSharedPointer<const dio::EEATable> table(int a, int b);
+
+private:
+    QMutex mutex;
+    int a = 0;
+    int b = 0;
+    QSharedPointer<const dio::EEATable> cached;
+};
+
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
     MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
 
     void clearLDE();
     LDE solveLDE();
@@ -27,6 +48,15 @@ public:
 private:
     QVBoxLayout *mainLayout;
     LDEFrame *ldeFrame;
+    QPlainTextEdit *liveEditor;
+
+    QTimer *solveTimer;
+    QFutureWatcher<QString> *solveWatcher;
+    QSharedPointer<EEACache> eeaCache;
+
+    void watchLDEFrame();
+    void startSolve();
+    void showSolve();
 };
 
 class IntLineEdit : public QLineEdit {
@@ -51,6 +81,9 @@ public:
     Interval xInterval();
     Interval yInterval();
 
+signals:
+    void changed();
+
 private:
     IntLineEdit *aField;
     IntLineEdit *bField;
@@ -68,6 +101,9 @@ public:
 
     Interval interval();
 
+signals:
+    void changed();
+
 private:
     QComboBox *intvlBox;
     IntervalFrame *intvlFrame;
@@ -81,6 +117,9 @@ public:
 
     Interval customInterval();
 
+signals:
+    void changed();
+
 private:
     IntLineEdit *fromBox;
     IntLineEdit *toBox;
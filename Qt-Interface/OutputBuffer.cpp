@@ -0,0 +1,37 @@
+#include "OutputBuffer.h"
+#include "../C-Backend/trace.h"
+
+// Time between two insertions, which is about one frame at 60 Hz
+const int FLUSH_INTERVAL_MS = 16;
+
+OutputBuffer::OutputBuffer(QPlainTextEdit *editor)
+    : QObject(editor), editor(editor) {
+    flushTimer = new QTimer(this);
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(flushTimer, &QTimer::timeout, this, &OutputBuffer::flush);
+}
+
+void OutputBuffer::append(const QString &text) {
+    pendingText += text;
+
+    // Show the first lines right away, and later ones once per frame
+    if (editor->document()->isEmpty()) {
+        flush();
+    } else if (!flushTimer->isActive()) {
+        flushTimer->start();
+    }
+}
+
+void OutputBuffer::flush() {
+    flushTimer->stop();
+    if (pendingText.isEmpty()) {
+        return;
+    }
+    TRACE_BEGIN("output");
+    QTextCursor cursor(editor->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(pendingText);
+    pendingText.clear();
+    TRACE_END();
+}
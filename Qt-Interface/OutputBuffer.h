@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QObject>
+#include <QPlainTextEdit>
+#include <QTimer>
+
+// Appends text to the end of an editor, at most once per frame
+class OutputBuffer : public QObject {
+    Q_OBJECT
+
+public:
+    OutputBuffer(QPlainTextEdit *editor);
+
+    void append(const QString &text);
+    void flush();
+
+private:
+    QPlainTextEdit *editor;
+    QString pendingText;
+    QTimer *flushTimer;
+};
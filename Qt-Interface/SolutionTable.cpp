@@ -0,0 +1,170 @@
+#include "SolutionTable.h"
+#include "MainWindow.h"
+#include "../C-Backend/diosolver.hpp"
+
+#include <QBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QScrollBar>
+
+// Number of rows exposed to the view at a time. Rows are generated from
+// the parametric form on demand, and the window moves as the view scrolls
+// past its edges, so memory use does not depend on the number of solutions.
+const int WINDOW_ROWS = 1 << 20;
+
+SolutionModel::SolutionModel(SolnSet set, QObject *parent)
+    : QAbstractTableModel(parent), set(set) {
+    low = set.n_intvl.low;
+    high = set.n_intvl.high;
+    if (!set.exist || set.plane) {
+        low = 0;
+        high = -1;
+    }
+
+    // Start at the smallest n, or around n = 0 if n is unbounded below
+    base = low;
+    if (low == NEG_INF) {
+        base = qMax(low, qMin(high - WINDOW_ROWS + 1, qint64(-WINDOW_ROWS / 2)));
+    }
+}
+
+int SolutionModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return qMin(qint64(WINDOW_ROWS), high - base + 1);
+}
+
+int SolutionModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : 3;
+}
+
+QVariant SolutionModel::data(const QModelIndex &index, int role) const {
+    if (role == Qt::TextAlignmentRole) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole || !index.isValid()) {
+        return QVariant();
+    }
+
+    // x and y may exceed the range of int, so they are in 64 bits
+    dio::SolnPoint point = dio::Solutions(set).at(nAt(index.row()));
+    switch (index.column()) {
+    case 0:
+        return QString::number(point.n);
+    case 1:
+        return QString::number(point.x);
+    case 2:
+        return QString::number(point.y);
+    }
+    return QVariant();
+}
+
+QVariant SolutionModel::headerData(int section, Qt::Orientation orientation,
+                                   int role) const {
+    static const QStringList headers = {"n", "x", "y"};
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QVariant();
+    }
+    return headers.value(section);
+}
+
+qint64 SolutionModel::count() const {
+    return high - low + 1;
+}
+
+bool SolutionModel::isInfinite() const {
+    return low == NEG_INF || high == POS_INF;
+}
+
+qint64 SolutionModel::nAt(int row) const {
+    return base + row;
+}
+
+int SolutionModel::moveWindow(qint64 n) {
+    n = qBound(low, n, high);
+    qint64 newBase = qBound(low, n - WINDOW_ROWS / 2,
+                            qMax(low, high - WINDOW_ROWS + 1));
+    if (newBase != base) {
+        beginResetModel();
+        base = newBase;
+        endResetModel();
+    }
+    return n - base;
+}
+
+bool SolutionModel::hasRowsBefore() const {
+    return base > low;
+}
+
+bool SolutionModel::hasRowsAfter() const {
+    return base + WINDOW_ROWS <= high;
+}
+
+SolutionTable::SolutionTable(SolnSet set, QWidget *parent) : QWidget(parent) {
+    QVBoxLayout *vboxLayout = new QVBoxLayout(this);
+    vboxLayout->setContentsMargins(0, 0, 0, 0);
+
+    model = new SolutionModel(set, this);
+
+    dio::CString setStr = dio::soln_set_str(set);
+    QString summary = QString::fromUtf8(setStr.view().data(), setStr.view().size());
+    if (model->isInfinite()) {
+        summary += "\nInfinitely many solutions; n is shown within the range of int.";
+    } else {
+        summary += QString("\n%1 solution(s)").arg(model->count());
+    }
+    QLabel *summaryLabel = new QLabel(summary, this);
+    summaryLabel->setWordWrap(true);
+    vboxLayout->addWidget(summaryLabel);
+
+    // Fixed row heights let the view scroll without measuring any row
+    view = new QTableView(this);
+    view->setModel(model);
+    view->verticalHeader()->setVisible(false);
+    view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    vboxLayout->addWidget(view);
+
+    connect(view->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &SolutionTable::followScroll);
+
+    QHBoxLayout *jumpLayout = new QHBoxLayout();
+    jumpLayout->addWidget(new QLabel("Jump to n:", this));
+    jumpField = new IntLineEdit(this);
+    jumpLayout->addWidget(jumpField);
+    QPushButton *jumpButton = new QPushButton("Go", this);
+    jumpLayout->addWidget(jumpButton);
+    vboxLayout->addLayout(jumpLayout);
+
+    auto jump = [this] {
+        if (!jumpField->text().isEmpty()) {
+            jumpTo(jumpField->value());
+        }
+    };
+    connect(jumpButton, &QPushButton::clicked, this, jump);
+    connect(jumpField, &QLineEdit::returnPressed, this, jump);
+}
+
+void SolutionTable::jumpTo(qint64 n) {
+    int row = model->moveWindow(n);
+    QModelIndex index = model->index(row, 0);
+    view->scrollTo(index, QAbstractItemView::PositionAtCenter);
+    view->selectRow(row);
+}
+
+void SolutionTable::followScroll(int value) {
+    // Move the window once the view reaches one of its edges, keeping the
+    // top row in place
+    QScrollBar *scrollBar = view->verticalScrollBar();
+    bool atTop = value == scrollBar->minimum() && model->hasRowsBefore();
+    bool atBottom = value == scrollBar->maximum() && model->hasRowsAfter();
+    if (!atTop && !atBottom) {
+        return;
+    }
+
+    qint64 topN = model->nAt(qMax(view->rowAt(0), 0));
+    int row = model->moveWindow(topN);
+    view->scrollTo(model->index(row, 0), QAbstractItemView::PositionAtTop);
+}
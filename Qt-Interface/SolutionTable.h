@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../C-Backend/lde.h"
+
+#include <QAbstractTableModel>
+#include <QTableView>
+#include <QLabel>
+
+class IntLineEdit;
+
+class SolutionModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    SolutionModel(SolnSet set, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    qint64 count() const;
+    bool isInfinite() const;
+    qint64 nAt(int row) const;
+    int moveWindow(qint64 n);
+
+    bool hasRowsBefore() const;
+    bool hasRowsAfter() const;
+
+private:
+    SolnSet set;
+    qint64 low;
+    qint64 high;
+    qint64 base;
+};
+
+class SolutionTable : public QWidget {
+    Q_OBJECT
+
+public:
+    SolutionTable(SolnSet set, QWidget *parent = nullptr);
+
+    void jumpTo(qint64 n);
+
+private:
+    SolutionModel *model;
+    QTableView *view;
+    IntLineEdit *jumpField;
+
+    void followScroll(int value);
+};
@@ -0,0 +1,181 @@
+/**
+ * Measures how long the result view takes to show large results.
+ *
+ * Usage: RenderBench [--lines N] [--batch N]
+ *
+ * The steps of a few LDEs are repeated until there are N lines, and fed to
+ * each view in batches, the way ResultDialog receives them from the worker
+ * thread. For each view, the time from show() to the first paint of its
+ * viewport, and the time until every line has been inserted, are reported.
+ */
+
+#include "../OutputBuffer.h"
+#include "../../C-Backend/diosolver.hpp"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QPlainTextEdit>
+#include <QTextEdit>
+#include <QTimer>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+// Fibonacci numbers F(46) and F(45), which give the longest EEA table
+const int FIB_46 = 1836311903;
+const int FIB_45 = 1134903170;
+
+QStringList makeBatches(int nLines, int batchSize) {
+    QStringList steps;
+    LDE ldes[] = {
+        make_lde_in(FIB_46, FIB_45, 1, REAL, REAL),
+        make_lde_in(9, 5, 137, POS, POS),
+        make_lde_in(-1234567, 7654321, 99, REAL, NONNEG),
+    };
+    for (const LDE &lde : ldes) {
+        dio::steps(lde, [&steps] (std::string_view line) {
+            steps.append(QString::fromUtf8(line.data(), line.size()));
+            return true;
+        });
+    }
+
+    QStringList batches;
+    QString batch;
+    for (int i = 0; i < nLines; ++i) {
+        batch += steps[i % steps.size()];
+        if ((i + 1) % batchSize == 0 || i + 1 == nLines) {
+            batches.append(batch);
+            batch.clear();
+        }
+    }
+    return batches;
+}
+
+/**
+ * A way of showing the batches, with the widget it shows them in.
+ */
+struct Mode {
+    const char *name;
+    std::function<QWidget *()> create;
+    std::function<void(QWidget *, const QStringList &)> feed;
+};
+
+class PaintWatcher : public QObject {
+public:
+    QElapsedTimer *timer;
+    qint64 firstPaint = -1;
+
+    bool eventFilter(QObject *, QEvent *event) override {
+        if (event->type() == QEvent::Paint && firstPaint < 0) {
+            firstPaint = timer->nsecsElapsed();
+        }
+        return false;
+    }
+};
+
+// Queues each batch, as the worker thread's results are delivered
+void queueBatches(const QStringList &batches,
+                  std::function<void(const QString &)> append) {
+    for (const QString &batch : batches) {
+        QTimer::singleShot(0, qApp, [append, batch] { append(batch); });
+    }
+}
+
+QList<Mode> modes() {
+    QList<Mode> list;
+
+    // Previous ResultDialog: a QTextEdit laid out as a whole, one insertion
+    // per batch
+    list.append({"textedit_append", [] { return new QTextEdit(); },
+                 [] (QWidget *widget, const QStringList &batches) {
+        auto editor = static_cast<QTextEdit *>(widget);
+        queueBatches(batches, [editor] (const QString &batch) {
+            editor->moveCursor(QTextCursor::End);
+            editor->insertPlainText(batch);
+        });
+    }});
+
+    // Whole result known in advance, set in one pass
+    list.append({"plaintext_bulk", [] { return new QPlainTextEdit(); },
+                 [] (QWidget *widget, const QStringList &batches) {
+        auto editor = static_cast<QPlainTextEdit *>(widget);
+        QString text = batches.join(QString());
+        QTimer::singleShot(0, qApp, [editor, text] {
+            editor->setPlainText(text);
+        });
+    }});
+
+    // Current ResultDialog, through the same OutputBuffer
+    list.append({"plaintext_frames", [] { return new QPlainTextEdit(); },
+                 [] (QWidget *widget, const QStringList &batches) {
+        auto output = new OutputBuffer(static_cast<QPlainTextEdit *>(widget));
+        queueBatches(batches, [output] (const QString &batch) {
+            output->append(batch);
+        });
+    }});
+
+    return list;
+}
+
+void runMode(const Mode &mode, const QStringList &batches, int nLines) {
+    // An empty document has one block, and each line break adds another
+    qsizetype nBlocks = batches.join(QString()).count('\n') + 1;
+
+    QWidget *widget = mode.create();
+    widget->resize(800, 600);
+    auto area = static_cast<QAbstractScrollArea *>(widget);
+
+    QElapsedTimer timer;
+    PaintWatcher watcher;
+    watcher.timer = &timer;
+    area->viewport()->installEventFilter(&watcher);
+
+    // Done once every line is in the document and the events are drained
+    timer.start();
+    widget->show();
+    mode.feed(widget, batches);
+    qint64 lastLine = -1;
+    QTextDocument *document = qobject_cast<QTextEdit *>(widget)
+        ? static_cast<QTextEdit *>(widget)->document()
+        : static_cast<QPlainTextEdit *>(widget)->document();
+    while (lastLine < 0 || watcher.firstPaint < 0) {
+        QApplication::processEvents(QEventLoop::AllEvents, 50);
+        if (lastLine < 0 && document->blockCount() >= nBlocks) {
+            lastLine = timer.nsecsElapsed();
+        }
+    }
+
+    printf("%-18s %10d %16.2f %16.2f\n", mode.name, nLines,
+           watcher.firstPaint / 1e6, lastLine / 1e6);
+    fflush(stdout);
+    delete widget;
+}
+
+int main(int argc, char *argv[]) {
+    QApplication app(argc, argv);
+
+    int nLines = 100000;
+    int batchSize = 256;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--lines") == 0 && i + 1 < argc) {
+            nLines = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchSize = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--lines N] [--batch N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (nLines < 1 || batchSize < 1) {
+        fprintf(stderr, "--lines and --batch must be positive\n");
+        return 1;
+    }
+
+    QStringList batches = makeBatches(nLines, batchSize);
+    printf("%-18s %10s %16s %16s\n", "view", "lines",
+           "first_paint_ms", "last_line_ms");
+    for (const Mode &mode : modes()) {
+        runMode(mode, batches, nLines);
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+QT       += core gui widgets
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+SOURCES += \
+    ../../C-Backend/betterc.c \
+    ../../C-Backend/eea.c \
+    ../../C-Backend/ineq.c \
+    ../../C-Backend/intvl.c \
+    ../../C-Backend/lde.c \
+    ../../C-Backend/list.c \
+    ../../C-Backend/memstat.c \
+    ../../C-Backend/stats.c \
+    ../../C-Backend/trace.c \
+    ../OutputBuffer.cpp \
+    RenderBench.cpp
+
+HEADERS += \
+    ../../C-Backend/diosolver.hpp \
+    ../../C-Backend/lde.h \
+    ../../C-Backend/trace.h \
+    ../OutputBuffer.h
+
+TARGET = RenderBench